@@ -0,0 +1,119 @@
+#ifndef _BENCH_BENCH_HPP_
+#define _BENCH_BENCH_HPP_
+
+#include "common/types.hpp"
+#include "nes/Bus.hpp"
+#include "nes/Cartridge.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace bench {
+	// Run `fn` `iterations` times and print the mean time per call.
+	template<typename Fn>
+	double measure(const char *name, u64 iterations, Fn&& fn) {
+		const auto start { std::chrono::steady_clock::now() };
+		for (u64 i { 0 }; i < iterations; ++i) {
+			fn();
+		}
+		const std::chrono::duration<double, std::nano> elapsed {
+			std::chrono::steady_clock::now() - start
+		};
+
+		const double per_call { elapsed.count() / static_cast<double>(iterations) };
+		std::printf("%-32s %12.1f ns/op\n", name, per_call);
+		return per_call;
+	}
+
+	// Run `frames` frames of `bus`, printing the time per frame and the frame rate.
+	inline double runFrames(const char *name, nes::Bus& bus, u64 frames) {
+		const double per_frame { measure(name, frames, [&bus] { bus.runFrame(); }) };
+		std::printf("%-32s %12.1f fps\n", name, 1e9 / per_frame);
+		return per_frame;
+	}
+
+	// Every benchmark takes `[count] [rom.nes]`: how much to run (frames,
+	// iterations...), then, for those that run one, a ROM to run besides the
+	// built-in program.
+	struct Args {
+		u64 count;
+		const char *rom; // nullptr without one
+	};
+
+	[[nodiscard]] inline Args parseArgs(int argc, char *argv[], u64 default_count) {
+		return {
+			argc > 1 ? std::strtoull(argv[1], nullptr, 10) : default_count,
+			argc > 2 ? argv[2] : nullptr,
+		};
+	}
+
+	// A 16 KB NROM cartridge running `program` from $8000 (mirrored at $c000),
+	// with the reset and IRQ vectors pointing at it and NMI at `nmi_handler`.
+	[[nodiscard]] inline nes::Cartridge
+	makeCartridge(const std::vector<u8>& program, u16 nmi_handler = 0x8000) {
+		nes::Cartridge cartridge {
+			1, 1, 0, nes::Cartridge::HORIZONTAL, std::vector<u8>(0x4000, 0xea),
+			std::vector<u8>(0x2000, 0x00),
+		};
+
+		std::copy(program.begin(), program.end(), cartridge.prg_data.begin());
+		for (std::size_t vector { 0x3ffa }; vector < 0x4000; vector += 2) {
+			cartridge.prg_data.at(vector) = 0x00;
+			cartridge.prg_data.at(vector + 1) = 0x80;
+		}
+		cartridge.prg_data.at(0x3ffa) = nmi_handler & 0x00ff;
+		cartridge.prg_data.at(0x3ffb) = nmi_handler >> 8;
+
+		return cartridge;
+	}
+
+	// Run `fn` on the built-in `cartridge`, then on the ROM at `rom` if there is
+	// one, each under a heading. Returns the exit code: failing when the ROM
+	// does not load.
+	template<typename Fn>
+	int runCartridges(
+		const char *name, const nes::Cartridge& cartridge, const char *rom, Fn&& fn
+	) {
+		std::printf("%s:\n", name);
+		fn(cartridge);
+
+		if (rom == nullptr) {
+			return 0;
+		}
+		const auto loaded { nes::Cartridge::loadFile(rom) };
+		if (!loaded) {
+			return 1;
+		}
+		std::printf("%s:\n", rom);
+		fn(*loaded);
+		return 0;
+	}
+
+	// `cartridge` as an iNES file image.
+	[[nodiscard]] inline std::vector<u8> inesImage(const nes::Cartridge& cartridge) {
+		std::vector<u8> image {
+			'N', 'E', 'S', 0x1a, cartridge.prg_banks, cartridge.chr_banks,
+			static_cast<u8>(
+				((cartridge.mapper_id & 0x0f) << 4)
+				| (cartridge.mirroring == nes::Cartridge::VERTICAL ? 0x01 : 0x00)
+			),
+			static_cast<u8>(cartridge.mapper_id & 0xf0),
+		};
+		image.resize(16);
+
+		const auto& prg { cartridge.prg_data };
+		const auto& chr { cartridge.chr_data };
+		image.insert(image.end(), prg.begin(), prg.end());
+		if (cartridge.chr_banks > 0) {
+			image.insert(image.end(), chr.begin(), chr.end());
+		}
+
+		return image;
+	}
+} // namespace bench
+
+#endif // _BENCH_BENCH_HPP_
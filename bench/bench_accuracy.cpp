@@ -0,0 +1,60 @@
+// Throughput of each accuracy level, on a synthetic CPU-bound loop and on a
+// ROM given on the command line.
+//
+// Usage: bench_accuracy [frames] [rom.nes]
+
+#include "Bench.hpp"
+#include "nes/Bus.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <optional>
+#include <string>
+
+namespace {
+	// Indexed loads that cross a page, indexed stores and implied instructions,
+	// the cases where the levels differ:
+	//   loop:  LDX #$00
+	//   inner: LDA $02f0,X ; STA $0300,X ; INX ; BNE inner ; JMP loop
+	const std::vector<u8> copy_loop {
+		0xa2, 0x00,       // LDX #$00
+		0xbd, 0xf0, 0x02, // LDA $02f0,X
+		0x9d, 0x00, 0x03, // STA $0300,X
+		0xe8,             // INX
+		0xd0, 0xf7,       // BNE inner
+		0x4c, 0x00, 0x80, // JMP $8000
+	};
+} // namespace
+
+int main(int argc, char *argv[]) {
+	spdlog::set_level(spdlog::level::warn);
+
+	const auto args { bench::parseArgs(argc, argv, 600) };
+	const u64 frames { args.count };
+
+	std::optional<nes::Cartridge> rom {};
+	if (args.rom != nullptr) {
+		rom = nes::Cartridge::loadFile(args.rom);
+		if (!rom) {
+			return 1;
+		}
+	}
+
+	for (const auto accuracy : { nes::Accuracy::FAST, nes::Accuracy::CYCLE }) {
+		const std::string level { nes::accuracyName(accuracy) };
+
+		nes::Bus bus { accuracy };
+		bus.insert(bench::makeCartridge(copy_loop));
+		bus.power();
+		bench::runFrames(("copy_loop/" + level).c_str(), bus, frames);
+
+		if (rom) {
+			nes::Bus rom_bus { accuracy };
+			rom_bus.insert(*rom);
+			rom_bus.power();
+			bench::runFrames(("rom/" + level).c_str(), rom_bus, frames);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,51 @@
+// Diagnostics cost on the emulation thread: a rate limited call site, a shown
+// message, and whole frames of a program writing to NROM's ROM on every loop.
+//
+// Usage: bench_diagnostics [frames]
+
+#include "Bench.hpp"
+#include "common/Diag.hpp"
+#include "nes/Bus.hpp"
+
+#include <spdlog/sinks/null_sink.h>
+#include <spdlog/spdlog.h>
+
+namespace {
+	//   loop: STA $8000 ; JMP loop
+	const std::vector<u8> rom_write_loop {
+		0x8d, 0x00, 0x80, // STA $8000
+		0x4c, 0x00, 0x80, // JMP $8000
+	};
+} // namespace
+
+int main(int argc, char *argv[]) {
+	// Measure the emulation thread, not the terminal.
+	spdlog::set_default_logger(spdlog::null_logger_mt("null"));
+
+	const u64 frames { bench::parseArgs(argc, argv, 600).count };
+
+	u64 value { 0 };
+	bench::measure("diag/suppressed", 100000000, [&] {
+		NES_WARN("Suppressed after the first hits: {}", value++);
+	});
+
+	// Bypass rate limiting to time formatting into the queue; stay below its
+	// capacity so that nothing is dropped.
+	static diag::Site site { NES_LOG_LEVEL_WARN, __FILE__, __LINE__ };
+	bench::measure("diag/shown", 512, [&] {
+		diag::log(site, 1, "Shown every time: {:#06x}", value++);
+	});
+	diag::flush();
+
+	nes::Bus bus {};
+	bus.insert(bench::makeCartridge(rom_write_loop));
+	bus.power();
+
+	const double per_frame {
+		bench::measure("frame/rom_write_loop", frames, [&] { bus.runFrame(); })
+	};
+	std::printf("%-32s %12.1f fps\n", "frame/rom_write_loop", 1e9 / per_frame);
+
+	diag::report();
+	return 0;
+}
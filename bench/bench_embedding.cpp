@@ -0,0 +1,92 @@
+// Cost of going through the libnes C API instead of the C++ core directly:
+// whole frames both ways, plus the accessors a host calls every frame.
+//
+// Usage: bench_embedding [frames] [rom.nes]
+
+#include "Bench.hpp"
+#include "libnes/nes.h"
+#include "nes/Bus.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <fstream>
+#include <iterator>
+
+namespace {
+	// clang-format off
+	const std::vector<u8> render_program {
+		// reset:
+		0xa9, 0x1e,       // LDA #$1e
+		0x8d, 0x01, 0x20, // STA $2001 ; background and sprites on
+		// loop:
+		0xe6, 0x10,       // INC $10
+		0x4c, 0x05, 0x80, // JMP loop
+	};
+	// clang-format on
+} // namespace
+
+int main(int argc, char *argv[]) {
+	spdlog::set_level(spdlog::level::warn);
+
+	const auto args { bench::parseArgs(argc, argv, 600) };
+	const u64 frames { args.count };
+
+	std::vector<u8> image {};
+	if (args.rom != nullptr) {
+		std::ifstream file { args.rom, std::ifstream::binary };
+		image.assign(std::istreambuf_iterator<char> { file }, {});
+	} else {
+		image = bench::inesImage(bench::makeCartridge(render_program));
+	}
+
+	auto cartridge { nes::Cartridge::loadMemory(image.data(), image.size()) };
+	if (!cartridge) {
+		return 1;
+	}
+	nes::Bus bus { nes::Accuracy::CYCLE };
+	bus.insert(std::move(*cartridge));
+	bus.power();
+
+	nes_console *console { nes_create(NES_ACCURACY_CYCLE) };
+	if (nes_load_rom(console, image.data(), image.size()) != 0) {
+		std::printf("%s\n", nes_last_error(console));
+		return 1;
+	}
+
+	// Warm both up, the first frames after power on are not representative.
+	for (u64 frame { 0 }; frame < 60; ++frame) {
+		bus.runFrame();
+		nes_run_frame(console, 1);
+	}
+
+	u64 sink { 0 };
+	const double direct { bench::measure("frame/c++", frames, [&] {
+		bus.runFrame();
+		bus.setController(0, 0);
+		sink += bus.getFramebuffer()[0] + bus.getRam()[0x10];
+	}) };
+	const double api { bench::measure("frame/c api", frames, [&] {
+		nes_run_frame(console, 1);
+		nes_set_controller(console, 0, 0);
+		std::size_t size {};
+		sink += nes_framebuffer(console)[0] + nes_ram(console, &size)[0x10];
+	}) };
+	std::printf("%-32s %12.1f ns/frame\n", "  overhead", api - direct);
+
+	bench::measure("accessors/c api", 10'000'000, [&] {
+		std::size_t size {};
+		sink += nes_framebuffer(console)[0] + nes_emphasis(console)[0];
+		sink += nes_ram(console, &size)[0];
+		sink += nes_audio(console, &size) != nullptr ? 1 : 0;
+	});
+
+	// Both ran the same frames, so they must agree.
+	const bool same { bus.hashState() == nes_hash_state(console) };
+	std::printf(
+		"%-32s %s (%llu)\n", "  state hashes", same ? "match" : "DIVERGE",
+		static_cast<unsigned long long>(sink)
+	);
+	nes_destroy(console);
+
+	return same ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+// Emulated frames/sec with and without frame skip, and a check that skipping
+// pixel work leaves the emulation itself untouched: the per-frame state hashes
+// must match the run that draws every frame.
+//
+// The built-in program waits for sprite 0 hit every frame, so any drift in its
+// timing shows up in the hashes.
+//
+// Usage: bench_frame_skip [frames] [rom.nes]
+
+#include "Bench.hpp"
+#include "nes/Bus.hpp"
+#include "nes/FrameSkip.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <string>
+
+namespace {
+	// clang-format off
+	const std::vector<u8> sprite0_program {
+		// reset:
+		0xa9, 0x00,       // LDA #$00
+		0x8d, 0x01, 0x20, // STA $2001 ; rendering off
+		0xa9, 0x64,       // LDA #100
+		0x8d, 0x00, 0x02, // STA $0200 ; sprite 0: Y = 100, tile 0, X = 50
+		0xa9, 0x00,       // LDA #$00
+		0x8d, 0x01, 0x02, // STA $0201
+		0x8d, 0x02, 0x02, // STA $0202
+		0xa9, 0x32,       // LDA #50
+		0x8d, 0x03, 0x02, // STA $0203
+		0xa2, 0x04,       // LDX #$04
+		0xa9, 0xff,       // LDA #$ff
+		0x9d, 0x00, 0x02, // STA $0200,X ; other sprites off screen
+		0xe8,             // INX
+		0xd0, 0xfa,       // BNE
+		0xa9, 0x80,       // LDA #$80
+		0x8d, 0x00, 0x20, // STA $2000 ; NMI on
+		0xa9, 0x1e,       // LDA #$1e
+		0x8d, 0x01, 0x20, // STA $2001 ; background and sprites on
+		// main ($802b):
+		0x2c, 0x02, 0x20, // BIT $2002
+		0x70, 0xfb,       // BVS main ; wait for the flag to clear
+		0x2c, 0x02, 0x20, // BIT $2002
+		0x50, 0xfb,       // BVC ; wait for sprite 0 hit
+		0xe6, 0x10,       // INC $10
+		0x4c, 0x2b, 0x80, // JMP main
+		// nmi ($803a):
+		0xa9, 0x02,       // LDA #$02
+		0x8d, 0x14, 0x40, // STA $4014
+		0x40,             // RTI
+	};
+	// clang-format on
+
+	constexpr u16 nmi_handler { 0x803a };
+
+	// Run `frames` frames drawing one out of `interval`, returning the state hash
+	// of every frame.
+	std::vector<u64> run(const nes::Cartridge& cartridge, u64 frames, u32 interval) {
+		nes::Bus bus {};
+		bus.insert(cartridge);
+		bus.power();
+
+		nes::FrameSkip skip { interval };
+		std::vector<u64> hashes {};
+		hashes.reserve(frames);
+
+		const std::string name {
+			"frames/skip=" + std::to_string(skip.getInterval())
+		};
+		const double per_frame { bench::measure(name.c_str(), frames, [&] {
+			bus.runFrame(skip.nextFrame());
+			hashes.push_back(bus.hashState());
+		}) };
+		std::printf("%-32s %12.1f fps\n", name.c_str(), 1e9 / per_frame);
+
+		return hashes;
+	}
+
+	void compare(const nes::Cartridge& cartridge, u64 frames) {
+		const auto reference { run(cartridge, frames, 1) };
+		for (const u32 interval : { 2, 4, 8, 60 }) {
+			const auto hashes { run(cartridge, frames, interval) };
+			std::printf(
+				"%-32s %s\n", "  state hashes",
+				hashes == reference ? "match" : "DIVERGE"
+			);
+		}
+	}
+} // namespace
+
+int main(int argc, char *argv[]) {
+	spdlog::set_level(spdlog::level::warn);
+
+	const auto args { bench::parseArgs(argc, argv, 600) };
+
+	// Every tile fully opaque, so sprite 0 hits as soon as it is on screen.
+	auto cartridge { bench::makeCartridge(sprite0_program, nmi_handler) };
+	std::fill(cartridge.chr_data.begin(), cartridge.chr_data.end(), 0xff);
+
+	return bench::runCartridges(
+		"sprite 0 program", cartridge, args.rom,
+		[&args](const nes::Cartridge& tested) { compare(tested, args.count); }
+	);
+}
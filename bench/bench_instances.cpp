@@ -0,0 +1,86 @@
+// Memory of many consoles running the same ROM: the resident set growth per
+// console against what the consoles report, and the size of the shared image.
+// A larger ROM makes the sharing more visible, e.g. a 512 KB MMC3 game.
+//
+// Usage: bench_instances [consoles] [rom.nes]
+
+#include "Bench.hpp"
+#include "libnes/nes.h"
+
+#include <spdlog/spdlog.h>
+
+#include <unistd.h>
+
+#include <fstream>
+#include <iterator>
+
+namespace {
+	// clang-format off
+	const std::vector<u8> chr_ram_program {
+		// reset: write a tile to CHR RAM, so that every console copies it.
+		0xa9, 0x00,       // LDA #$00
+		0x8d, 0x06, 0x20, // STA $2006
+		0x8d, 0x06, 0x20, // STA $2006
+		0xa9, 0xff,       // LDA #$ff
+		0x8d, 0x07, 0x20, // STA $2007
+		// loop:
+		0xe6, 0x10,       // INC $10
+		0x4c, 0x0d, 0x80, // JMP loop
+	};
+	// clang-format on
+
+	// Resident set size, from /proc/self/statm.
+	[[nodiscard]] std::size_t residentBytes() {
+		std::ifstream statm { "/proc/self/statm" };
+		std::size_t size {};
+		std::size_t resident {};
+		statm >> size >> resident;
+		return resident * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+	}
+} // namespace
+
+int main(int argc, char *argv[]) {
+	spdlog::set_level(spdlog::level::warn);
+
+	const auto args { bench::parseArgs(argc, argv, 1000) };
+	const u64 count { args.count };
+
+	std::vector<u8> image {};
+	if (args.rom != nullptr) {
+		std::ifstream file { args.rom, std::ifstream::binary };
+		image.assign(std::istreambuf_iterator<char> { file }, {});
+	} else {
+		auto cartridge { bench::makeCartridge(chr_ram_program) };
+		cartridge.chr_banks = 0;
+		image = bench::inesImage(cartridge);
+	}
+
+	const std::size_t before { residentBytes() };
+	std::vector<nes_console *> consoles {};
+	for (u64 i { 0 }; i < count; ++i) {
+		nes_console *console { nes_create(NES_ACCURACY_CYCLE) };
+		if (nes_load_rom(console, image.data(), image.size()) != 0) {
+			std::printf("%s\n", nes_last_error(console));
+			return 1;
+		}
+		nes_run_frame(console, 1);
+		consoles.push_back(console);
+	}
+	const std::size_t after { residentBytes() };
+
+	std::size_t shared {};
+	const std::size_t reported { nes_memory_usage(consoles.front(), &shared) };
+	std::printf("%-32s %12llu\n", "consoles", static_cast<unsigned long long>(count));
+	std::printf("%-32s %12.1f KB\n", "rom/image", image.size() / 1024.0);
+	std::printf("%-32s %12.1f KB\n", "memory/shared", shared / 1024.0);
+	std::printf("%-32s %12.1f KB\n", "memory/private_reported", reported / 1024.0);
+	std::printf(
+		"%-32s %12.1f KB\n", "memory/private_measured",
+		static_cast<double>(after - before) / static_cast<double>(count) / 1024.0
+	);
+
+	for (auto *console : consoles) {
+		nes_destroy(console);
+	}
+	return 0;
+}
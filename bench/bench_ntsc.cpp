@@ -0,0 +1,100 @@
+// NTSC filtering of one frame for every instruction set the host supports, then
+// on 1 to 4 threads with the best one. Every output is checked against the
+// scalar single-threaded reference first.
+//
+// Usage: bench_ntsc [iterations]
+
+#include "Bench.hpp"
+#include "nes/PPU.hpp"
+#include "video/Ntsc.hpp"
+
+#include <array>
+#include <initializer_list>
+#include <random>
+#include <string>
+
+namespace {
+	using simd::Isa;
+
+	constexpr u32 width { PPU_SCREEN_WIDTH };
+	constexpr u32 height { PPU_SCREEN_HEIGHT };
+
+	// Any color, with the upper index bits garbage, in runs as long as tiles.
+	void randomFrame(std::vector<u8>& indices, std::vector<u8>& emphasis) {
+		std::mt19937 rng { 1984 };
+		for (std::size_t x { 0 }; x < indices.size(); x += 8) {
+			const auto color { static_cast<u8>(rng()) };
+			std::fill_n(indices.begin() + x, 8, color);
+			indices[x + rng() % 8] = static_cast<u8>(rng());
+		}
+		for (auto& bits : emphasis) {
+			bits = static_cast<u8>(rng() & 0x07);
+		}
+	}
+
+	using Frames = std::array<std::vector<video::Rgba>, 3>;
+
+	// The frame filtered with each of the three phases.
+	Frames filterFrames(
+		video::NtscFilter& filter, const std::vector<u8>& indices,
+		const std::vector<u8>& emphasis, Isa isa
+	) {
+		Frames frames {};
+		for (u8 phase { 0 }; phase < frames.size(); ++phase) {
+			frames[phase].resize(video::ntscWidth(width) * height);
+			filter.apply(
+				indices.data(), emphasis.data(), height, phase, frames[phase].data(),
+				isa
+			);
+		}
+		return frames;
+	}
+
+	bool benchFilter(
+		const std::vector<u8>& indices, const std::vector<u8>& emphasis, Isa isa,
+		u32 threads, const Frames& reference, u64 iterations
+	) {
+		video::NtscFilter filter { width, threads };
+		const std::string name {
+			std::string { "ntsc/" } + simd::isaName(isa) + "/threads="
+			+ std::to_string(threads)
+		};
+		if (filterFrames(filter, indices, emphasis, isa) != reference) {
+			std::printf("%s: differs from scalar\n", name.c_str());
+			return false;
+		}
+
+		std::vector<video::Rgba> out(reference[0].size());
+		bench::measure(name.c_str(), iterations, [&] {
+			filter.apply(
+				indices.data(), emphasis.data(), height, 0, out.data(), isa
+			);
+		});
+		return true;
+	}
+} // namespace
+
+int main(int argc, char *argv[]) {
+	const u64 iterations { bench::parseArgs(argc, argv, 500).count };
+
+	std::vector<u8> indices(width * height);
+	std::vector<u8> emphasis(height);
+	randomFrame(indices, emphasis);
+
+	video::NtscFilter scalar { width, 1 };
+	const Frames reference { filterFrames(scalar, indices, emphasis, Isa::SCALAR) };
+
+	bool ok { true };
+	for (const auto isa : { Isa::SCALAR, Isa::SSSE3, Isa::AVX2 }) {
+		if (simd::isSupported(isa)) {
+			ok &= benchFilter(indices, emphasis, isa, 1, reference, iterations);
+		}
+	}
+	for (const u32 threads : { 2, 4 }) {
+		ok &= benchFilter(
+			indices, emphasis, simd::bestIsa(), threads, reference, iterations
+		);
+	}
+
+	return ok ? 0 : 1;
+}
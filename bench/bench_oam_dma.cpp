@@ -0,0 +1,68 @@
+// OAM DMA cost: the bulk copy against a byte-by-byte bus transfer, and whole
+// frames of a DMA-bound program or of a ROM given on the command line.
+//
+// Usage: bench_oam_dma [frames] [rom.nes]
+
+#include "Bench.hpp"
+#include "nes/Bus.hpp"
+
+#include <spdlog/spdlog.h>
+
+namespace {
+	// Fill page 2 like a game's shadow OAM, then DMA it over and over:
+	//   loop: LDA #$02 ; STA $4014 ; JMP loop
+	const std::vector<u8> dma_loop {
+		0xa9, 0x02,       // LDA #$02
+		0x8d, 0x14, 0x40, // STA $4014
+		0x4c, 0x00, 0x80, // JMP $8000
+	};
+
+	void fillShadowOam(nes::Bus& bus) {
+		for (u16 i { 0 }; i < 256; ++i) {
+			bus.cpuWrite(0x0200 + i, static_cast<u8>(i * 7));
+		}
+	}
+} // namespace
+
+int main(int argc, char *argv[]) {
+	spdlog::set_level(spdlog::level::warn);
+
+	const auto args { bench::parseArgs(argc, argv, 600) };
+	const u64 frames { args.count };
+
+	nes::Bus bus {};
+	bus.insert(bench::makeCartridge(dma_loop));
+	bus.power();
+	fillShadowOam(bus);
+
+	constexpr u64 transfers { 200000 };
+	bench::measure("oam_dma/bulk", transfers, [&] { bus.cpuWrite(0x4014, 0x02); });
+	bench::measure("oam_dma/per_byte", transfers, [&] {
+		bus.cpuWrite(0x2003, 0x00);
+		for (u16 i { 0 }; i < 256; ++i) {
+			bus.cpuWrite(0x2004, bus.cpuRead(0x0200 + i, false));
+		}
+	});
+
+	// The transfers above stall the CPU outside `run`, piling up cycles it would
+	// spend first, and change OAM: time the frames on a fresh console.
+	nes::Bus frame_bus {};
+	frame_bus.insert(bench::makeCartridge(dma_loop));
+	frame_bus.power();
+	fillShadowOam(frame_bus);
+	bench::runFrames("frame/dma_loop", frame_bus, frames);
+
+	if (args.rom != nullptr) {
+		auto cartridge { nes::Cartridge::loadFile(args.rom) };
+		if (!cartridge) {
+			return 1;
+		}
+
+		nes::Bus rom_bus {};
+		rom_bus.insert(std::move(*cartridge));
+		rom_bus.power();
+		bench::runFrames("frame/rom", rom_bus, frames);
+	}
+
+	return 0;
+}
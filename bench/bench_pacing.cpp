@@ -0,0 +1,88 @@
+// How late frames start when paced by `FramePacer` compared to sleeping until
+// each deadline, and how much CPU time the pacing burns doing it. Lateness is
+// the jitter the display sees on top of the frame time.
+//
+// Usage: bench_pacing [frames]
+
+#include "Bench.hpp"
+#include "frontend/FramePacer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+	using Microseconds = std::chrono::duration<double, std::micro>;
+
+	[[nodiscard]] double cpuSeconds() {
+		return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+	}
+
+	void report(const char *name, std::vector<double> late, double cpu, double wall) {
+		std::sort(late.begin(), late.end());
+		const auto at { [&late](double fraction) {
+			return late[static_cast<std::size_t>(
+				fraction * static_cast<double>(late.size() - 1)
+			)];
+		} };
+		std::printf(
+			"%-32s p50 %8.1f us  p99 %8.1f us  max %8.1f us  cpu %5.1f%%\n", name,
+			at(0.50), at(0.99), late.back(), 100.0 * cpu / wall
+		);
+	}
+
+	void sleepUntil(u64 frames) {
+		const std::chrono::nanoseconds period { NES_FRAME_NS };
+		std::vector<double> late {};
+		late.reserve(frames);
+
+		const double cpu_start { cpuSeconds() };
+		const auto start { Clock::now() };
+		for (u64 frame { 1 }; frame <= frames; ++frame) {
+			const auto deadline { start + period * frame };
+			std::this_thread::sleep_until(deadline);
+			late.push_back(Microseconds { Clock::now() - deadline }.count());
+		}
+		const std::chrono::duration<double> wall { Clock::now() - start };
+
+		report("sleep_until", late, cpuSeconds() - cpu_start, wall.count());
+	}
+
+	void pacer(u64 frames) {
+		frontend::FramePacer pacer {};
+		std::vector<double> late {};
+		late.reserve(frames);
+
+		const double cpu_start { cpuSeconds() };
+		const auto start { Clock::now() };
+		for (u64 frame { 0 }; frame < frames; ++frame) {
+			late.push_back(Microseconds { pacer.wait() }.count());
+		}
+		const std::chrono::duration<double> wall { Clock::now() - start };
+
+		report("FramePacer", late, cpuSeconds() - cpu_start, wall.count());
+		std::printf(
+			"%-32s %8.1f us\n", "  spin margin",
+			Microseconds { pacer.getSpinMargin() }.count()
+		);
+	}
+} // namespace
+
+int main(int argc, char *argv[]) {
+	const u64 frames { bench::parseArgs(argc, argv, 600).count };
+	// The percentiles need at least one frame.
+	if (frames == 0) {
+		std::fprintf(stderr, "bench_pacing: frames must be at least 1\n");
+		return 1;
+	}
+
+	sleepUntil(frames);
+	pacer(frames);
+
+	return 0;
+}
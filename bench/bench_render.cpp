@@ -0,0 +1,148 @@
+// Emulated frames/sec drawing inline and on 1 to 8 render threads, the speedup
+// over inline drawing on this machine's CPUs, the wall time the workers take per
+// frame, and a check that deferred drawing is exact:
+// every frame must match the inline one, which it follows by one frame, also
+// when every other frame is skipped.
+//
+// The built-in program keeps background and sprites on over a noisy pattern
+// table and rewrites the backdrop color every frame, so the logs carry writes
+// and every line, line 0 included, changes from frame to frame.
+//
+// Usage: bench_render [frames] [rom.nes]
+
+#include "Bench.hpp"
+#include "common/Hash.hpp"
+#include "nes/Bus.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <string>
+#include <thread>
+
+namespace {
+	// clang-format off
+	const std::vector<u8> render_program {
+		// reset:
+		0xa9, 0x80,       // LDA #$80
+		0x8d, 0x00, 0x20, // STA $2000 ; NMI on
+		0xa9, 0x1e,       // LDA #$1e
+		0x8d, 0x01, 0x20, // STA $2001 ; background and sprites on
+		// main ($800a):
+		0x4c, 0x0a, 0x80, // JMP main
+		// nmi ($800d):
+		0xa9, 0x3f,       // LDA #$3f
+		0x8d, 0x06, 0x20, // STA $2006
+		0xa9, 0x00,       // LDA #$00
+		0x8d, 0x06, 0x20, // STA $2006 ; palette entry 0, the backdrop
+		0xe6, 0x10,       // INC $10
+		0xa5, 0x10,       // LDA $10
+		0x8d, 0x07, 0x20, // STA $2007
+		0xa9, 0x00,       // LDA #$00
+		0x8d, 0x06, 0x20, // STA $2006
+		0x8d, 0x06, 0x20, // STA $2006 ; scroll back to the top left
+		0x40,             // RTI
+	};
+	// clang-format on
+
+	constexpr u16 nmi_handler { 0x800d };
+
+	[[nodiscard]] u64 hashPicture(const nes::Bus& bus) {
+		const auto& framebuffer { bus.getFramebuffer() };
+		const auto& emphasis { bus.getEmphasis() };
+		const u64 seed { hash::xxh64(framebuffer.data(), framebuffer.size()) };
+		return hash::xxh64(emphasis.data(), emphasis.size(), seed);
+	}
+
+	struct Run {
+		std::vector<u64> hashes; // the picture after every frame
+		double per_frame;        // ns
+	};
+
+	// Run `frames` frames on `threads` render threads (0: inline), drawing one
+	// out of `interval`.
+	Run run(
+		const nes::Cartridge& cartridge, u64 frames, u32 threads, u32 interval = 1
+	) {
+		nes::Bus bus {};
+		bus.insert(cartridge);
+		bus.power();
+		bus.setRenderThreads(threads);
+
+		std::vector<u64> hashes {};
+		hashes.reserve(frames);
+
+		std::string name {
+			threads == 0 ? std::string { "frames/inline" }
+			             : "frames/threads=" + std::to_string(threads)
+		};
+		if (interval > 1) {
+			name += " skip=" + std::to_string(interval);
+		}
+		const double per_frame { bench::measure(name.c_str(), frames, [&] {
+			bus.runFrame(hashes.size() % interval == 0);
+			hashes.push_back(hashPicture(bus));
+		}) };
+		std::printf("%-32s %12.1f fps\n", name.c_str(), 1e9 / per_frame);
+
+		if (const nes::FrameRenderer *renderer { bus.getRenderer() }) {
+			const auto drawn { static_cast<double>(renderer->getFrames()) };
+			const std::chrono::duration<double, std::micro> draw_time {
+				renderer->getDrawTime()
+			};
+			const std::chrono::duration<double, std::micro> stall_time {
+				renderer->getStallTime()
+			};
+			std::printf(
+				"%-32s %12.1f us/frame, waited %.1f us/frame\n", "  drawing",
+				draw_time.count() / drawn, stall_time.count() / drawn
+			);
+		}
+
+		return { hashes, per_frame };
+	}
+
+	void compare(const nes::Cartridge& cartridge, u64 frames) {
+		std::printf("%-32s %12u\n", "cpus", std::thread::hardware_concurrency());
+
+		const auto [reference, inline_per_frame] { run(cartridge, frames, 0) };
+		for (const u32 threads : { 1, 2, 4, 8 }) {
+			const auto [hashes, per_frame] { run(cartridge, frames, threads) };
+			std::printf("%-32s %12.2fx\n", "  speedup", inline_per_frame / per_frame);
+
+			// Deferred frames come out one frame late.
+			const bool match { std::equal(
+				hashes.begin() + 1, hashes.end(), reference.begin()
+			) };
+			std::printf("%-32s %s\n", "  pictures", match ? "match" : "DIFFER");
+		}
+
+		// A frame drawn after a skipped one is whole, line 0 included. Skipped
+		// frames are dropped, the drawn ones still come out one frame late.
+		const auto skipped { run(cartridge, frames, 2, 2).hashes };
+		bool match { true };
+		for (std::size_t frame { 0 }; frame + 1 < skipped.size(); frame += 2) {
+			match = match && skipped[frame + 1] == reference[frame];
+		}
+		std::printf("%-32s %s\n", "  pictures", match ? "match" : "DIFFER");
+	}
+} // namespace
+
+int main(int argc, char *argv[]) {
+	spdlog::set_level(spdlog::level::warn);
+
+	const auto args { bench::parseArgs(argc, argv, 600) };
+
+	auto cartridge { bench::makeCartridge(render_program, nmi_handler) };
+	u32 noise { 0x12345678 };
+	for (u8& byte : cartridge.chr_data) {
+		noise ^= noise << 13;
+		noise ^= noise >> 17;
+		noise ^= noise << 5;
+		byte = static_cast<u8>(noise);
+	}
+
+	return bench::runCartridges(
+		"render program", cartridge, args.rom,
+		[&args](const nes::Cartridge& tested) { compare(tested, args.count); }
+	);
+}
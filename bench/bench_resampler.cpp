@@ -0,0 +1,119 @@
+// Resampling from the APU rate (one sample per CPU cycle) to 48 kHz for every
+// instruction set the host supports: throughput per core, agreement with the
+// scalar reference, stopband rejection and the reach of the rate control.
+//
+// Usage: bench_resampler [seconds]
+
+#include "Bench.hpp"
+#include "audio/Resampler.hpp"
+#include "nes/Bus.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <initializer_list>
+#include <string>
+
+namespace {
+	using simd::Isa;
+
+	constexpr double output_rate { 48000.0 };
+	constexpr double pi { 3.14159265358979323846 };
+
+	// One second of a sine at `frequency`, at the APU rate.
+	std::vector<float> sine(double frequency) {
+		std::vector<float> input(static_cast<std::size_t>(NES_CPU_HZ));
+		for (std::size_t i { 0 }; i < input.size(); ++i) {
+			const double t { static_cast<double>(i) / NES_CPU_HZ };
+			input[i] = static_cast<float>(0.5 * std::sin(2.0 * pi * frequency * t));
+		}
+		return input;
+	}
+
+	// Resample `input`, fed one video frame at a time.
+	std::vector<s16>
+	resample(Isa isa, const std::vector<float>& input, double adjust = 0.0) {
+		audio::Resampler resampler { NES_CPU_HZ, output_rate, isa };
+		resampler.setRateAdjust(adjust);
+
+		constexpr std::size_t frame { NES_FRAME_DOTS / NES_CPU_DIVIDER };
+		std::vector<s16> output {};
+		for (std::size_t offset { 0 }; offset < input.size(); offset += frame) {
+			const std::size_t count { std::min(frame, input.size() - offset) };
+			resampler.process(input.data() + offset, count, output);
+		}
+
+		return output;
+	}
+
+	// RMS level relative to full scale, skipping the filter warm-up.
+	double level(const std::vector<s16>& samples) {
+		double sum { 0.0 };
+		const std::size_t start { samples.size() / 10 };
+		for (std::size_t i { start }; i < samples.size(); ++i) {
+			sum += static_cast<double>(samples[i]) * samples[i];
+		}
+		const double rms { std::sqrt(sum / static_cast<double>(samples.size() - start)) };
+		return 20.0 * std::log10(std::max(rms, 1e-3) / 32767.0);
+	}
+} // namespace
+
+int main(int argc, char *argv[]) {
+	const u64 seconds { bench::parseArgs(argc, argv, 3).count };
+
+	const audio::Resampler reference_filter { NES_CPU_HZ, output_rate, Isa::SCALAR };
+	std::printf(
+		"%-32s %12zu taps x %zu phases\n", "filter", reference_filter.getTaps(),
+		audio::Resampler::PHASES
+	);
+
+	const auto tone { sine(1000.0) };
+	const auto reference { resample(Isa::SCALAR, tone) };
+	bool ok { true };
+
+	for (const auto isa : { Isa::SCALAR, Isa::SSSE3, Isa::AVX2 }) {
+		if (!simd::isSupported(isa)) {
+			continue;
+		}
+
+		// Only the summation order differs, allow one step of rounding.
+		const auto output { resample(isa, tone) };
+		bool same { output.size() == reference.size() };
+		for (std::size_t i { 0 }; same && i < output.size(); ++i) {
+			same = std::abs(output[i] - reference[i]) <= 1;
+		}
+		if (!same) {
+			std::printf("%s: differs from scalar\n", simd::isaName(isa));
+			ok = false;
+			continue;
+		}
+
+		const std::string name { std::string { "1s of input/" } + simd::isaName(isa) };
+		const double per_second { bench::measure(name.c_str(), seconds, [&] {
+			resample(isa, tone);
+		}) };
+		std::printf(
+			"%-32s %12.1f Msamples/s in (%.1fx real time)\n", "",
+			NES_CPU_HZ * 1e3 / per_second, 1e9 / per_second
+		);
+	}
+
+	// Tones past the output Nyquist frequency fold back into the audible band.
+	const auto best { simd::bestIsa() };
+	std::printf("%-32s %12.1f dB\n", "1 kHz level", level(reference));
+	for (const double frequency : { 30000.0, 60000.0 }) {
+		const std::string name {
+			std::to_string(static_cast<int>(frequency / 1000)) + " kHz level"
+		};
+		const double decibels { level(resample(best, sine(frequency))) };
+		std::printf("%-32s %12.1f dB\n", name.c_str(), decibels);
+	}
+
+	for (const double adjust : { -AUDIO_MAX_RATE_ADJUST, AUDIO_MAX_RATE_ADJUST }) {
+		std::printf(
+			"%-32s %12zu samples\n", adjust < 0 ? "1s at -0.5%" : "1s at +0.5%",
+			resample(best, tone, adjust).size()
+		);
+	}
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+// Run-ahead latency and cost for 0 to 3 frames.
+//
+// A small program with one frame of built-in lag, like most games: the main
+// loop reads controller 1 after vblank, and the NMI handler only "displays" it
+// (copies it to $11) one frame later. Latency is the number of host frames
+// from pressing A to the first presented frame showing it, each host frame
+// being one NTSC frame period on screen.
+//
+// Usage: bench_run_ahead [frames]
+
+#include "Bench.hpp"
+#include "nes/Bus.hpp"
+#include "nes/RunAhead.hpp"
+
+#include <spdlog/spdlog.h>
+
+namespace {
+	// clang-format off
+	const std::vector<u8> lag_program {
+		// reset:
+		0xa9, 0x80,       // LDA #$80
+		0x8d, 0x00, 0x20, // STA $2000 ; NMI on
+		// main:
+		0xa5, 0x12,       // LDA $12
+		0xf0, 0xfc,       // BEQ main ; wait for the NMI
+		0xa9, 0x00,       // LDA #$00
+		0x85, 0x12,       // STA $12
+		0xa9, 0x01,       // LDA #$01
+		0x8d, 0x16, 0x40, // STA $4016
+		0xa9, 0x00,       // LDA #$00
+		0x8d, 0x16, 0x40, // STA $4016
+		0xad, 0x16, 0x40, // LDA $4016
+		0x29, 0x01,       // AND #$01
+		0x85, 0x10,       // STA $10 ; input read this frame
+		0x4c, 0x05, 0x80, // JMP main
+		// nmi ($8021):
+		0xa5, 0x10,       // LDA $10
+		0x85, 0x11,       // STA $11 ; input shown this frame
+		0xa9, 0x01,       // LDA #$01
+		0x85, 0x12,       // STA $12
+		0x40,             // RTI
+	};
+	// clang-format on
+
+	constexpr u16 nmi_handler { 0x8021 };
+
+	// NTSC frame period.
+	constexpr double frame_ms { 1000.0 / 60.0988 };
+} // namespace
+
+int main(int argc, char *argv[]) {
+	spdlog::set_level(spdlog::level::warn);
+
+	const u64 frames { bench::parseArgs(argc, argv, 600).count };
+
+	const auto cartridge { bench::makeCartridge(lag_program, nmi_handler) };
+
+	for (u8 ahead { 0 }; ahead <= 3; ++ahead) {
+		nes::Bus bus {};
+		bus.insert(cartridge);
+		bus.power();
+
+		nes::RunAhead run_ahead { bus, ahead };
+
+		// Settle, then press A and count host frames until it is presented.
+		for (int frame { 0 }; frame < 10; ++frame) {
+			run_ahead.runFrame();
+		}
+
+		bus.setController(0, nes::BUTTON_A);
+		bool shown { false };
+		u64 latency { 0 };
+		while (!shown && latency < 10) {
+			run_ahead.runFrame([&](nes::Bus& presented) {
+				shown = presented.cpuRead(0x0011, true) != 0;
+			});
+			latency += 1;
+		}
+
+		std::printf(
+			"run_ahead=%u: shown after %llu host frame(s), %.1f ms input-to-photon\n",
+			ahead, static_cast<unsigned long long>(latency),
+			static_cast<double>(latency) * frame_ms
+		);
+
+		char name[32];
+		std::snprintf(name, sizeof(name), "host_frame/run_ahead=%u", ahead);
+		bench::measure(name, frames, [&] { run_ahead.runFrame(); });
+	}
+
+	nes::Bus bus {};
+	bus.insert(cartridge);
+	bus.power();
+
+	nes::State snapshot {};
+	bench::measure("save_state", 100000, [&] { bus.saveState(snapshot); });
+	bench::measure("load_state", 100000, [&] { bus.loadState(snapshot); });
+
+	return 0;
+}
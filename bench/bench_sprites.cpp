@@ -0,0 +1,172 @@
+// Sprite evaluation and line compositing for every instruction set the host
+// supports, each checked against the scalar reference first: the OAM hit masks
+// of every line, and whole frames drawn from random memories and registers.
+//
+// Usage: bench_sprites [iterations]
+
+#include "Bench.hpp"
+#include "common/Hash.hpp"
+#include "nes/PPU.hpp"
+
+#include <initializer_list>
+#include <random>
+#include <string>
+
+namespace {
+	using simd::Isa;
+
+	const std::vector<Isa> isas { [] {
+		std::vector<Isa> supported {};
+		for (const auto isa : { Isa::SCALAR, Isa::SSSE3, Isa::AVX2 }) {
+			if (simd::isSupported(isa)) {
+				supported.push_back(isa);
+			}
+		}
+		return supported;
+	}() };
+
+	// What a frame is drawn from, random but for the sprites being bunched up
+	// vertically so that lines have anything from none to all 64 of them.
+	struct Scene {
+		std::array<u8, 0x4000> memory;
+		std::array<u8, 32> palette;
+		std::array<u8, 256> oam;
+		u16 v;
+		u8 x;
+		u8 ctrl;
+		u8 mask;
+	};
+
+	std::vector<Scene> randomScenes(std::size_t count) {
+		std::mt19937 rng { 2048 };
+		std::vector<Scene> scenes(count);
+		for (auto& scene : scenes) {
+			for (auto& byte : scene.memory) {
+				byte = static_cast<u8>(rng());
+			}
+			for (auto& entry : scene.palette) {
+				entry = static_cast<u8>(rng());
+			}
+
+			const u8 top { static_cast<u8>(rng()) };
+			const u8 spread { static_cast<u8>(rng() % 64 + 1) };
+			for (std::size_t n { 0 }; n < scene.oam.size(); ++n) {
+				const auto byte { static_cast<u8>(rng()) };
+				scene.oam[n] = n % 4 == 0 ? static_cast<u8>(top + byte % spread) : byte;
+			}
+
+			scene.v = static_cast<u16>(rng() & 0x7fff);
+			scene.x = static_cast<u8>(rng() & 0x07);
+			scene.ctrl = static_cast<u8>(rng());
+			scene.mask = static_cast<u8>(rng());
+		}
+		return scenes;
+	}
+
+	[[nodiscard]] u64 hashHits(const std::vector<Scene>& scenes, Isa isa) {
+		u64 hash { 0 };
+		for (const auto& scene : scenes) {
+			for (const u8 height : { 8, 16 }) {
+				for (u16 line { 0 }; line < PPU_SCREEN_HEIGHT; ++line) {
+					const u64 hits {
+						nes::PPU::spriteHits(scene.oam.data(), height, line, isa)
+					};
+					hash = hash::xxh64(&hits, sizeof(hits), hash);
+				}
+			}
+		}
+		return hash;
+	}
+
+	void drawScene(const Scene& scene, Isa isa, nes::PPU::Framebuffer& framebuffer) {
+		nes::Mapper::PpuWindows windows {};
+		for (std::size_t slot { 0 }; slot < windows.size(); ++slot) {
+			windows[slot] = scene.memory.data() + slot * MAPPER_PPU_WINDOW_SIZE;
+		}
+
+		const nes::PPU::LineSource source {
+			scene.v,
+			scene.x,
+			scene.ctrl,
+			scene.mask,
+			scene.palette.data(),
+			scene.oam.data(),
+			windows,
+		};
+		for (u16 line { 0 }; line < PPU_SCREEN_HEIGHT; ++line) {
+			nes::PPU::drawLine(
+				source, line, framebuffer.data() + line * PPU_SCREEN_WIDTH, isa
+			);
+		}
+	}
+
+	[[nodiscard]] u64 hashFrames(const std::vector<Scene>& scenes, Isa isa) {
+		nes::PPU::Framebuffer framebuffer {};
+		u64 hash { 0 };
+		for (const auto& scene : scenes) {
+			drawScene(scene, isa, framebuffer);
+			hash = hash::xxh64(framebuffer.data(), framebuffer.size(), hash);
+		}
+		return hash;
+	}
+
+	bool benchEvaluation(const std::vector<Scene>& scenes, u64 iterations) {
+		const u64 reference { hashHits(scenes, Isa::SCALAR) };
+
+		bool ok { true };
+		for (const auto isa : isas) {
+			if (hashHits(scenes, isa) != reference) {
+				std::printf("hits/%s: differs from scalar\n", simd::isaName(isa));
+				ok = false;
+				continue;
+			}
+
+			// One frame's worth of lines.
+			const Scene& scene { scenes.front() };
+			std::array<u64, PPU_SCREEN_HEIGHT> hits {};
+			const std::string name { std::string { "hits/" } + simd::isaName(isa) };
+			bench::measure(name.c_str(), iterations, [&] {
+				for (u16 line { 0 }; line < PPU_SCREEN_HEIGHT; ++line) {
+					hits[line] = nes::PPU::spriteHits(scene.oam.data(), 8, line, isa);
+				}
+			});
+		}
+
+		return ok;
+	}
+
+	bool benchFrames(const std::vector<Scene>& scenes, u64 iterations) {
+		const u64 reference { hashFrames(scenes, Isa::SCALAR) };
+
+		bool ok { true };
+		for (const auto isa : isas) {
+			if (hashFrames(scenes, isa) != reference) {
+				std::printf("frame/%s: differs from scalar\n", simd::isaName(isa));
+				ok = false;
+				continue;
+			}
+
+			// Both layers on and unclipped, the usual case.
+			Scene scene { scenes.front() };
+			scene.mask = 0x1e;
+			nes::PPU::Framebuffer framebuffer {};
+			const std::string name { std::string { "frame/" } + simd::isaName(isa) };
+			bench::measure(name.c_str(), iterations, [&] {
+				drawScene(scene, isa, framebuffer);
+			});
+		}
+
+		return ok;
+	}
+} // namespace
+
+int main(int argc, char *argv[]) {
+	const u64 iterations { bench::parseArgs(argc, argv, 2000).count };
+
+	const auto scenes { randomScenes(64) };
+
+	bool ok { benchEvaluation(scenes, iterations) };
+	ok &= benchFrames(scenes, iterations);
+
+	return ok ? 0 : 1;
+}
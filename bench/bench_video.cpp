@@ -0,0 +1,133 @@
+// Palette conversion and scaling of one frame for every instruction set the
+// host supports, each checked against the scalar reference first.
+//
+// Usage: bench_video [iterations]
+
+#include "Bench.hpp"
+#include "nes/PPU.hpp"
+#include "video/Palette.hpp"
+#include "video/Scaler.hpp"
+
+#include <initializer_list>
+#include <random>
+#include <string>
+
+namespace {
+	using simd::Isa;
+
+	constexpr u32 width { PPU_SCREEN_WIDTH };
+	constexpr u32 height { PPU_SCREEN_HEIGHT };
+
+	const std::vector<Isa> isas { [] {
+		std::vector<Isa> supported {};
+		for (const auto isa : { Isa::SCALAR, Isa::SSSE3, Isa::AVX2 }) {
+			if (simd::isSupported(isa)) {
+				supported.push_back(isa);
+			}
+		}
+		return supported;
+	}() };
+
+	// Only a few colors, so that scale2x finds edges to round. The upper index
+	// bits are garbage and must be ignored.
+	void randomFrame(std::vector<u8>& indices, std::vector<u8>& emphasis) {
+		std::mt19937 rng { 2024 };
+		for (auto& index : indices) {
+			index = static_cast<u8>((rng() & 0xc0) | (rng() % 4) * 0x11);
+		}
+		for (auto& bits : emphasis) {
+			bits = static_cast<u8>(rng() & 0x07);
+		}
+	}
+
+	bool benchConvert(
+		const std::vector<u8>& indices, const std::vector<u8>& emphasis, u64 iterations
+	) {
+		const auto palette { video::Palette::standard() };
+		std::vector<video::Rgba> reference(width * height);
+		video::convert(
+			indices.data(), emphasis.data(), width, height, palette, reference.data(),
+			Isa::SCALAR
+		);
+
+		bool ok { true };
+		for (const auto isa : isas) {
+			std::vector<video::Rgba> out(width * height);
+			video::convert(
+				indices.data(), emphasis.data(), width, height, palette, out.data(), isa
+			);
+			if (out != reference) {
+				std::printf("convert/%s: differs from scalar\n", simd::isaName(isa));
+				ok = false;
+				continue;
+			}
+
+			const std::string name { std::string { "convert/" } + simd::isaName(isa) };
+			bench::measure(name.c_str(), iterations, [&] {
+				video::convert(
+					indices.data(), emphasis.data(), width, height, palette, out.data(),
+					isa
+				);
+			});
+		}
+
+		return ok;
+	}
+
+	bool benchScale(
+		const std::vector<video::Rgba>& frame, video::Scaler scaler, u32 factor,
+		const char *label, u64 iterations
+	) {
+		const std::size_t size {
+			static_cast<std::size_t>(video::scaledSize(scaler, width, factor))
+			* video::scaledSize(scaler, height, factor)
+		};
+		std::vector<video::Rgba> reference(size);
+		video::scale(
+			scaler, frame.data(), width, height, factor, reference.data(),
+			Isa::SCALAR
+		);
+
+		bool ok { true };
+		for (const auto isa : isas) {
+			std::vector<video::Rgba> out(size);
+			const auto run { [&] {
+				video::scale(
+					scaler, frame.data(), width, height, factor, out.data(), isa
+				);
+			} };
+			run();
+			if (out != reference) {
+				std::printf("%s/%s: differs from scalar\n", label, simd::isaName(isa));
+				ok = false;
+				continue;
+			}
+
+			const std::string name { std::string { label } + "/" + simd::isaName(isa) };
+			bench::measure(name.c_str(), iterations, run);
+		}
+
+		return ok;
+	}
+} // namespace
+
+int main(int argc, char *argv[]) {
+	const u64 iterations { bench::parseArgs(argc, argv, 2000).count };
+
+	std::vector<u8> indices(width * height);
+	std::vector<u8> emphasis(height);
+	randomFrame(indices, emphasis);
+
+	std::vector<video::Rgba> frame(width * height);
+	video::convert(
+		indices.data(), emphasis.data(), width, height, video::Palette::standard(),
+		frame.data(), Isa::SCALAR
+	);
+
+	bool ok { benchConvert(indices, emphasis, iterations) };
+	ok &= benchScale(frame, video::Scaler::INTEGER, 2, "integer2x", iterations);
+	ok &= benchScale(frame, video::Scaler::INTEGER, 3, "integer3x", iterations);
+	ok &= benchScale(frame, video::Scaler::SCALE2X, 2, "scale2x", iterations);
+
+	return ok ? 0 : 1;
+}
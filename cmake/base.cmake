@@ -27,6 +27,17 @@ set_property(
 			"Release"
 )
 
+# Diagnostics below this level are compiled out of the core.
+set(NES_LOG_LEVEL INFO CACHE STRING "Lowest diagnostics level compiled into the core.")
+set(NES_LOG_LEVELS TRACE DEBUG INFO WARN ERROR OFF)
+set_property(CACHE NES_LOG_LEVEL PROPERTY STRINGS ${NES_LOG_LEVELS})
+
+list(FIND NES_LOG_LEVELS "${NES_LOG_LEVEL}" NES_LOG_LEVEL_INDEX)
+if(NES_LOG_LEVEL_INDEX EQUAL -1)
+	message(FATAL_ERROR "NES_LOG_LEVEL must be one of: ${NES_LOG_LEVELS}")
+endif()
+add_compile_definitions(NES_LOG_LEVEL=${NES_LOG_LEVEL_INDEX})
+
 # Enable CCACHE.
 find_program(CCACHE_PROGRAM ccache)
 if(CCACHE_PROGRAM)
@@ -0,0 +1,60 @@
+include_guard()
+
+option(NES_BUILD_BENCHMARKS "Build the micro benchmarks." OFF)
+
+function(add_benchmark name)
+	# Add a benchmark built from `bench/<name>.cpp`, linked against the emulation
+	# core (`libnes`), which is built once for all of them.
+	#
+	# Args:
+	#	name: The benchmark name.
+	#	ARGN: Extra sources the benchmark needs.
+
+	add_executable(${name})
+
+	target_compile_features(
+		${name}
+		PRIVATE
+			cxx_std_17
+	)
+
+	target_sources(
+		${name}
+		PRIVATE
+			${ARGN}
+			bench/${name}.cpp
+	)
+
+	target_include_directories(
+		${name}
+		PRIVATE
+			${PROJECT_SOURCE_DIR}/include
+	)
+
+	target_compile_options(${name} PRIVATE -O3)
+
+	set_default_warnings(${name})
+	link_core_libraries(${name})
+	target_link_libraries(${name} PRIVATE libnes)
+endfunction()
+
+function(add_benchmark_test name iterations)
+	# Register the benchmark `name`, which exits with 1 when a SIMD path differs
+	# from the scalar one, as the CTest test `check_<name>`. A few iterations are
+	# enough: the check runs before the timing.
+	#
+	# Args:
+	#	name: The benchmark name, see `add_benchmark`.
+	#	iterations: The count passed to the benchmark.
+
+	add_test(
+		NAME check_${name}
+		COMMAND ${name} ${iterations}
+	)
+
+	set_tests_properties(
+		check_${name}
+		PROPERTIES
+			LABELS simd
+	)
+endfunction()
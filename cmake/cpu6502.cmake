@@ -0,0 +1,10 @@
+include_guard()
+
+set(
+	NES_6502_TEST_IMAGE ""
+	CACHE FILEPATH "6502 test binary (e.g. 6502_functional_test.bin) to run with CTest."
+)
+set(
+	NES_6502_TEST_SUCCESS "3469"
+	CACHE STRING "Address (hex) the 6502 functional test traps at when it passes."
+)
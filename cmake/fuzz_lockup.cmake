@@ -0,0 +1,20 @@
+# Run `fuzz_console` on a ROM stuck in a loop and check it reports a lockup, see
+# `add_fuzzer_lockup_test` in cmake/fuzzing.cmake.
+#
+# Variables:
+#	FUZZER: The fuzz_console executable.
+#	ROM: The ROM to run.
+#	INPUT: The fuzz input to replay.
+
+set(ENV{NES_FUZZ_ROM} ${ROM})
+set(ENV{NES_FUZZ_HANGS} 3)
+
+execute_process(
+	COMMAND ${FUZZER} ${INPUT}
+	RESULT_VARIABLE result
+	ERROR_VARIABLE errors
+)
+
+if(result EQUAL 0 OR NOT errors MATCHES "Console locked up")
+	message(FATAL_ERROR "No lockup reported (exit: ${result}):\n${errors}")
+endif()
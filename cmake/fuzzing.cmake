@@ -0,0 +1,105 @@
+include_guard()
+
+option(NES_BUILD_FUZZERS "Build the in-process fuzzing harnesses." OFF)
+
+function(add_fuzz_core)
+	# Add `nes_fuzz_core`, the emulation core built once for all the fuzz targets,
+	# with guest coverage tracking and the sanitizers they run under.
+
+	add_library(nes_fuzz_core OBJECT)
+
+	target_compile_features(
+		nes_fuzz_core
+		PUBLIC
+			cxx_std_17
+	)
+
+	target_sources(
+		nes_fuzz_core
+		PRIVATE
+			${NES_CORE_SOURCES}
+	)
+
+	target_include_directories(
+		nes_fuzz_core
+		PUBLIC
+			${PROJECT_SOURCE_DIR}/include
+	)
+
+	# Compile in guest coverage tracking, which changes the CPU layout: the
+	# harnesses get the definition too.
+	target_compile_definitions(nes_fuzz_core PUBLIC NES_FUZZING)
+	target_compile_options(nes_fuzz_core PRIVATE -g -O2)
+
+	if(USING_CLANG)
+		# The harness links libFuzzer, the core only needs its instrumentation.
+		target_compile_options(
+			nes_fuzz_core PRIVATE -fsanitize=fuzzer-no-link,address,undefined
+		)
+	endif()
+
+	set_default_warnings(nes_fuzz_core)
+	link_core_libraries(nes_fuzz_core)
+endfunction()
+
+function(add_fuzzer name)
+	# Add a fuzz target built from `fuzz/<name>.cpp`, linked against
+	# `nes_fuzz_core`.
+	#
+	# With Clang the target links against libFuzzer, other compilers get a
+	# standalone driver that replays the inputs given on the command line.
+
+	if(NOT TARGET nes_fuzz_core)
+		add_fuzz_core()
+	endif()
+
+	add_executable(${name})
+
+	target_compile_features(
+		${name}
+		PRIVATE
+			cxx_std_17
+	)
+
+	target_sources(
+		${name}
+		PRIVATE
+			fuzz/${name}.cpp
+	)
+
+	target_compile_options(${name} PRIVATE -g -O2)
+
+	if(USING_CLANG)
+		target_compile_options(${name} PRIVATE -fsanitize=fuzzer,address,undefined)
+		target_link_options(${name} PRIVATE -fsanitize=fuzzer,address,undefined)
+	else()
+		target_sources(${name} PRIVATE fuzz/standalone.cpp)
+	endif()
+
+	set_default_warnings(${name})
+	link_core_libraries(${name})
+	target_link_libraries(${name} PRIVATE nes_fuzz_core)
+endfunction()
+
+function(add_fuzzer_lockup_test name rom)
+	# Register the CTest test `fuzz_lockup_<name>`: `fuzz_console` runs `rom`,
+	# which must be stuck in a loop, for 20 frames and has to report a lockup.
+	# The fuzzer aborts on a lockup, which CTest cannot expect, so the test runs
+	# it through cmake/fuzz_lockup.cmake.
+	#
+	# Args:
+	#	name: The test name.
+	#	rom: The ROM to run.
+
+	# 20 records holding no button and running one frame each.
+	set(input ${CMAKE_BINARY_DIR}/fuzz/lockup.input)
+	string(REPEAT "AAA" 20 records)
+	file(WRITE ${input} ${records})
+
+	add_test(
+		NAME fuzz_lockup_${name}
+		COMMAND
+			${CMAKE_COMMAND} -D FUZZER=$<TARGET_FILE:fuzz_console> -D ROM=${rom}
+				-D INPUT=${input} -P ${PROJECT_SOURCE_DIR}/cmake/fuzz_lockup.cmake
+	)
+endfunction()
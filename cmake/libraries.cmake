@@ -2,6 +2,20 @@ include_guard()
 
 set(LIBS_DIR ${PROJECT_SOURCE_DIR}/vendor)
 
+function(link_core_libraries target)
+	# Libraries needed by the emulation core alone (no window, no audio).
+	if(NOT TARGET spdlog::spdlog)
+		set(SPDLOG_ENABLE_PCH ON)
+		add_subdirectory(${LIBS_DIR}/spdlog)
+	endif()
+
+	target_link_libraries(
+		${target}
+		PRIVATE
+			spdlog::spdlog
+	)
+endfunction()
+
 function(link_default_libraries target)
 	find_package(
 		SFML 2.6.0
@@ -9,17 +23,16 @@ function(link_default_libraries target)
 			window graphics audio
 		REQUIRED
 	)
+	find_package(Threads REQUIRED)
 
-	set(SPDLOG_ENABLE_PCH ON)
-	add_subdirectory(${LIBS_DIR}/spdlog)
+	link_core_libraries(${target})
 
 	target_link_libraries(
 		${target}
 		PRIVATE
+			Threads::Threads
 			sfml-window
 			sfml-graphics
 			sfml-audio
-
-			spdlog::spdlog
 	)
 endfunction()
@@ -0,0 +1,46 @@
+include_guard()
+
+option(NES_BUILD_PERF_TESTS "Register the end-to-end throughput tests with CTest." OFF)
+
+set(
+	NES_PERF_MAX_DROP 10
+	CACHE STRING "Largest fps drop below the baseline (percent) a throughput test allows."
+)
+
+# Baselines only make sense on the machine they were measured on.
+cmake_host_system_information(RESULT NES_PERF_HOST QUERY HOSTNAME)
+set(
+	NES_PERF_BASELINE_DIR ${PROJECT_SOURCE_DIR}/perf/baselines/${NES_PERF_HOST}
+	CACHE PATH "Directory holding the throughput baselines of this machine."
+)
+
+function(add_throughput_test name rom frames)
+	# Register `nes-throughput` on one workload as the CTest test `throughput_<name>`.
+	#
+	# The result goes to `<build>/perf/<name>.json`, and is checked against the
+	# file of the same name in NES_PERF_BASELINE_DIR when there is one.
+	#
+	# Args:
+	#	name: The workload name.
+	#	rom: The ROM to run.
+	#	frames: How many frames to emulate per run.
+	#	ARGN: Extra `nes-throughput` options, e.g. `--movie <file.fm2>`.
+
+	add_test(
+		NAME throughput_${name}
+		COMMAND
+			nes-throughput ${name} ${rom} ${frames}
+				--json ${CMAKE_BINARY_DIR}/perf/${name}.json
+				--baseline ${NES_PERF_BASELINE_DIR}/${name}.json
+				--max-drop ${NES_PERF_MAX_DROP}
+				${ARGN}
+	)
+
+	# Timings are only comparable with the machine otherwise idle.
+	set_tests_properties(
+		throughput_${name}
+		PROPERTIES
+			LABELS throughput
+			RUN_SERIAL TRUE
+	)
+endfunction()
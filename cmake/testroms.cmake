@@ -0,0 +1,29 @@
+include_guard()
+
+set(
+	NES_TEST_ROM_DIR ""
+	CACHE PATH "Directory of test ROMs (blargg's $6000 protocol) to run with CTest."
+)
+
+function(add_test_rom_suite name directory)
+	# Register `nes-testroms` on a directory of test ROMs as the CTest test
+	# `test_roms_<name>`. The ROMs run in parallel inside the test.
+	#
+	# Args:
+	#	name: The suite name.
+	#	directory: The directory searched for .nes files.
+	#	ARGN: Extra `nes-testroms` options, e.g. `--accuracy fast`.
+
+	add_test(
+		NAME test_roms_${name}
+		COMMAND nes-testroms ${directory} ${ARGN}
+	)
+
+	# The test already uses every core.
+	set_tests_properties(
+		test_roms_${name}
+		PROPERTIES
+			LABELS test_roms
+			RUN_SERIAL TRUE
+	)
+endfunction()
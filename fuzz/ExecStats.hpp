@@ -0,0 +1,51 @@
+#ifndef _FUZZ_EXECSTATS_HPP_
+#define _FUZZ_EXECSTATS_HPP_
+
+#include "common/types.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+namespace fuzz {
+	// Count executions and periodically print the sustained exec/sec of this
+	// process (one fuzzing process runs per core).
+	class ExecStats {
+	public:
+		explicit ExecStats(const char *name)
+			: m_name(name) {}
+
+		~ExecStats() { report(); }
+
+		void tick() {
+			m_execs += 1;
+
+			// Only look at the clock every 1024 execs.
+			if ((m_execs & 0x3ff) == 0) {
+				const auto now { std::chrono::steady_clock::now() };
+				if (now - m_last_report >= std::chrono::seconds(10)) {
+					report();
+					m_last_report = now;
+				}
+			}
+		}
+
+	private:
+		void report() const {
+			const std::chrono::duration<double> elapsed {
+				std::chrono::steady_clock::now() - m_start
+			};
+			std::fprintf(
+				stderr, "[%s] %llu execs in %.1fs: %.0f exec/s per core\n", m_name,
+				static_cast<unsigned long long>(m_execs), elapsed.count(),
+				static_cast<double>(m_execs) / elapsed.count()
+			);
+		}
+
+		const char *m_name;
+		u64 m_execs { 0 };
+		std::chrono::steady_clock::time_point m_start { std::chrono::steady_clock::now() };
+		std::chrono::steady_clock::time_point m_last_report { m_start };
+	};
+} // namespace fuzz
+
+#endif // _FUZZ_EXECSTATS_HPP_
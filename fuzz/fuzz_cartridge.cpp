@@ -0,0 +1,44 @@
+// iNES loader fuzzer: parse arbitrary bytes as a cartridge image and, when the
+// loader accepts it, exercise the whole mapper address space.
+
+#include "ExecStats.hpp"
+#include "nes/Cartridge.hpp"
+#include "nes/Mapper.hpp"
+
+#include <array>
+#include <cstddef>
+#include <spdlog/spdlog.h>
+
+extern "C" int LLVMFuzzerInitialize(int * /* argc */, char *** /* argv */) {
+	spdlog::set_level(spdlog::level::off);
+	return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const u8 *data, std::size_t size) {
+	static fuzz::ExecStats stats { "fuzz_cartridge" };
+	stats.tick();
+
+	auto cartridge { nes::Cartridge::loadMemory(data, size) };
+	if (!cartridge) {
+		return 0;
+	}
+
+	nes::Mapper::State state {};
+	auto mapper { nes::Mapper::create(std::move(*cartridge), state) };
+	if (mapper == nullptr) {
+		return 0;
+	}
+
+	for (u32 addr { 0x4020 }; addr <= 0xffff; ++addr) {
+		static_cast<void>(mapper->cpuRead(static_cast<u16>(addr)));
+	}
+
+	// Pattern tables and nametables.
+	std::array<u8, 2 * MAPPER_PPU_WINDOW_SIZE> vram {};
+	mapper->connectNametables(vram.data());
+	for (u32 addr { 0x0000 }; addr < 0x3f00; ++addr) {
+		mapper->ppuWrite(static_cast<u16>(addr), mapper->ppuRead(static_cast<u16>(addr)));
+	}
+
+	return 0;
+}
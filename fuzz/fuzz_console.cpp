@@ -0,0 +1,102 @@
+// Snapshot-reset console fuzzer.
+//
+// The ROM under test is loaded once from $NES_FUZZ_ROM and powered up; that state
+// is kept as the baseline snapshot. Every input restores the baseline in-process
+// and is interpreted as a sequence of 3 byte records:
+//
+// 	[op, a, b] with op bit 7 clear: hold `a` on controller 1 and `b` on controller
+// 	                                2, then run one frame.
+// 	[op, a, b] with op bit 7 set  : RAM patch, RAM[(op & 0x07) << 8 | a] = b.
+//
+// At most $NES_FUZZ_FRAMES frames (default 60) are run per input. Guest coverage
+// is reported as a PC edge map through libFuzzer's extra counters. With
+// $NES_FUZZ_HANGS set, an input that leaves RAM and the registers unchanged for
+// that many consecutive frames is reported as a lockup (see `Bus::hashProgress`).
+
+#include "ExecStats.hpp"
+#include "nes/Bus.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <spdlog/spdlog.h>
+
+namespace {
+	std::unique_ptr<nes::Bus> bus {};
+	nes::State baseline {};
+
+	u32 max_frames { 60 };
+	u32 hang_frames { 0 };
+
+	u32 envOr(const char *name, u32 fallback) {
+		const char *value { std::getenv(name) };
+		return value != nullptr ? std::strtoul(value, nullptr, 10) : fallback;
+	}
+} // namespace
+
+extern "C" int LLVMFuzzerInitialize(int * /* argc */, char *** /* argv */) {
+	spdlog::set_level(spdlog::level::off);
+
+	const char *rom_path { std::getenv("NES_FUZZ_ROM") };
+	if (rom_path == nullptr) {
+		std::fprintf(stderr, "Set NES_FUZZ_ROM to the ROM under test.\n");
+		std::exit(EXIT_FAILURE);
+	}
+
+	auto cartridge { nes::Cartridge::loadFile(rom_path) };
+	if (!cartridge) {
+		std::fprintf(stderr, "Cannot load %s\n", rom_path);
+		std::exit(EXIT_FAILURE);
+	}
+
+	max_frames = envOr("NES_FUZZ_FRAMES", max_frames);
+	hang_frames = envOr("NES_FUZZ_HANGS", hang_frames);
+
+	bus = std::make_unique<nes::Bus>();
+	bus->insert(std::move(*cartridge));
+	bus->power();
+	bus->saveState(baseline);
+
+	return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const u8 *data, std::size_t size) {
+	static fuzz::ExecStats stats { "fuzz_console" };
+	stats.tick();
+
+	bus->loadState(baseline);
+
+	u32 frames { 0 };
+	u32 unchanged_frames { 0 };
+	u64 last_hash { bus->hashProgress() };
+
+	for (std::size_t i { 0 }; i + 3 <= size && frames < max_frames; i += 3) {
+		const u8 op { data[i] };
+		const u8 a { data[i + 1] };
+		const u8 b { data[i + 2] };
+
+		if (op & 0x80) {
+			bus->cpuWrite(static_cast<u16>(((op & 0x07) << 8) | a), b);
+			continue;
+		}
+
+		bus->setController(0, a);
+		bus->setController(1, b);
+		bus->runFrame();
+		frames += 1;
+
+		if (hang_frames > 0) {
+			const u64 hash { bus->hashProgress() };
+			unchanged_frames = hash == last_hash ? unchanged_frames + 1 : 0;
+			last_hash = hash;
+
+			if (unchanged_frames >= hang_frames) {
+				std::fprintf(stderr, "Console locked up at frame %u\n", frames);
+				std::abort();
+			}
+		}
+	}
+
+	return 0;
+}
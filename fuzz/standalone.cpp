@@ -0,0 +1,31 @@
+// Minimal driver for compilers without libFuzzer: runs every file given on the
+// command line through the fuzz target once, e.g. to replay a crash or corpus.
+
+#include "common/types.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+extern "C" int LLVMFuzzerInitialize(int *argc, char ***argv);
+extern "C" int LLVMFuzzerTestOneInput(const u8 *data, std::size_t size);
+
+int main(int argc, char *argv[]) {
+	LLVMFuzzerInitialize(&argc, &argv);
+
+	for (int i { 1 }; i < argc; ++i) {
+		std::ifstream file(argv[i], std::ifstream::in | std::ifstream::binary);
+		if (!file) {
+			std::fprintf(stderr, "Cannot open %s\n", argv[i]);
+			return EXIT_FAILURE;
+		}
+
+		std::vector<u8> input { std::istreambuf_iterator<char>(file), {} };
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+#ifndef _AUDIO_RESAMPLER_HPP_
+#define _AUDIO_RESAMPLER_HPP_
+
+#include "common/Simd.hpp"
+#include "common/types.hpp"
+
+#include <cstddef>
+#include <vector>
+
+// Largest speed change the dynamic rate control may apply (0.5%), small enough
+// that the pitch shift cannot be heard.
+#define AUDIO_MAX_RATE_ADJUST 0.005
+
+namespace audio {
+	// Polyphase FIR resampler, from the APU sample rate (one sample per CPU cycle)
+	// down to the host rate.
+	//
+	// The filter is a Kaiser-windowed sinc cut off a bit below the output Nyquist
+	// frequency, stored as `PHASES + 1` sub-sample shifted copies so that every
+	// output sample is one dot product over the input history. That dot product is
+	// the only vectorized part.
+	class Resampler {
+	public:
+		static constexpr std::size_t PHASES { 64 };
+
+		Resampler(double input_rate, double output_rate, simd::Isa isa = simd::bestIsa());
+
+		// Play slightly faster (`adjust` > 0, fewer output samples) or slower, within
+		// `AUDIO_MAX_RATE_ADJUST`.
+		void setRateAdjust(double adjust);
+
+		// Feed `count` input samples and append the output samples they complete to
+		// `out`, returns how many were appended.
+		std::size_t process(const float *in, std::size_t count, std::vector<s16>& out);
+
+		[[nodiscard]] inline std::size_t getTaps() const { return m_taps; }
+
+		// Rate adjustment keeping an output buffer of `capacity` samples half full.
+		[[nodiscard]] static double dynamicRate(std::size_t fill, std::size_t capacity);
+
+	private:
+		[[nodiscard]] float dot(const float *kernel, const float *samples) const;
+
+		const simd::Isa m_isa;
+		const double m_ratio;
+		std::size_t m_taps { 0 };
+		double m_step { 0.0 };
+
+		// `PHASES + 1` rows of `m_taps` coefficients.
+		std::vector<float> m_kernel {};
+		// Pending input, `m_position` is where the next output sample falls in it.
+		std::vector<float> m_history {};
+		double m_position { 0.0 };
+	};
+} // namespace audio
+
+#endif // _AUDIO_RESAMPLER_HPP_
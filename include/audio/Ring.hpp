@@ -0,0 +1,34 @@
+#ifndef _AUDIO_RING_HPP_
+#define _AUDIO_RING_HPP_
+
+#include "common/types.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace audio {
+	// Single producer (emulation), single consumer (audio device thread) sample
+	// queue. Neither side ever blocks: pushing into a full ring drops the samples
+	// that do not fit, popping from an empty one returns fewer.
+	class Ring {
+	public:
+		explicit Ring(std::size_t capacity);
+		Ring(const Ring&) = delete;
+		Ring& operator=(const Ring&) = delete;
+
+		std::size_t push(const s16 *samples, std::size_t count);
+		std::size_t pop(s16 *samples, std::size_t count);
+
+		[[nodiscard]] std::size_t size() const;
+		[[nodiscard]] inline std::size_t capacity() const { return m_samples.size(); }
+
+	private:
+		std::vector<s16> m_samples;
+		// Total samples ever written and read, the difference is the fill level.
+		std::atomic<u64> m_write { 0 };
+		std::atomic<u64> m_read { 0 };
+	};
+} // namespace audio
+
+#endif // _AUDIO_RING_HPP_
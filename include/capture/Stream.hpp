@@ -0,0 +1,74 @@
+#ifndef _CAPTURE_STREAM_HPP_
+#define _CAPTURE_STREAM_HPP_
+
+#include "common/types.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace capture {
+	// Byte stream written to a file or piped to a command by a writer thread.
+	//
+	// Data is appended to a front buffer, which is handed to the thread once it
+	// holds a full block while the producer carries on with the back buffer. The
+	// producer only ever waits when the thread is still busy with the previous
+	// block, that time is counted in `getStallTime`.
+	class Stream {
+	public:
+		Stream() = default;
+		Stream(const Stream&) = delete;
+		Stream& operator=(const Stream&) = delete;
+		~Stream();
+
+		// `target` is a file path, or a shell command after a '|'.
+		[[nodiscard]] bool open(std::string_view target);
+
+		// Space for `size` more bytes, valid until the next call.
+		[[nodiscard]] u8 *append(std::size_t size);
+		void append(const void *data, std::size_t size);
+
+		// Write everything out and stop the thread, the stream stays open.
+		void drain();
+		// Overwrite bytes already written (after `drain`, files only).
+		bool patch(u64 offset, const void *data, std::size_t size);
+		void close();
+
+		[[nodiscard]] inline bool isOpen() const { return m_file != nullptr; }
+		[[nodiscard]] inline bool isPipe() const { return m_pipe; }
+		[[nodiscard]] inline bool failed() const { return m_failed; }
+		[[nodiscard]] inline u64 getBytes() const { return m_bytes; }
+		[[nodiscard]] inline std::chrono::nanoseconds getStallTime() const {
+			return m_stall_time;
+		}
+
+	private:
+		void handOver();
+		void run();
+
+		std::FILE *m_file { nullptr };
+		bool m_pipe { false };
+
+		std::vector<u8> m_front {};
+		std::vector<u8> m_back {};
+
+		// Guards m_back, m_pending and m_stop.
+		std::mutex m_mutex {};
+		std::condition_variable m_wake {};
+		std::condition_variable m_done {};
+		bool m_pending { false };
+		bool m_stop { false };
+		bool m_failed { false };
+		std::thread m_thread {};
+
+		u64 m_bytes { 0 };
+		std::chrono::nanoseconds m_stall_time {};
+	};
+} // namespace capture
+
+#endif // _CAPTURE_STREAM_HPP_
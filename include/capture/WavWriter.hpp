@@ -0,0 +1,34 @@
+#ifndef _CAPTURE_WAVWRITER_HPP_
+#define _CAPTURE_WAVWRITER_HPP_
+
+#include "capture/Stream.hpp"
+#include "common/types.hpp"
+
+#include <cstddef>
+#include <string_view>
+
+namespace capture {
+	// 16-bit PCM WAV. The chunk sizes are filled in on close for files, pipes get
+	// the "unknown length" 0xffffffff that ffmpeg and sox accept.
+	class WavWriter {
+	public:
+		[[nodiscard]] bool open(std::string_view target, u32 rate, u16 channels = 1);
+		// `count` interleaved samples.
+		void write(const s16 *samples, std::size_t count);
+		void writeSilence(std::size_t count);
+		void close();
+
+		[[nodiscard]] inline bool isOpen() const { return m_stream.isOpen(); }
+		[[nodiscard]] inline u32 getRate() const { return m_rate; }
+		[[nodiscard]] inline u64 getSamples() const { return m_samples; }
+		[[nodiscard]] inline const Stream& getStream() const { return m_stream; }
+
+	private:
+		Stream m_stream {};
+		u32 m_rate { 0 };
+		u16 m_channels { 1 };
+		u64 m_samples { 0 };
+	};
+} // namespace capture
+
+#endif // _CAPTURE_WAVWRITER_HPP_
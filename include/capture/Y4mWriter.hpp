@@ -0,0 +1,61 @@
+#ifndef _CAPTURE_Y4MWRITER_HPP_
+#define _CAPTURE_Y4MWRITER_HPP_
+
+#include "capture/Stream.hpp"
+#include "common/types.hpp"
+#include "video/Palette.hpp"
+
+#include <array>
+#include <string_view>
+#include <vector>
+
+// Frame rate of the stream: 236.25 MHz / 11 master clock, 4 per dot, 89342 dots
+// per frame (~60.0988 fps), as a reduced fraction.
+#define Y4M_FPS_NUMERATOR 29531250
+#define Y4M_FPS_DENOMINATOR 491381
+
+namespace capture {
+	// Raw video as YUV4MPEG2, 4:4:4 planar so pixel art keeps its colors, e.g. for
+	// `ffmpeg -i - out.mkv`. Pixels go straight from NES color indices to YUV.
+	//
+	// With `skip_unchanged`, a frame identical to the previous one (same indices
+	// and emphasis) is not converted again: the last converted frame is repeated,
+	// so the stream keeps its constant frame rate.
+	class Y4mWriter {
+	public:
+		explicit Y4mWriter(const video::Palette& palette = video::Palette::standard());
+
+		[[nodiscard]] bool
+		open(std::string_view target, u32 width, u32 height, bool skip_unchanged);
+		// `width` x `height` indices and one emphasis value per line.
+		void writeFrame(const u8 *indices, const u8 *emphasis);
+		void close();
+
+		[[nodiscard]] inline bool isOpen() const { return m_stream.isOpen(); }
+		[[nodiscard]] inline u64 getFrames() const { return m_frames; }
+		[[nodiscard]] inline u64 getRepeated() const { return m_repeated; }
+		[[nodiscard]] inline const Stream& getStream() const { return m_stream; }
+
+	private:
+		void convert(const u8 *indices, const u8 *emphasis, u8 *out) const;
+
+		// Y, Cb, Cr of every color, for each emphasis value.
+		std::array<std::array<u8, 3>, video::Palette::EMPHASIS * video::Palette::COLORS>
+			m_yuv {};
+
+		Stream m_stream {};
+		u32 m_width { 0 };
+		u32 m_height { 0 };
+		bool m_skip_unchanged { false };
+
+		// Last frame written, when skipping unchanged ones.
+		std::vector<u8> m_indices {};
+		std::vector<u8> m_emphasis {};
+		std::vector<u8> m_frame {};
+
+		u64 m_frames { 0 };
+		u64 m_repeated { 0 };
+	};
+} // namespace capture
+
+#endif // _CAPTURE_Y4MWRITER_HPP_
@@ -0,0 +1,29 @@
+#ifndef _COMMON_BITS_HPP_
+#define _COMMON_BITS_HPP_
+
+#include "common/types.hpp"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+	#include <intrin.h>
+#endif
+
+namespace bits {
+	// Index of the lowest set bit of `x`, which must not be 0.
+	[[nodiscard]] inline u32 countTrailingZeros(u64 x) {
+#if defined(__GNUC__) || defined(__clang__)
+		return static_cast<u32>(__builtin_ctzll(x));
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+		unsigned long index {};
+		_BitScanForward64(&index, x);
+		return static_cast<u32>(index);
+#else
+		u32 index { 0 };
+		for (; (x & 1) == 0; x >>= 1) {
+			index += 1;
+		}
+		return index;
+#endif
+	}
+} // namespace bits
+
+#endif // _COMMON_BITS_HPP_
@@ -0,0 +1,135 @@
+// Diagnostics channel for the emulation core, safe to use on hot paths.
+//
+// - Levels below NES_LOG_LEVEL are compiled out entirely.
+// - Every call site counts its hits. The first DIAG_BURST messages of a site
+//   go through, after that only the 2^n-th ones do, tagged with the count. A
+//   suppressed message costs a counter increment.
+// - Messages are formatted by the caller into a fixed-size slot of a lock-free
+//   queue, and a background thread hands them to spdlog. The emulation thread
+//   never waits on I/O; if the queue is full the message is dropped and counted.
+
+#ifndef _COMMON_DIAG_HPP_
+#define _COMMON_DIAG_HPP_
+
+#include "common/types.hpp"
+
+#include <spdlog/fmt/fmt.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <utility>
+
+#define NES_LOG_LEVEL_TRACE 0
+#define NES_LOG_LEVEL_DEBUG 1
+#define NES_LOG_LEVEL_INFO 2
+#define NES_LOG_LEVEL_WARN 3
+#define NES_LOG_LEVEL_ERROR 4
+#define NES_LOG_LEVEL_OFF 5
+
+// Set by the build, see the NES_LOG_LEVEL cache variable.
+#ifndef NES_LOG_LEVEL
+#define NES_LOG_LEVEL NES_LOG_LEVEL_INFO
+#endif
+
+// Messages of one call site always shown before rate limiting kicks in.
+#define DIAG_BURST 8
+
+// Longest message, longer ones are truncated.
+#define DIAG_MESSAGE_SIZE 256
+
+#define NES_DIAG(level, ...)                                                        \
+	do {                                                                            \
+		if constexpr ((level) >= NES_LOG_LEVEL) {                                   \
+			static diag::Site diag_site_ { (level), __FILE__, __LINE__ };           \
+			if (const u64 diag_count_ { diag_site_.hit() }; diag_count_ != 0) {     \
+				diag::log(diag_site_, diag_count_, __VA_ARGS__);                    \
+			}                                                                       \
+		}                                                                           \
+	} while (false)
+
+#define NES_TRACE(...) NES_DIAG(NES_LOG_LEVEL_TRACE, __VA_ARGS__)
+#define NES_DEBUG(...) NES_DIAG(NES_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define NES_INFO(...) NES_DIAG(NES_LOG_LEVEL_INFO, __VA_ARGS__)
+#define NES_WARN(...) NES_DIAG(NES_LOG_LEVEL_WARN, __VA_ARGS__)
+#define NES_ERROR(...) NES_DIAG(NES_LOG_LEVEL_ERROR, __VA_ARGS__)
+
+namespace diag {
+	// One logging call site, registered on its first hit.
+	class Site {
+	public:
+		Site(int level, const char *file, int line);
+		Site(const Site&) = delete;
+		Site& operator=(const Site&) = delete;
+
+		// Count a hit, and return the count if the message should be shown, 0 if
+		// it is suppressed. A plain load and store rather than a locked add: the
+		// count only feeds rate limiting, so hits racing on two threads may merge.
+		[[nodiscard]] inline u64 hit() {
+			const u64 count { m_count.load(std::memory_order_relaxed) + 1 };
+			m_count.store(count, std::memory_order_relaxed);
+			return count <= DIAG_BURST || (count & (count - 1)) == 0 ? count : 0;
+		}
+
+		[[nodiscard]] inline u64 getCount() const {
+			return m_count.load(std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] inline int getLevel() const { return m_level; }
+		[[nodiscard]] inline const char *getFile() const { return m_file; }
+		[[nodiscard]] inline int getLine() const { return m_line; }
+
+	private:
+		friend void report();
+
+		const int m_level;
+		const char *const m_file;
+		const int m_line;
+
+		std::atomic<u64> m_count { 0 };
+		// Intrusive list of all the sites, for `report`.
+		Site *m_next { nullptr };
+	};
+
+	// A queued message, `count` is the site's hit count when it was logged.
+	struct Message {
+		const Site *site;
+		u64 count;
+		u32 size;
+		std::array<char, DIAG_MESSAGE_SIZE> text;
+	};
+
+	// Reserve a queue slot, nullptr when the queue is full (the message is
+	// counted as dropped). Must be followed by `commit`.
+	[[nodiscard]] Message *acquire();
+	void commit(Message *message);
+
+	template<typename... Args>
+	void log(
+		const Site& site, u64 count, fmt::format_string<Args...> format, Args&&...args
+	) {
+		Message *message { acquire() };
+		if (message == nullptr) {
+			return;
+		}
+
+		message->site = &site;
+		message->count = count;
+		const auto result { fmt::format_to_n(
+			message->text.data(), message->text.size(), format, std::forward<Args>(args)...
+		) };
+		message->size = static_cast<u32>(
+			std::min<std::size_t>(result.size, DIAG_MESSAGE_SIZE)
+		);
+		commit(message);
+	}
+
+	// Wait until every queued message has been handed to spdlog.
+	void flush();
+
+	// Log the hit count of every site that was rate limited, and the messages
+	// dropped on a full queue.
+	void report();
+} // namespace diag
+
+#endif // _COMMON_DIAG_HPP_
@@ -0,0 +1,113 @@
+// 64-bit non-cryptographic hash (XXH64 algorithm)
+// https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+//
+// Used to fingerprint emulator state, so the result must be identical on every
+// build and platform: input is always consumed as little-endian words.
+
+#ifndef _COMMON_HASH_HPP_
+#define _COMMON_HASH_HPP_
+
+#include "common/types.hpp"
+
+#include <cstddef>
+
+namespace hash {
+	namespace detail {
+		constexpr u64 PRIME1 { 0x9e3779b185ebca87ULL };
+		constexpr u64 PRIME2 { 0xc2b2ae3d27d4eb4fULL };
+		constexpr u64 PRIME3 { 0x165667b19e3779f9ULL };
+		constexpr u64 PRIME4 { 0x85ebca77c2b2ae63ULL };
+		constexpr u64 PRIME5 { 0x27d4eb2f165667c5ULL };
+
+		[[nodiscard]] inline u64 rotl(u64 x, int r) {
+			return (x << r) | (x >> (64 - r));
+		}
+
+		[[nodiscard]] inline u64 read64(const u8 *p) {
+			return static_cast<u64>(p[0]) | (static_cast<u64>(p[1]) << 8)
+			     | (static_cast<u64>(p[2]) << 16) | (static_cast<u64>(p[3]) << 24)
+			     | (static_cast<u64>(p[4]) << 32) | (static_cast<u64>(p[5]) << 40)
+			     | (static_cast<u64>(p[6]) << 48) | (static_cast<u64>(p[7]) << 56);
+		}
+
+		[[nodiscard]] inline u32 read32(const u8 *p) {
+			return static_cast<u32>(p[0]) | (static_cast<u32>(p[1]) << 8)
+			     | (static_cast<u32>(p[2]) << 16) | (static_cast<u32>(p[3]) << 24);
+		}
+
+		[[nodiscard]] inline u64 round(u64 acc, u64 input) {
+			acc += input * PRIME2;
+			acc = rotl(acc, 31);
+			return acc * PRIME1;
+		}
+
+		[[nodiscard]] inline u64 merge(u64 acc, u64 val) {
+			acc ^= round(0, val);
+			return acc * PRIME1 + PRIME4;
+		}
+	} // namespace detail
+
+	// Hash `size` bytes at `data`. Chain calls by passing the previous result as
+	// `seed` to fingerprint several discontiguous regions.
+	[[nodiscard]] inline u64 xxh64(const void *data, std::size_t size, u64 seed = 0) {
+		using namespace detail;
+
+		const auto *p { static_cast<const u8 *>(data) };
+		const u8 *const end { p + size };
+		u64 h {};
+
+		if (size >= 32) {
+			u64 v1 { seed + PRIME1 + PRIME2 };
+			u64 v2 { seed + PRIME2 };
+			u64 v3 { seed };
+			u64 v4 { seed - PRIME1 };
+
+			const u8 *const limit { end - 32 };
+			do {
+				v1 = round(v1, read64(p));
+				v2 = round(v2, read64(p + 8));
+				v3 = round(v3, read64(p + 16));
+				v4 = round(v4, read64(p + 24));
+				p += 32;
+			} while (p <= limit);
+
+			h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+			h = merge(h, v1);
+			h = merge(h, v2);
+			h = merge(h, v3);
+			h = merge(h, v4);
+		} else {
+			h = seed + PRIME5;
+		}
+
+		h += static_cast<u64>(size);
+
+		while (p + 8 <= end) {
+			h ^= round(0, read64(p));
+			h = rotl(h, 27) * PRIME1 + PRIME4;
+			p += 8;
+		}
+
+		if (p + 4 <= end) {
+			h ^= static_cast<u64>(read32(p)) * PRIME1;
+			h = rotl(h, 23) * PRIME2 + PRIME3;
+			p += 4;
+		}
+
+		while (p < end) {
+			h ^= static_cast<u64>(*p) * PRIME5;
+			h = rotl(h, 11) * PRIME1;
+			p += 1;
+		}
+
+		h ^= h >> 33;
+		h *= PRIME2;
+		h ^= h >> 29;
+		h *= PRIME3;
+		h ^= h >> 32;
+
+		return h;
+	}
+} // namespace hash
+
+#endif // _COMMON_HASH_HPP_
@@ -0,0 +1,29 @@
+#ifndef _COMMON_SIMD_HPP_
+#define _COMMON_SIMD_HPP_
+
+#include "common/types.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+// SIMD paths are compiled with per-function target attributes and picked at
+// runtime, the rest of the build keeps the baseline instruction set.
+#define SIMD_X86 1
+#endif
+
+namespace simd {
+	// Instruction sets the vectorized stages (PPU, video, audio) have an implementation
+	// for. `SCALAR` is the reference the others are checked against.
+	enum class Isa : u8 {
+		SCALAR,
+		SSSE3,
+		AVX2,
+	};
+
+	[[nodiscard]] bool isSupported(Isa isa);
+
+	// Best instruction set supported by the host.
+	[[nodiscard]] Isa bestIsa();
+
+	[[nodiscard]] const char *isaName(Isa isa);
+} // namespace simd
+
+#endif // _COMMON_SIMD_HPP_
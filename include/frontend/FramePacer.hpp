@@ -0,0 +1,51 @@
+#ifndef _FRONTEND_FRAMEPACER_HPP_
+#define _FRONTEND_FRAMEPACER_HPP_
+
+#include "common/types.hpp"
+#include "nes/FrameSkip.hpp"
+
+#include <chrono>
+
+namespace frontend {
+	// FramePacer starts frames at a steady rate, NTSC's 60.0988 Hz by default.
+	//
+	// Waiting is a hybrid: sleep until shortly before the frame is due, then spin
+	// the rest of the way, as sleeps wake up late by anything up to a scheduler
+	// tick. The margin left for spinning follows how late sleeps actually were.
+	// Deadlines follow each other, so an early or late frame does not move the
+	// ones after it; falling more than a few frames behind starts over instead of
+	// rushing to catch up.
+	class FramePacer {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		explicit FramePacer(
+			std::chrono::nanoseconds period = std::chrono::nanoseconds { NES_FRAME_NS }
+		);
+
+		// Run slower (`adjust` > 0, longer frames) or faster than the period, e.g.
+		// to follow the audio device clock.
+		inline void setRateAdjust(double adjust) { m_adjust = adjust; }
+
+		// Wait until the next frame is due, returning how late it starts.
+		std::chrono::nanoseconds wait();
+
+		// Start over from the next `wait`, e.g. after a pause.
+		inline void reset() { m_started = false; }
+
+		// Time left for spinning before each deadline.
+		[[nodiscard]] inline std::chrono::nanoseconds getSpinMargin() const {
+			return m_margin;
+		}
+
+	private:
+		const std::chrono::nanoseconds m_period;
+		double m_adjust { 0.0 };
+
+		bool m_started { false };
+		Clock::time_point m_deadline {};
+		std::chrono::nanoseconds m_margin;
+	};
+} // namespace frontend
+
+#endif // _FRONTEND_FRAMEPACER_HPP_
@@ -0,0 +1,94 @@
+#ifndef _FRONTEND_FRAMESTATS_HPP_
+#define _FRONTEND_FRAMESTATS_HPP_
+
+#include "common/types.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+namespace frontend {
+	// FrameStats keeps the host timestamps of the last frames: when their input
+	// was polled, when emulating them ended, and when their picture was
+	// presented. From them come frame times (present to present) and input
+	// latency (input poll to the present of the picture showing its effect).
+	//
+	// Older frames are dropped, so a long session takes no more memory; they
+	// can be kept in a CSV file instead, written as the frames are presented.
+	class FrameStats {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		// Keep the last `frames` frames (at least 2).
+		explicit FrameStats(std::size_t frames);
+
+		struct Frame {
+			Clock::time_point input;
+			Clock::time_point emulated;
+			Clock::time_point presented;
+		};
+
+		// Percentiles over a number of frames, in milliseconds.
+		struct Summary {
+			u64 frames;
+			double frame_p50;
+			double frame_p99;
+			double latency_p50;
+			double latency_p99;
+		};
+
+		// Pictures can show the emulation some frames late, e.g. with deferred
+		// drawing (see `FrameRenderer`): latency is then measured from the input of
+		// that many frames before.
+		inline void setPictureLag(u32 frames) { m_picture_lag = frames; }
+
+		// Stamp the steps of the current frame, in order.
+		void markInput();
+		inline void markEmulated() { m_current.emulated = Clock::now(); }
+		void markPresented();
+
+		// Frames presented so far, kept or not.
+		[[nodiscard]] inline u64 getFrameCount() const { return m_count; }
+
+		// Percentiles over the last `frames` presented frames (all those kept with
+		// 0).
+		[[nodiscard]] Summary summarize(std::size_t frames = 0) const;
+
+		// From now on, write a line per presented frame to `path`: timestamps from
+		// the first input poll, frame time and input latency, all in milliseconds.
+		[[nodiscard]] bool openCsv(std::string_view path);
+
+		// Flush the CSV file and close it, false when a line could not be written.
+		// Nothing to do without one.
+		[[nodiscard]] bool closeCsv();
+
+	private:
+		[[nodiscard]] inline bool isKept(u64 n) const {
+			return n < m_count && m_count - n <= m_frames.size();
+		}
+
+		// Frame `n` (counted from the first one), which must still be kept.
+		[[nodiscard]] inline const Frame& frame(u64 n) const {
+			return m_frames[n % m_frames.size()];
+		}
+
+		// Frame time and latency of frame `n`, negative when there is none.
+		[[nodiscard]] double frameTime(u64 n) const;
+		[[nodiscard]] double latency(u64 n) const;
+
+		void writeCsvLine(u64 n);
+
+		u32 m_picture_lag { 0 };
+		Frame m_current {};
+
+		// Ring of the last frames, frame `n` at `n % size`.
+		std::vector<Frame> m_frames;
+		u64 m_count { 0 };
+
+		std::ofstream m_csv {};
+		Clock::time_point m_start {};
+	};
+} // namespace frontend
+
+#endif // _FRONTEND_FRAMESTATS_HPP_
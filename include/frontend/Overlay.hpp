@@ -0,0 +1,32 @@
+#ifndef _FRONTEND_OVERLAY_HPP_
+#define _FRONTEND_OVERLAY_HPP_
+
+#include "common/types.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include <string>
+#include <vector>
+
+namespace frontend {
+	// A few lines of text in the top left corner over a dark backdrop, e.g. frame
+	// statistics. The 3x5 font is built in so no font file is needed; it covers
+	// digits, upper case letters and `.:-/%`, anything else is drawn blank.
+	class Overlay {
+	public:
+		// Text pixels are `scale` screen pixels wide.
+		explicit Overlay(u32 scale);
+
+		void setText(const std::vector<std::string>& lines);
+		void draw(sf::RenderTarget& target) const;
+
+	private:
+		const u32 m_scale;
+
+		std::vector<u32> m_pixels {};
+		sf::Texture m_texture {};
+		sf::Sprite m_sprite {};
+	};
+} // namespace frontend
+
+#endif // _FRONTEND_OVERLAY_HPP_
@@ -0,0 +1,52 @@
+#ifndef _FRONTEND_SCREEN_HPP_
+#define _FRONTEND_SCREEN_HPP_
+
+#include "common/types.hpp"
+#include "nes/Bus.hpp"
+#include "video/Ntsc.hpp"
+#include "video/Palette.hpp"
+#include "video/Scaler.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace frontend {
+	// The emulated picture as an SFML texture. Frames are converted and scaled
+	// into a buffer kept for the lifetime of the screen, which is handed to the
+	// texture as is.
+	//
+	// With the NTSC filter on (`ntsc_threads` > 0), frames go through it instead:
+	// the texture is `video::ntscWidth` pixels wide and stretched to `factor` / 2
+	// horizontally, `factor` vertically.
+	class Screen {
+	public:
+		Screen(video::Scaler scaler, u32 factor, u32 ntsc_threads);
+
+		// Upload the last frame drawn by `bus`.
+		void update(const nes::Bus& bus);
+		void draw(sf::RenderTarget& target) const;
+
+		[[nodiscard]] inline u32 getWidth() const { return m_width; }
+		[[nodiscard]] inline u32 getHeight() const { return m_height; }
+
+	private:
+		const video::Palette m_palette { video::Palette::standard() };
+		const video::Scaler m_scaler;
+		const u32 m_factor;
+		const u32 m_width;
+		const u32 m_height;
+
+		std::unique_ptr<video::NtscFilter> m_ntsc {};
+
+		// Palette conversion output, only needed when the picture is scaled.
+		std::vector<video::Rgba> m_rgba {};
+		std::vector<video::Rgba> m_pixels {};
+
+		sf::Texture m_texture {};
+		sf::Sprite m_sprite {};
+	};
+} // namespace frontend
+
+#endif // _FRONTEND_SCREEN_HPP_
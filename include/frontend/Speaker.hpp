@@ -0,0 +1,29 @@
+#ifndef _FRONTEND_SPEAKER_HPP_
+#define _FRONTEND_SPEAKER_HPP_
+
+#include "audio/Ring.hpp"
+#include "common/types.hpp"
+
+#include <SFML/Audio.hpp>
+
+#include <array>
+
+namespace frontend {
+	// Plays the samples queued in a ring, silence when it runs dry.
+	class Speaker : public sf::SoundStream {
+	public:
+		Speaker(audio::Ring& ring, u32 rate);
+		// The stream thread must be stopped before this part of the object goes.
+		~Speaker() override;
+
+	private:
+		bool onGetData(Chunk& chunk) override;
+		void onSeek(sf::Time) override {}
+
+		audio::Ring& m_ring;
+		// About 10 ms at 48 kHz.
+		std::array<sf::Int16, 512> m_chunk {};
+	};
+} // namespace frontend
+
+#endif // _FRONTEND_SPEAKER_HPP_
@@ -0,0 +1,36 @@
+#ifndef _FRONTEND_WINDOW_HPP_
+#define _FRONTEND_WINDOW_HPP_
+
+#include "common/types.hpp"
+#include "nes/Bus.hpp"
+#include "video/Scaler.hpp"
+
+#include <string_view>
+
+namespace frontend {
+	// What sets the pace of frames.
+	enum class Sync {
+		CLOCK,   // The host clock at 60.0988 Hz, audio resampled to follow
+		DISPLAY, // Vertical sync, at whatever the display refresh is
+		AUDIO,   // The host clock, sped up or slowed down to the audio device
+	};
+
+	struct WindowOptions {
+		video::Scaler scaler { video::Scaler::INTEGER };
+		u32 factor { 2 };
+		u32 ntsc_threads { 0 }; // NTSC filter threads, 0 for no filter
+		Sync sync { Sync::CLOCK };
+		// Frames run ahead of the input to hide the game's own lag, see
+		// `nes::RunAhead`.
+		u8 run_ahead { 0 };
+		// Frame time and latency on screen, F3 toggles it.
+		bool overlay { false };
+		// Per-frame timings, a CSV line written as each frame is presented.
+		std::string_view stats_path {};
+	};
+
+	// Play on `bus` in a window until it is closed, keyboard on controller 1.
+	void runWindow(nes::Bus& bus, const WindowOptions& options);
+} // namespace frontend
+
+#endif // _FRONTEND_WINDOW_HPP_
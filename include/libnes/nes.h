@@ -0,0 +1,115 @@
+/*
+ * libnes: the emulation core behind a C API, for embedding without the SFML
+ * front end.
+ *
+ * Pointers returned by the accessors point into the console itself: no copy is
+ * made, they stay valid until `nes_destroy` and their content changes with
+ * every `nes_run_frame`. A console is not thread safe, but separate consoles can
+ * run on separate threads.
+ */
+
+#ifndef _LIBNES_NES_H_
+#define _LIBNES_NES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(NES_SHARED)
+	#ifdef NES_BUILDING_LIBRARY
+		#define NES_API __declspec(dllexport)
+	#else
+		#define NES_API __declspec(dllimport)
+	#endif
+#elif defined(__GNUC__)
+	#define NES_API __attribute__((visibility("default")))
+#else
+	#define NES_API
+#endif
+
+/* Bumped on any incompatible change of this header. */
+#define NES_API_VERSION 1
+
+#define NES_SCREEN_WIDTH 256
+#define NES_SCREEN_HEIGHT 240
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct nes_console nes_console;
+
+typedef enum nes_accuracy {
+	NES_ACCURACY_FAST = 0,
+	NES_ACCURACY_CYCLE = 1,
+} nes_accuracy;
+
+/* Standard controller buttons, combine them for `nes_set_controller`. */
+typedef enum nes_button {
+	NES_BUTTON_A = 1 << 0,
+	NES_BUTTON_B = 1 << 1,
+	NES_BUTTON_SELECT = 1 << 2,
+	NES_BUTTON_START = 1 << 3,
+	NES_BUTTON_UP = 1 << 4,
+	NES_BUTTON_DOWN = 1 << 5,
+	NES_BUTTON_LEFT = 1 << 6,
+	NES_BUTTON_RIGHT = 1 << 7,
+} nes_button;
+
+/* NES_API_VERSION of the library actually loaded. */
+NES_API uint32_t nes_api_version(void);
+
+/* NULL when out of memory. */
+NES_API nes_console *nes_create(nes_accuracy accuracy);
+NES_API void nes_destroy(nes_console *console);
+
+/* Insert an iNES image (copied) and power on. 0 on success, -1 otherwise, see
+ * `nes_last_error`. */
+NES_API int nes_load_rom(nes_console *console, const uint8_t *data, size_t size);
+
+/* Press the reset button, nothing without a ROM. 0 on success, -1 otherwise. */
+NES_API int nes_reset(nes_console *console);
+
+/* Back the cartridge's PRG RAM ($6000-$7fff) with the save file at `path`,
+ * created when missing. Call after `nes_load_rom`. Modified pages are synced to
+ * the disk at most every `sync_frames` frames (0 for the default) and by
+ * `nes_destroy`. 0 on success, -1 otherwise. */
+NES_API int
+nes_map_save_ram(nes_console *console, const char *path, uint32_t sync_frames);
+
+/* Run up to the next frame boundary. With `draw` at 0 the picture is not
+ * rendered, the emulation is unchanged. 0 on success, -1 otherwise. */
+NES_API int nes_run_frame(nes_console *console, int draw);
+
+/* Buttons held on controller `port` (0 or 1). */
+NES_API void nes_set_controller(nes_console *console, unsigned port, uint8_t buttons);
+
+/* NES_SCREEN_WIDTH x NES_SCREEN_HEIGHT palette indices (0-63) of the last drawn
+ * frame, and the color emphasis (PPUMASK bits 5-7) of each of its lines. */
+NES_API const uint8_t *nes_framebuffer(const nes_console *console);
+NES_API const uint8_t *nes_emphasis(const nes_console *console);
+
+/* Mono samples of the last frame, `count` of them. The APU is not emulated yet,
+ * so this is always empty. */
+NES_API const int16_t *nes_audio(const nes_console *console, size_t *count);
+
+/* The 2 KB of CPU work RAM, writable. */
+NES_API uint8_t *nes_ram(nes_console *console, size_t *size);
+
+NES_API uint64_t nes_frame(const nes_console *console);
+/* Fingerprint of the whole console state, see the hash logs. 0 before a ROM is
+ * loaded. */
+NES_API uint64_t nes_hash_state(const nes_console *console);
+
+/* Resident memory of this console alone, in bytes. `shared`, when not NULL,
+ * receives the size of the ROM image it shares with every console running the
+ * same ROM: N consoles of one game take N * private + shared bytes. */
+NES_API size_t nes_memory_usage(const nes_console *console, size_t *shared);
+
+/* Why the last call failed, empty if it did not. */
+NES_API const char *nes_last_error(const nes_console *console);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _LIBNES_NES_H_ */
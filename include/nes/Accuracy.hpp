@@ -0,0 +1,35 @@
+#ifndef _NES_ACCURACY_HPP_
+#define _NES_ACCURACY_HPP_
+
+#include "common/types.hpp"
+
+namespace nes {
+	// Emulation accuracy, chosen per console instance when it is created.
+	enum class Accuracy : u8 {
+		FAST,  // Instruction granular: only the bus accesses an instruction needs.
+		CYCLE, // Dummy reads and open bus, like the real bus.
+	};
+
+	// Compile-time policies behind each `Accuracy` level. The CPU instantiates its
+	// run loop and the bus accesses it makes once per policy, so the fast level
+	// does not pay for the checks.
+	namespace accuracy {
+		struct Fast {
+			static constexpr Accuracy level { Accuracy::FAST };
+			static constexpr bool dummy_reads { false };
+			static constexpr bool open_bus { false };
+		};
+
+		struct Cycle {
+			static constexpr Accuracy level { Accuracy::CYCLE };
+			static constexpr bool dummy_reads { true };
+			static constexpr bool open_bus { true };
+		};
+	} // namespace accuracy
+
+	[[nodiscard]] constexpr const char *accuracyName(Accuracy accuracy) {
+		return accuracy == Accuracy::CYCLE ? "cycle" : "fast";
+	}
+} // namespace nes
+
+#endif // _NES_ACCURACY_HPP_
@@ -3,18 +3,47 @@
 
 #include "common/types.hpp"
 #include "nes/CPU.hpp"
+#include "nes/FrameRenderer.hpp"
 #include "nes/Mapper.hpp"
+#include "nes/PPU.hpp"
+#include "nes/State.hpp"
 
 #include <array>
 #include <memory>
-#include <vector>
+#include <string_view>
 
-#define NES_RAM_SIZE 2048
+// Master (PPU) clocks in one NTSC frame: 341 dots * 262 scanlines.
+#define NES_FRAME_DOTS 89342
+
+// Master clocks per CPU cycle.
+#define NES_CPU_DIVIDER 3
+
+// CPU cycles per second (NTSC: 236.25 MHz / 11 / 12).
+#define NES_CPU_HZ 1789772.7272727
+
+// CPU cycles between two APU frame counter IRQs in 4-step mode.
+#define NES_APU_FRAME_CYCLES 29830
 
 namespace nes {
+	// Standard controller buttons, in the order they are shifted out of $4016/7.
+	enum Button : u8 {
+		BUTTON_A = 1 << 0,
+		BUTTON_B = 1 << 1,
+		BUTTON_SELECT = 1 << 2,
+		BUTTON_START = 1 << 3,
+		BUTTON_UP = 1 << 4,
+		BUTTON_DOWN = 1 << 5,
+		BUTTON_LEFT = 1 << 6,
+		BUTTON_RIGHT = 1 << 7,
+	};
+
 	class Bus {
 	public:
-		Bus() = default;
+		// The 2A03 ignores the D flag, see `BasicCPU`.
+		static constexpr bool decimal_mode { false };
+
+		// The accuracy level is fixed for the lifetime of the console.
+		explicit Bus(Accuracy accuracy = Accuracy::FAST);
 		Bus(const Bus&) = delete;
 		Bus& operator=(const Bus&) = delete;
 
@@ -22,25 +51,165 @@ namespace nes {
 
 		void power();
 		void reset();
-		[[maybe_unused]] u32 clock();
 
-		[[nodiscard]] u8 cpuRead(u16 addr, bool ro) const;
-		[[nodiscard]] u16 cpuRead16(u16 addr, bool ro) const;
+		// Advance by one master clock, for single stepping.
+		[[maybe_unused]] u64 clock();
+
+		// Run the CPU freely until `until` (in master clocks), stopping only at
+		// scheduled events. Stops on an instruction boundary, so it may overshoot by
+		// a few clocks; the overshoot is carried into the next call, and so are the
+		// events due from `until` on. The CPU sees no difference: they still fire
+		// before its next instruction. But line 0 of the next frame is only drawn
+		// by the next `runFrame`, with that frame's draw flag.
+		void run(u64 until);
+
+		// Run the console until the next frame boundary. Without `draw` the PPU
+		// skips pixel output, all timing (sprite 0 hit, overflow, vblank) is kept.
+		void runFrame(bool draw = true);
+
+		// Fingerprint of all mutable console state, taken at a frame boundary.
+		[[nodiscard]] u64 hashState() const;
+
+		// Fingerprint of what a running program changes: RAM, PRG RAM and the CPU
+		// and PPU registers. Clocks, counters and event times are left out, so it
+		// stays the same from frame to frame while the program is stuck.
+		[[nodiscard]] u64 hashProgress() const;
+
+		// Copy the whole state block out or back in, see `State`. A snapshot only
+		// fits the console running the same cartridge.
+		void saveState(State& snapshot) const;
+		void loadState(const State& snapshot);
+
+		// Back the cartridge's PRG RAM with the save file at `path`, see `SaveRam`.
+		// Modified pages are synced at most every `sync_frames` frames, and when
+		// the console is destroyed.
+		[[nodiscard]] bool
+		mapSaveRam(std::string_view path, u32 sync_frames = SAVE_RAM_SYNC_FRAMES);
+
+		// Sync the save file now, waiting for the disk.
+		void syncSaveRam();
+
+		// Frames run while speculating are rolled back afterwards (see `RunAhead`),
+		// they never sync the save file.
+		inline void setSpeculative(bool speculative) { m_speculative = speculative; }
+
+		[[nodiscard]] bool hasBattery() const;
+
+		// Resident memory of this console alone, and of the cartridge image it
+		// shares with every console running the same ROM.
+		[[nodiscard]] std::size_t privateBytes() const;
+		[[nodiscard]] std::size_t sharedBytes() const;
+
+		// Set the buttons held on controller `port` (0 or 1), see `Button`.
+		void setController(u8 port, u8 buttons);
+
+		// `ro` reads are side-effect free, e.g. for debuggers. The CPU accesses the
+		// bus through the versions built for its accuracy policy (see
+		// `accuracy::Fast`), everything else at the console's accuracy.
+		template<typename Policy>
+		[[nodiscard]] u8 cpuRead(u16 addr, bool ro);
+		template<typename Policy>
+		[[nodiscard]] u16 cpuRead16(u16 addr, bool ro);
+		template<typename Policy>
 		void cpuWrite(u16 addr, u8 data);
 
-		[[nodiscard]] u8 ppuRead(u16 addr) const;
+		[[nodiscard]] u8 cpuRead(u16 addr, bool ro);
+		void cpuWrite(u16 addr, u8 data);
+
+		// PPU address space below the palette ($0000-$3eff), through the
+		// cartridge's windows (see `Mapper::PpuWindows`).
+		[[nodiscard]] inline u8 ppuRead(u16 addr) const {
+			return m_mapper->readPpu(addr);
+		}
+		void ppuWrite(u16 addr, u8 data);
+
+		[[nodiscard]] inline const Mapper::PpuWindows& getPpuWindows() const {
+			return m_mapper->ppuWindows();
+		}
+
+		[[nodiscard]] inline Accuracy getAccuracy() const { return m_accuracy; }
 
 		[[nodiscard]] inline CPU& getCPU() { return m_cpu; }
+		[[nodiscard]] inline PPU& getPPU() { return m_ppu; }
+
+		// Draw frames on `threads` worker threads, one frame late, see
+		// `FrameRenderer`. 0 draws inline again.
+		void setRenderThreads(u32 threads);
+
+		// Wait for the deferred renderer to draw the last frame run, so the
+		// framebuffer shows it now rather than after the next frame. Nothing to do
+		// when drawing inline.
+		void finishDrawing();
+
+		// The deferred renderer, nullptr when drawing inline.
+		[[nodiscard]] inline const FrameRenderer *getRenderer() const {
+			return m_renderer.get();
+		}
+
+		[[nodiscard]] inline const PPU::Framebuffer& getFramebuffer() const {
+			return m_renderer ? m_renderer->getFramebuffer() : m_ppu.getFramebuffer();
+		}
+
+		[[nodiscard]] inline const PPU::Emphasis& getEmphasis() const {
+			return m_renderer ? m_renderer->getEmphasis() : m_ppu.getEmphasis();
+		}
+
+		[[nodiscard]] inline u64 getFrame() const { return m_state.frame; }
+
+		// CPU work RAM ($0000-$07ff, mirrored up to $1fff).
+		[[nodiscard]] inline std::array<u8, NES_RAM_SIZE>& getRam() {
+			return m_state.ram;
+		}
 
 	private:
+		// Handle every scheduled event that is due, and scheduled before `until`.
+		void dispatchEvents(u64 until = Scheduler::NEVER);
+
+		// Master clock at the CPU instruction running now. `m_state.clock` only
+		// catches up at the end of a CPU batch (see `run`), so the cycles the batch
+		// has run so far are added.
+		[[nodiscard]] inline u64 now() const {
+			if (!m_in_batch) {
+				return m_state.clock;
+			}
+			const u64 ran { m_cpu.getCycleCount() - m_batch_cycles };
+			return m_state.clock + ran * NES_CPU_DIVIDER;
+		}
+
+		// Value of an unmapped read: the last byte on the data bus, when emulated.
+		template<typename Policy>
+		[[nodiscard]] inline u8 openBus() const {
+			if constexpr (Policy::open_bus) {
+				return m_state.open_bus;
+			}
+			return 0x00;
+		}
+
+		void writeApuFrameCounter(u8 data);
+
+		// Copy the CPU page `page` to OAM ($4014) and stall the CPU for it.
+		template<typename Policy>
+		void oamDma(u8 page);
+
+		State m_state {};
+
+		const Accuracy m_accuracy;
+
 		std::unique_ptr<Mapper> m_mapper;
 		CPU m_cpu;
+		PPU m_ppu;
+		std::unique_ptr<FrameRenderer> m_renderer;
+
+		// CPU cycle count when the running batch started, see `now`.
+		u64 m_batch_cycles { 0 };
+		bool m_in_batch { false };
 
-		// Count how many clocks have passed.
-		u32 m_clock { 0 };
+		// Frames between two save file syncs, 0 without a save file.
+		u32 m_save_sync_frames { 0 };
+		bool m_speculative { false };
 
-		// Memory
-		std::array<u8, NES_RAM_SIZE> m_cpu_ram {};
+		// Buttons held on the controllers.
+		std::array<u8, 2> m_controller {};
 	};
 } // namespace nes
 
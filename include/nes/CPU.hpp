@@ -1,8 +1,8 @@
 #ifndef _NES_CPU_HPP_
 #define _NES_CPU_HPP_
 
-#include "common/BitField.hpp"
 #include "common/types.hpp"
+#include "nes/Accuracy.hpp"
 
 #include <array>
 #include <string>
@@ -11,27 +11,126 @@
 namespace nes {
 	class Bus;
 
-	class CPU {
+	// BasicCPU is the 6502 core, wired at compile time to the memory it runs on.
+	// `Memory` provides:
+	//   - `u8 cpuRead<Policy>(u16 addr, bool ro)`, `u16 cpuRead16<Policy>(u16 addr,
+	//     bool ro)` and `void cpuWrite<Policy>(u16 addr, u8 data)`, called directly
+	//     rather than through virtual functions, with the accuracy policy of the
+	//     running loop (see `accuracy::Fast`). `FlatBus` defines them in its header,
+	//     so they inline; `Bus` instantiates them out of line in Bus.cpp, so every
+	//     console access is a plain call;
+	//   - `static constexpr bool decimal_mode`, whether ADC and SBC honour the D
+	//     flag (the 2A03 in the NES has decimal mode cut out).
+	//
+	// Instantiated for the console (`CPU`) and a flat 64 KB RAM (`FlatBus`), the
+	// memory map of the standard 6502 test suites.
+	template<typename Memory>
+	class BasicCPU {
 	public:
-		CPU();
-		CPU(const CPU&) = delete;
-		CPU& operator=(const CPU&) = delete;
+		// CPU status (P register).
+		//
+		// N, Z, C and V are stored as the values the last instruction produced them
+		// from, and only folded into the 6502 layout when P itself is read (PHP, BRK,
+		// interrupts, debugger). Instructions never read-modify-write P.
+		struct Status {
+			enum : u8 {
+				FLAG_C = 1 << 0, // Carry bit.
+				FLAG_Z = 1 << 1, // Zero
+				FLAG_I = 1 << 2, // Disable Interrupts
+				FLAG_D = 1 << 3, // Decimal Mode
+				FLAG_B = 1 << 4, // Break
+				FLAG_U = 1 << 5, // Unused
+				FLAG_V = 1 << 6, // Overflow
+				FLAG_N = 1 << 7, // Negative
+			};
 
-		void connectBus(Bus *bus);
+			u8 flags { 0x24 }; // I, D and U, in their P positions
+			u8 n { 0x00 };     // N is bit 7 of this value
+			u8 z { 0x01 };     // Z is set when this value is 0
+			u8 c { 0x00 };     // C is 0 or 1
+			u8 v { 0x00 };     // V is bit 7 of this value
+
+			[[nodiscard]] inline bool negative() const { return n & 0x80; }
+			[[nodiscard]] inline bool zero() const { return z == 0x00; }
+			[[nodiscard]] inline bool carry() const { return c != 0x00; }
+			[[nodiscard]] inline bool overflow() const { return v & 0x80; }
+			[[nodiscard]] inline bool interrupt() const { return flags & FLAG_I; }
+
+			[[nodiscard]] u8 pack() const;
+			void unpack(u8 p);
+		};
+
+		// Everything mutable in the CPU. It lives in the console's state block (see
+		// `nes::State`), the CPU only works on it.
+		struct State {
+			u16 pc { 0x0000 }; // Program Counter
+			u8 sp { 0xfd };    // Stack Pointer
+
+			u8 a { 0x00 }; // Accumulator Register
+			u8 x { 0x00 }; // X Register
+			u8 y { 0x00 }; // Y Register
+
+			Status p; // CPU status
+
+			u16 cycles { 8 };
+
+			// Interrupt inputs, sampled before each instruction.
+			u8 irq_lines { 0 };
+			bool nmi_pending { false };
+
+			// Cycles run since power up, for DMA alignment.
+			u64 cycle_count { 0 };
+		};
+
+		// Devices that can hold the IRQ line low. The line is wired-OR: the CPU
+		// sees an IRQ while any source asserts it.
+		enum IrqSource : u8 {
+			IRQ_MAPPER = 1 << 0,
+			IRQ_APU_FRAME = 1 << 1,
+			IRQ_APU_DMC = 1 << 2,
+		};
+
+		BasicCPU(State& state, Accuracy accuracy);
+		BasicCPU(const BasicCPU&) = delete;
+		BasicCPU& operator=(const BasicCPU&) = delete;
+
+		void connectBus(Memory *bus);
 
 		void clock();
 		void step();
 		void reset();
 
-		void irq();
-		void nmi();
+		// Run whole instructions until at least `cycles` cycles have elapsed, and
+		// return how many did. Pending interrupts are taken between instructions.
+		u32 run(u32 cycles);
+
+		// Assert or release the IRQ line for `source`, see `IrqSource`.
+		inline void setIrq(u8 source, bool active) {
+			const u8 lines { m_state.irq_lines };
+			m_state.irq_lines = active ? (lines | source) : (lines & ~source);
+		}
+
+		// NMI is edge triggered: the request stays latched until it is taken.
+		inline void requestNmi() { m_state.nmi_pending = true; }
+
+		// Halt for an OAM DMA triggered by the current instruction.
+		void stallForDma();
 
-		inline void setPC(u16 pc) { m_reg.pc = pc; }
+		inline void setPC(u16 pc) { m_state.pc = pc; }
+		[[nodiscard]] inline u16 getPC() const { return m_state.pc; }
 
-		[[nodiscard]] inline u8 getCycles() const { return m_cycles; }
+		[[nodiscard]] inline u16 getCycles() const { return m_state.cycles; }
+
+		// Cycles run since power up, up to the start of the current instruction.
+		[[nodiscard]] inline u64 getCycleCount() const { return m_state.cycle_count; }
+
+		[[nodiscard]] inline Accuracy getAccuracy() const { return m_accuracy; }
 
 		[[nodiscard]] std::string getDebugString() const;
 
+		// Fingerprint of the architectural state (registers and pending cycles).
+		[[nodiscard]] u64 hashState(u64 seed) const;
+
 	private:
 		enum AddressingMode {
 			IMP, // Implied       : No operand
@@ -50,77 +149,116 @@ namespace nes {
 		};
 
 		struct Opcode {
-			std::string name;
+			const char *name;
 			AddressingMode addressing;
-			void (CPU::*operation)(u16) = nullptr;
+			void (BasicCPU::*operation)(u16) = nullptr;
 			u8 cycles { 0 };
 			u8 page_cycles { 0 };
 		};
 
+		// Everything below runs the instruction loop and is instantiated once per
+		// accuracy policy, down to the bus accesses.
+		template<typename Policy>
 		[[nodiscard]] u8 memRead(u16 addr, bool ro = false) const;
+		template<typename Policy>
 		[[nodiscard]] u16 memRead16(u16 addr, bool ro = false) const;
+		// A pointer in page zero: the high byte of $ff is read at $00.
+		template<typename Policy>
+		[[nodiscard]] u16 memReadZp16(u8 ptr) const;
+		template<typename Policy>
 		void memWrite(u16 addr, u8 data);
 
+		template<typename Policy>
 		void stackPush(u8 data);
+		template<typename Policy>
 		void stackPush16(u16 data);
+		template<typename Policy>
 		[[nodiscard]] u8 stackPop();
+		template<typename Policy>
 		[[nodiscard]] u16 stackPop16();
 
+		template<typename Policy>
+		u32 runWith(u32 cycles);
+		template<typename Policy>
+		void stepWith();
+
+		template<typename Policy>
+		void irq();
+		template<typename Policy>
+		void nmi();
+
+		template<typename Policy>
 		[[nodiscard]] std::tuple<u16, bool> getOperandAddress(AddressingMode mode);
 
+		// Instructions, one handler per mnemonic.
 		// clang-format off
-			void ADC(u16 addr); void AND(u16 addr); void ASL(u16 addr); void BCC(u16 addr);
-			void BCS(u16 addr); void BEQ(u16 addr); void BIT(u16 addr); void BMI(u16 addr);
-			void BNE(u16 addr); void BPL(u16 addr); void BRK(u16 addr); void BVC(u16 addr);
-			void BVS(u16 addr); void CLC(u16 addr); void CLD(u16 addr); void CLI(u16 addr);
-			void CLV(u16 addr); void CMP(u16 addr); void CPX(u16 addr); void CPY(u16 addr);
-			void DEC(u16 addr); void DEX(u16 addr); void DEY(u16 addr); void EOR(u16 addr);
-			void INC(u16 addr); void INX(u16 addr); void INY(u16 addr); void JMP(u16 addr);
-			void JSR(u16 addr); void LDA(u16 addr); void LDX(u16 addr); void LDY(u16 addr);
-			void LSR(u16 addr); void NOP(u16 addr); void ORA(u16 addr); void PHA(u16 addr);
-			void PHP(u16 addr); void PLA(u16 addr); void PLP(u16 addr); void ROL(u16 addr);
-			void ROR(u16 addr); void RTI(u16 addr); void RTS(u16 addr); void SBC(u16 addr);
-			void SEC(u16 addr); void SED(u16 addr); void SEI(u16 addr); void STA(u16 addr);
-			void STX(u16 addr); void STY(u16 addr); void TAX(u16 addr); void TAY(u16 addr);
-			void TSX(u16 addr); void TXA(u16 addr); void TXS(u16 addr); void TYA(u16 addr);
-
-			void NIL(u16 addr); // Catch all "illegal" opcodes
+		template<typename Policy> void ADC(u16); template<typename Policy> void AND(u16);
+		template<typename Policy> void ASL(u16); template<typename Policy> void BCC(u16);
+		template<typename Policy> void BCS(u16); template<typename Policy> void BEQ(u16);
+		template<typename Policy> void BIT(u16); template<typename Policy> void BMI(u16);
+		template<typename Policy> void BNE(u16); template<typename Policy> void BPL(u16);
+		template<typename Policy> void BRK(u16); template<typename Policy> void BVC(u16);
+		template<typename Policy> void BVS(u16); template<typename Policy> void CLC(u16);
+		template<typename Policy> void CLD(u16); template<typename Policy> void CLI(u16);
+		template<typename Policy> void CLV(u16); template<typename Policy> void CMP(u16);
+		template<typename Policy> void CPX(u16); template<typename Policy> void CPY(u16);
+		template<typename Policy> void DEC(u16); template<typename Policy> void DEX(u16);
+		template<typename Policy> void DEY(u16); template<typename Policy> void EOR(u16);
+		template<typename Policy> void INC(u16); template<typename Policy> void INX(u16);
+		template<typename Policy> void INY(u16); template<typename Policy> void JMP(u16);
+		template<typename Policy> void JSR(u16); template<typename Policy> void LDA(u16);
+		template<typename Policy> void LDX(u16); template<typename Policy> void LDY(u16);
+		template<typename Policy> void LSR(u16); template<typename Policy> void NOP(u16);
+		template<typename Policy> void ORA(u16); template<typename Policy> void PHA(u16);
+		template<typename Policy> void PHP(u16); template<typename Policy> void PLA(u16);
+		template<typename Policy> void PLP(u16); template<typename Policy> void ROL(u16);
+		template<typename Policy> void ROR(u16); template<typename Policy> void RTI(u16);
+		template<typename Policy> void RTS(u16); template<typename Policy> void SBC(u16);
+		template<typename Policy> void SEC(u16); template<typename Policy> void SED(u16);
+		template<typename Policy> void SEI(u16); template<typename Policy> void STA(u16);
+		template<typename Policy> void STX(u16); template<typename Policy> void STY(u16);
+		template<typename Policy> void TAX(u16); template<typename Policy> void TAY(u16);
+		template<typename Policy> void TSX(u16); template<typename Policy> void TXA(u16);
+		template<typename Policy> void TXS(u16); template<typename Policy> void TYA(u16);
 
+		// Catch all "illegal" opcodes
+		template<typename Policy> void NIL(u16);
 		// clang-format on
 
-		// Registers
-		struct {
-			u16 pc { 0x0000 }; // Program Counter
-			u8 sp { 0xfd };    // Stack Pointer
+		// ADC and SBC in decimal mode, as the NMOS 6502 does them, flags included:
+		// N, V and Z do not describe the BCD result.
+		void addDecimal(u8 m);
+		void subtractDecimal(u8 m);
 
-			u8 a { 0x00 }; // Accumulator Register
-			u8 x { 0x00 }; // X Register
-			u8 y { 0x00 }; // Y Register
+		// Set N and Z from the same result, the common case.
+		inline void setNZ(u8 result) {
+			m_state.p.n = result;
+			m_state.p.z = result;
+		}
 
-			union { // CPU status
-				u8 raw;
-				BitField<7> n; // Negative
-				BitField<6> v; // Overflow
-				BitField<5> u; // Unused
-				BitField<4> b; // Break
-				BitField<3> d; // Decimal Mode
-				BitField<2> i; // Disable Interrupts
-				BitField<1> z; // Zero
-				BitField<0> c; // Carry bit.
-			} p;
-		} m_reg;
+		// Registers, in the console's state block.
+		State& m_state;
 
-		u8 m_cycles { 8 };
+		const Accuracy m_accuracy;
 
-		Bus *m_bus { nullptr };
+		Memory *m_bus { nullptr };
+
+#ifdef NES_FUZZING
+		// Address of the previous instruction, for guest coverage edges.
+		u16 m_prev_pc {};
+#endif
 
 		// Convenience variables.
 		u8 m_opcode {};
 		Opcode m_instruction {};
 
-		// Lookup table with all opcodes.
-		std::array<Opcode, 256> m_optable;
+		// Lookup table with all opcodes, pointing at the handlers for `Policy`.
+		template<typename Policy>
+		static const std::array<Opcode, 256> optable;
 	};
+
+	// The NES CPU, a 2A03, on the console bus.
+	using CPU = BasicCPU<Bus>;
 } // namespace nes
 
 #endif // _NES_CPU_HPP_
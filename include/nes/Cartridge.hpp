@@ -3,6 +3,8 @@
 
 #include "common/types.hpp"
 
+#include <cstddef>
+#include <memory>
 #include <optional>
 #include <string_view>
 #include <vector>
@@ -10,9 +12,20 @@
 namespace nes {
 	// Cartridge represents a NES cartridge.
 	// It carried banks of ROM memory: PRG ROM for code and CHR ROM for visual graphics.
+	struct Cartridge;
+
+	// Cartridges are immutable once inserted, consoles running the same ROM share
+	// one image of it, see `Cartridge::share`.
+	using CartridgeImage = std::shared_ptr<const Cartridge>;
+
 	struct Cartridge {
 	public:
 		static std::optional<Cartridge> loadFile(std::string_view path);
+		static std::optional<Cartridge> loadMemory(const u8 *data, std::size_t size);
+
+		// The image of `cartridge`: the one already in use when a console runs the
+		// same ROM, a new one otherwise. Thread safe.
+		static CartridgeImage share(Cartridge cartridge);
 
 		enum Mirroring {
 			HORIZONTAL,
@@ -29,6 +42,9 @@ namespace nes {
 
 		std::vector<u8> prg_data;
 		std::vector<u8> chr_data;
+
+		// PRG RAM is battery-backed, the game saves to it.
+		bool battery { false };
 	};
 
 } // namespace nes
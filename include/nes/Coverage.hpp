@@ -0,0 +1,22 @@
+#ifndef _NES_COVERAGE_HPP_
+#define _NES_COVERAGE_HPP_
+
+#include "common/types.hpp"
+
+// Guest code coverage, only compiled in fuzzing builds (NES_FUZZING).
+//
+// Every executed instruction bumps the counter of the edge (previous PC ->
+// current PC). The map lives in libFuzzer's extra counters section, so libFuzzer
+// picks it up as coverage feedback without any registration.
+#define NES_COVERAGE_MAP_SIZE 65536
+
+namespace nes::coverage {
+	extern u8 edge_map[NES_COVERAGE_MAP_SIZE];
+
+	inline void edge(u16 from, u16 to) {
+		// Shift the source, so A -> B and B -> A end up in different slots.
+		edge_map[static_cast<u16>((from >> 1) ^ to)] += 1;
+	}
+} // namespace nes::coverage
+
+#endif // _NES_COVERAGE_HPP_
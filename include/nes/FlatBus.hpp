@@ -0,0 +1,53 @@
+#ifndef _NES_FLATBUS_HPP_
+#define _NES_FLATBUS_HPP_
+
+#include "common/types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#define FLAT_BUS_SIZE 0x10000
+
+namespace nes {
+	// FlatBus is 64 KB of RAM and nothing else: the memory map of the standard
+	// 6502 test suites, and the CPU core measured without any address decoding.
+	class FlatBus {
+	public:
+		// A generic NMOS 6502, with decimal mode.
+		static constexpr bool decimal_mode { true };
+
+		FlatBus() = default;
+		FlatBus(const FlatBus&) = delete;
+		FlatBus& operator=(const FlatBus&) = delete;
+
+		// Copy `size` bytes of `data` at `addr`, wrapping at the end of memory.
+		inline void load(u16 addr, const u8 *data, std::size_t size) {
+			size = std::min<std::size_t>(size, FLAT_BUS_SIZE);
+			for (std::size_t i { 0 }; i < size; ++i) {
+				m_ram[(addr + i) & (FLAT_BUS_SIZE - 1)] = data[i];
+			}
+		}
+
+		// Plain RAM behaves the same at every accuracy level.
+		template<typename Policy>
+		[[nodiscard]] inline u8 cpuRead(u16 addr, bool /*ro*/) const {
+			return m_ram[addr];
+		}
+
+		template<typename Policy>
+		[[nodiscard]] inline u16 cpuRead16(u16 addr, bool /*ro*/) const {
+			return m_ram[addr] | (m_ram[static_cast<u16>(addr + 1)] << 8);
+		}
+
+		template<typename Policy>
+		inline void cpuWrite(u16 addr, u8 data) {
+			m_ram[addr] = data;
+		}
+
+	private:
+		std::array<u8, FLAT_BUS_SIZE> m_ram {};
+	};
+} // namespace nes
+
+#endif // _NES_FLATBUS_HPP_
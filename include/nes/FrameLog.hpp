@@ -0,0 +1,123 @@
+#ifndef _NES_FRAMELOG_HPP_
+#define _NES_FRAMELOG_HPP_
+
+#include "common/types.hpp"
+#include "nes/Mapper.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// The memories a frame is drawn from, copied into one block: nametable RAM,
+// CHR RAM, palette and OAM.
+#define FRAME_LOG_VRAM 0x0000
+#define FRAME_LOG_CHR_RAM 0x0800
+#define FRAME_LOG_PALETTE 0x2800
+#define FRAME_LOG_OAM 0x2820
+#define FRAME_LOG_MEMORY_SIZE 0x2920
+
+// Visible lines of a frame, see PPU_VISIBLE_SCANLINES.
+#define FRAME_LOG_LINES 240
+
+namespace nes {
+	// FrameLog is what the PPU did during the visible part of a frame, enough to
+	// draw the frame later on other threads (see `FrameRenderer`):
+	//   - the memories it draws from, copied when line 0 starts;
+	//   - every later write to them, in order;
+	//   - for each line, the registers and cartridge windows it starts with, and
+	//     how many of the writes came before it.
+	//
+	// Only pixels are deferred: the PPU still works out sprite 0 hit and sprite
+	// overflow inline, as the CPU can see them.
+	class FrameLog {
+	public:
+		struct Line {
+			u16 v;
+			u8 x;
+			u8 ctrl;
+			u8 mask;
+			u32 writes; // Writes to apply before drawing the line
+
+			// Windows into the cartridge image, or nullptr for windows into the
+			// logged memories, at `ram` in the memory block.
+			std::array<const u8 *, 16> rom;
+			std::array<u16, 16> ram;
+		};
+
+		struct Write {
+			u16 offset; // In the memory block
+			u8 data;
+		};
+
+		using Memory = std::array<u8, FRAME_LOG_MEMORY_SIZE>;
+
+		// The memories to log, all living as long as the log is in use.
+		void connect(const u8 *vram, const u8 *chr_ram, const u8 *palette, const u8 *oam);
+
+		// Line `line` starts drawing. Line 0 starts a new frame, any other line
+		// must follow the previous one or the frame is dropped.
+		void recordLine(
+			u16 line, u16 v, u8 x, u8 ctrl, u8 mask, const Mapper::PpuWindows& windows
+		);
+
+		// Log the store of `data` at `target`, if it is in a logged memory and a
+		// frame is being recorded.
+		inline void write(const u8 *target, u8 data) {
+			if (m_next_line == 0 || m_next_line >= FRAME_LOG_LINES) {
+				return;
+			}
+
+			const u16 offset { locate(target) };
+			if (offset != NOWHERE) {
+				m_writes.push_back({ offset, data });
+			}
+		}
+
+		// Drop the frame being recorded, e.g. after a state was loaded.
+		inline void abort() { m_next_line = DROPPED; }
+
+		// Whether a whole frame was recorded.
+		[[nodiscard]] inline bool complete() const {
+			return m_next_line == FRAME_LOG_LINES;
+		}
+
+		[[nodiscard]] inline const Memory& getMemory() const { return m_memory; }
+		[[nodiscard]] inline const Line& getLine(u16 line) const {
+			return m_lines[line];
+		}
+		[[nodiscard]] inline const std::vector<Write>& getWrites() const {
+			return m_writes;
+		}
+
+	private:
+		static constexpr u16 NOWHERE { 0xffff };
+		static constexpr u16 DROPPED { 0xffff };
+
+		// Offset of `target` in the memory block, NOWHERE outside of it.
+		[[nodiscard]] inline u16 locate(const u8 *target) const {
+			const auto address { reinterpret_cast<std::uintptr_t>(target) };
+			for (const auto& region : m_regions) {
+				const std::uintptr_t offset { address - region.base };
+				if (offset < region.size) {
+					return static_cast<u16>(region.offset + offset);
+				}
+			}
+			return NOWHERE;
+		}
+
+		struct Region {
+			std::uintptr_t base;
+			u16 size;
+			u16 offset;
+		};
+
+		std::array<Region, 4> m_regions {};
+
+		u16 m_next_line { DROPPED };
+		Memory m_memory {};
+		std::array<Line, FRAME_LOG_LINES> m_lines {};
+		std::vector<Write> m_writes {};
+	};
+} // namespace nes
+
+#endif // _NES_FRAMELOG_HPP_
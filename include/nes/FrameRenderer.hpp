@@ -0,0 +1,103 @@
+#ifndef _NES_FRAMERENDERER_HPP_
+#define _NES_FRAMERENDERER_HPP_
+
+#include "common/types.hpp"
+#include "nes/FrameLog.hpp"
+#include "nes/PPU.hpp"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nes {
+	// FrameRenderer draws the frames the PPU records (see `FrameLog`) on a pool of
+	// threads, one frame behind the emulation: while the console runs and records
+	// frame N, the workers draw frame N - 1, each one a band of lines.
+	//
+	// The console hands a frame over when vertical blank starts (`endFrame`); the
+	// frame drawn until then becomes the output, so the picture is one frame late.
+	// Frames not recorded whole (skipped, or cut by a state load) are dropped and
+	// the output stays on the last one drawn.
+	class FrameRenderer {
+	public:
+		explicit FrameRenderer(u32 threads);
+		FrameRenderer(const FrameRenderer&) = delete;
+		FrameRenderer& operator=(const FrameRenderer&) = delete;
+		~FrameRenderer();
+
+		// The memories the logs copy from, see `FrameLog::connect`.
+		void connect(const u8 *vram, const u8 *chr_ram, const u8 *palette, const u8 *oam);
+
+		// The log the current frame is recorded into.
+		[[nodiscard]] inline FrameLog& getLog() { return m_logs[m_recording]; }
+
+		// The visible part of the frame is over: wait for the frame being drawn,
+		// then start drawing the recorded one and switch logs.
+		void endFrame();
+
+		// Wait for the frame being drawn, e.g. before the cartridge image its log
+		// points into goes away.
+		void finish();
+
+		[[nodiscard]] inline const PPU::Framebuffer& getFramebuffer() const {
+			return m_framebuffers[m_output];
+		}
+
+		[[nodiscard]] inline const PPU::Emphasis& getEmphasis() const {
+			return m_emphasis[m_output];
+		}
+
+		[[nodiscard]] inline u32 getThreads() const { return m_thread_count; }
+
+		[[nodiscard]] inline u64 getFrames() const { return m_frames; }
+
+		// Wall time from handing frames over to their last band being drawn.
+		[[nodiscard]] inline std::chrono::nanoseconds getDrawTime() const {
+			return m_draw_time;
+		}
+
+		// Time the console waited for the workers in `endFrame`.
+		[[nodiscard]] inline std::chrono::nanoseconds getStallTime() const {
+			return m_stall_time;
+		}
+
+	private:
+		void run(u32 worker);
+
+		// Draw lines [first, last) of `log`, replaying its writes on a copy of
+		// the memories.
+		void drawBand(const FrameLog& log, u16 first, u16 last, u8 target);
+
+		std::array<FrameLog, 2> m_logs {};
+		u8 m_recording { 0 };
+
+		std::array<PPU::Framebuffer, 2> m_framebuffers {};
+		std::array<PPU::Emphasis, 2> m_emphasis {};
+		u8 m_output { 0 };
+
+		// Guards everything below.
+		std::mutex m_mutex {};
+		std::condition_variable m_wake {};
+		std::condition_variable m_done {};
+		u64 m_generation { 0 };
+		u32 m_busy { 0 };
+		bool m_in_flight { false };
+		bool m_stop { false };
+		u8 m_drawn_log { 0 };
+		u8 m_target { 1 };
+
+		u64 m_frames { 0 };
+		std::chrono::steady_clock::time_point m_submitted {};
+		std::chrono::steady_clock::time_point m_drawn {};
+		std::chrono::nanoseconds m_draw_time {};
+		std::chrono::nanoseconds m_stall_time {};
+
+		const u32 m_thread_count;
+		std::vector<std::thread> m_threads {};
+	};
+} // namespace nes
+
+#endif // _NES_FRAMERENDERER_HPP_
@@ -0,0 +1,48 @@
+#ifndef _NES_FRAMESKIP_HPP_
+#define _NES_FRAMESKIP_HPP_
+
+#include "common/types.hpp"
+
+#include <chrono>
+
+// Duration of one NTSC frame: 89342 master clocks at 21.477272 MHz / 4.
+#define NES_FRAME_NS 16639357
+
+namespace nes {
+	// FrameSkip decides which frames get drawn when running faster than real time:
+	// one out of every `interval` frames, the others only keep the emulation going.
+	//
+	// In turbo mode the interval follows the host speed, so emulation keeps up with
+	// a target multiple of real time while drawing as many frames as it can afford.
+	class FrameSkip {
+	public:
+		static constexpr u32 MAX_INTERVAL { 60 };
+
+		explicit FrameSkip(u32 interval = 1);
+
+		void setInterval(u32 interval);
+		[[nodiscard]] inline u32 getInterval() const { return m_interval; }
+
+		// Adapt the interval to run at `multiplier` times real time, 0 to turn the
+		// adaptation off and keep the current interval.
+		inline void setTarget(double multiplier) { m_target = multiplier; }
+
+		// Whether the next frame should be drawn.
+		[[nodiscard]] bool nextFrame();
+
+		// Report how long the host took for the last frame, drawn or not.
+		void frameTime(std::chrono::nanoseconds elapsed);
+
+	private:
+		u32 m_interval;
+		u32 m_counter { 0 };
+
+		double m_target { 0.0 };
+
+		// Host time spent over the current adaptation window.
+		std::chrono::nanoseconds m_window_time {};
+		u32 m_window_frames { 0 };
+	};
+} // namespace nes
+
+#endif // _NES_FRAMESKIP_HPP_
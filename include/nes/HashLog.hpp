@@ -0,0 +1,38 @@
+#ifndef _NES_HASHLOG_HPP_
+#define _NES_HASHLOG_HPP_
+
+#include "common/types.hpp"
+
+#include <fstream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace nes {
+	// HashLog streams one 64-bit state hash per emulated frame to a file.
+	//
+	// File layout: the 8 byte magic "NESHASH1" followed by every hash as a
+	// little-endian u64, frame 0 first. Hashes are buffered and written in blocks
+	// so logging never touches the disk on the frame path.
+	class HashLog {
+	public:
+		HashLog() = default;
+		HashLog(const HashLog&) = delete;
+		HashLog& operator=(const HashLog&) = delete;
+		~HashLog();
+
+		[[nodiscard]] bool open(std::string_view path);
+		void append(u64 hash);
+		void close();
+
+		static std::optional<std::vector<u64>> readFile(std::string_view path);
+
+	private:
+		void flush();
+
+		std::ofstream m_file;
+		std::vector<u8> m_buffer;
+	};
+} // namespace nes
+
+#endif // _NES_HASHLOG_HPP_
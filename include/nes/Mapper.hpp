@@ -2,29 +2,208 @@
 #define _NES_MAPPER_HPP_
 
 #include "nes/Cartridge.hpp"
+#include "nes/SaveRam.hpp"
 
+#include <array>
 #include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+
+// Battery or work RAM at $6000-$7fff, every board gets it.
+#define MAPPER_PRG_RAM_SIZE 0x2000
+
+// CHR RAM of boards without CHR ROM.
+#define MAPPER_CHR_RAM_SIZE 0x2000
+
+// Room for the registers of the largest board.
+#define MAPPER_REGISTERS_SIZE 32
+
+// The PPU address space is mapped in windows of this size.
+#define MAPPER_PPU_WINDOW_SIZE 0x0400
 
 namespace nes {
+	// Mapper is the cartridge board: it decides which part of the PRG and CHR data
+	// the CPU and PPU see.
+	//
+	// Banking is done through windows: the CPU side $8000-$ffff is four 8 KB
+	// windows, the PPU side $0000-$3fff sixteen 1 KB windows, each pointing into
+	// the cartridge data or the console's nametable RAM. A bank switch or a
+	// mirroring change only re-points windows, nothing is copied, and the buses
+	// read banked memory with `readPrg`/`readPpu` without any virtual call.
+	//
+	// On the PPU side the board decides for the nametables too, as the hardware
+	// does: the console's 2 KB of nametable RAM is wired through the cartridge,
+	// see `connectNametables`.
+	//
+	// The cartridge image is shared with every console running the same ROM.
+	// What the board can modify (its registers, PRG RAM and CHR RAM) lives in the
+	// console's state block instead, see `State`; the windows are derived from it.
+	//
+	// PRG RAM is not gated by the boards' enable bits: test ROMs report through
+	// it even on NROM, and games never rely on it being absent. On cartridges
+	// with a battery it can be backed by a save file, see `mapSaveRam`.
 	class Mapper {
 	public:
-		static std::unique_ptr<Mapper> create(Cartridge cartridge);
+		// Everything the board can modify, kept in the console's state block (see
+		// `nes::State`). Each board lays out its own registers, see
+		// `emplaceRegisters`.
+		struct State {
+			alignas(8) std::array<u8, MAPPER_REGISTERS_SIZE> registers;
+			std::array<u8, MAPPER_PRG_RAM_SIZE> prg_ram;
+			std::array<u8, MAPPER_CHR_RAM_SIZE> chr_ram;
+		};
+
+		// The board for `cartridge`, working on `state`, which it clears.
+		static std::unique_ptr<Mapper> create(Cartridge cartridge, State& state);
 
-		explicit Mapper(Cartridge cartridge);
-		virtual ~Mapper() = default;
+		// The PPU windows: $0000-$1fff the pattern tables, $2000-$2fff the four
+		// nametables, mirrored at $3000-$3fff (the palette is inside the PPU).
+		using PpuWindows = std::array<const u8 *, 16>;
 
-		virtual u8 cpuRead(u16 addr) = 0;
+		Mapper(CartridgeImage cartridge, State& state);
+		// Writes the last PRG RAM changes to the save file, if any.
+		virtual ~Mapper();
+
+		// Cartridge space below $8000 ($4020-$7fff), and PRG ROM for callers
+		// without a fast path.
+		virtual u8 cpuRead(u16 addr);
 		virtual void cpuWrite(u16 addr, u8 data) = 0;
 
-		virtual u8 ppuRead(u16 addr) = 0;
-		virtual void ppuWrite(u16 addr, u8 data) = 0;
+		// PPU space for callers without a fast path. Only CHR RAM and the
+		// nametables are writable.
+		virtual u8 ppuRead(u16 addr);
+		virtual void ppuWrite(u16 addr, u8 data);
+
+		// Map the nametables to `vram` (NES_VRAM_SIZE bytes), following the
+		// mirroring. Must be called before the PPU reads $2000-$3eff.
+		void connectNametables(u8 *vram);
+
+		// Called once per rendered scanline, for boards that count them. The
+		// console only schedules scanline events when `countsScanlines` is true.
+		virtual void scanline() {}
+		[[nodiscard]] virtual bool countsScanlines() const { return false; }
+
+		[[nodiscard]] virtual bool irqPending() const { return false; }
+
+		// Fingerprint of everything the cartridge can modify (CHR RAM, PRG RAM,
+		// registers).
+		[[nodiscard]] virtual u64 hashState(u64 seed) const;
+
+		// The state block is about to be overwritten by `snapshot`: the PRG RAM
+		// pages it changes no longer match the save file.
+		void markPrgRamChanges(const State& snapshot);
+
+		// The state block was overwritten by a snapshot: re-point the windows from
+		// the restored registers.
+		void loadState();
+
+		// Fast paths: read banked memory directly through the windows.
+		[[nodiscard]] inline u8 readPrg(u16 addr) const {
+			return m_prg_windows[(addr >> 13) & 0x03][addr & 0x1fff];
+		}
+
+		[[nodiscard]] inline u8 readPpu(u16 addr) const {
+			return readPpu(m_ppu_windows, addr);
+		}
+
+		[[nodiscard]] static inline u8 readPpu(const PpuWindows& windows, u16 addr) {
+			return windows[(addr >> 10) & 0x0f][addr & 0x03ff];
+		}
+
+		// Nametable byte at `addr` ($2000-$3eff).
+		inline void writeNametable(u16 addr, u8 data) {
+			m_nametables[(addr >> 10) & 0x03][addr & 0x03ff] = data;
+		}
+
+		// PRG RAM at `addr` ($6000-$7fff).
+		[[nodiscard]] inline u8 readPrgRam(u16 addr) const {
+			return m_state.prg_ram[addr & (MAPPER_PRG_RAM_SIZE - 1)];
+		}
+
+		inline void writePrgRam(u16 addr, u8 data) {
+			const u16 offset = addr & (MAPPER_PRG_RAM_SIZE - 1);
+			m_state.prg_ram[offset] = data;
+			m_prg_ram_dirty |= 1U << (offset / SAVE_RAM_PAGE_SIZE);
+		}
+
+		// Back PRG RAM with the save file at `path`, loading the file's content.
+		[[nodiscard]] bool mapSaveRam(std::string_view path);
+
+		// Copy the PRG RAM pages modified since the last sync to the save file.
+		// `wait` blocks until they are on the disk.
+		void syncSaveRam(bool wait);
+
+		[[nodiscard]] bool hasBattery() const;
+
+		// Memory owned by this board alone, and memory of the shared image.
+		[[nodiscard]] std::size_t privateBytes() const;
+		[[nodiscard]] std::size_t sharedBytes() const;
+
+		// The 8 KB PRG window mapped at `addr` ($8000-$ffff).
+		[[nodiscard]] inline const u8 *prgWindow(u16 addr) const {
+			return m_prg_windows[(addr >> 13) & 0x03];
+		}
+
+		// The whole PPU side, for renderers that fetch many bytes in a row.
+		[[nodiscard]] inline const PpuWindows& ppuWindows() const {
+			return m_ppu_windows;
+		}
+
+		[[nodiscard]] Cartridge::Mirroring mirroringType() const;
 
 	protected:
+		// Point the windows and mirroring at what the registers select.
+		virtual void updateBanks() {}
+
+		// Construct the board's registers in the state block, so that snapshots
+		// carry them.
+		template <typename T>
+		[[nodiscard]] T& emplaceRegisters() {
+			static_assert(sizeof(T) <= MAPPER_REGISTERS_SIZE);
+			static_assert(alignof(T) <= 8 && std::is_trivially_copyable_v<T>);
+			return *new (m_state.registers.data()) T {};
+		}
+
 		[[nodiscard]] u8 prgBanks() const;
 		[[nodiscard]] u8 chrBanks() const;
-		[[nodiscard]] Cartridge::Mirroring mirroringType() const;
 
-		Cartridge m_cartridge;
+		// Point PRG windows at `bank`, counted in units of the window size. Bank
+		// numbers wrap around the PRG size, like the unconnected address lines.
+		void mapPrg8k(u8 slot, u32 bank);
+		void mapPrg16k(u8 slot, u32 bank);
+		void mapPrg32k(u32 bank);
+
+		// Point the nametable windows at the console's nametable RAM.
+		void setMirroring(Cartridge::Mirroring mirroring);
+
+		// Point CHR windows at `bank`, counted in units of the window size.
+		void mapChr1k(u8 slot, u32 bank);
+		void mapChr2k(u8 slot, u32 bank);
+		void mapChr4k(u8 slot, u32 bank);
+		void mapChr8k(u32 bank);
+
+		CartridgeImage m_cartridge;
+
+	private:
+		// CHR memory the windows point into: CHR ROM in the image, or CHR RAM.
+		[[nodiscard]] const u8 *chrData() const;
+
+		// Re-point the nametable windows, after a mirroring change.
+		void mapNametables();
+
+		// Registers and RAM, in the console's state block.
+		State& m_state;
+
+		std::array<const u8 *, 4> m_prg_windows {};
+		PpuWindows m_ppu_windows {};
+		Cartridge::Mirroring m_mirroring;
+		// Console nametable RAM, and the 1 KB of it each nametable shows.
+		u8 *m_vram { nullptr };
+		std::array<u8 *, 4> m_nametables {};
+		// One bit per SAVE_RAM_PAGE_SIZE page written since the last sync.
+		u32 m_prg_ram_dirty { 0 };
+		SaveRam m_save_ram {};
 	};
 } // namespace nes
 
@@ -0,0 +1,45 @@
+#ifndef _NES_MOVIE_HPP_
+#define _NES_MOVIE_HPP_
+
+#include "common/types.hpp"
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace nes {
+	class Bus;
+
+	// Controller input recorded per frame, read from FCEUX text movies (.fm2).
+	//
+	// Only what drives the console is kept: the reset commands and the two
+	// standard controllers. Header lines (rom name, checksums, ...) are ignored.
+	class Movie {
+	public:
+		enum Command : u8 {
+			COMMAND_SOFT_RESET = 1 << 0,
+			COMMAND_HARD_RESET = 1 << 1,
+		};
+
+		struct Frame {
+			u8 commands;
+			std::array<u8, 2> buttons;
+		};
+
+		static std::optional<Movie> loadFile(std::string_view path);
+		static std::optional<Movie> parse(std::string_view text);
+
+		// Feed the input of `frame` to `bus`, before running that frame. Past the
+		// end of the movie, all buttons are released.
+		void apply(Bus& bus, u64 frame) const;
+
+		[[nodiscard]] inline std::size_t size() const { return m_frames.size(); }
+
+	private:
+		std::vector<Frame> m_frames {};
+	};
+} // namespace nes
+
+#endif // _NES_MOVIE_HPP_
@@ -0,0 +1,217 @@
+#ifndef _NES_PPU_HPP_
+#define _NES_PPU_HPP_
+
+#include "common/Simd.hpp"
+#include "common/types.hpp"
+#include "nes/FrameLog.hpp"
+#include "nes/Mapper.hpp"
+
+#include <array>
+
+// PPU timing, in master clocks (PPU dots).
+#define PPU_DOTS_PER_SCANLINE 341
+#define PPU_SCANLINES 262
+#define PPU_VISIBLE_SCANLINES 240
+#define PPU_VBLANK_SCANLINE 241
+#define PPU_PRERENDER_SCANLINE 261
+
+// Dot of the horizontal scroll reload, at the end of the visible part of a line.
+#define PPU_HBLANK_DOT 257
+
+#define PPU_SCREEN_WIDTH 256
+#define PPU_SCREEN_HEIGHT 240
+
+namespace nes {
+	class Bus;
+
+	// PPU register file, timing state and a scanline renderer.
+	//
+	// The PPU is never ticked, the console scheduler drives it: `renderLine` at the
+	// start of each visible scanline, `endLine` at its horizontal blank, and
+	// `startVblank`/`endVblank`. Rendering a line also reports when sprite 0 hit
+	// and sprite overflow happen on it, so the flags can be raised on the exact dot
+	// even when pixels are not drawn (frame skip).
+	class PPU {
+	public:
+		struct Registers {
+			u8 ctrl;     // $2000 PPUCTRL
+			u8 mask;     // $2001 PPUMASK
+			u8 status;   // $2002 PPUSTATUS
+			u8 oam_addr; // $2003 OAMADDR
+
+			u16 v; // Current VRAM address (15 bits)
+			u16 t; // Temporary VRAM address, top left onscreen tile
+			u8 x;  // Fine X scroll (3 bits)
+			u8 w;  // First or second $2005/$2006 write toggle
+
+			u8 buffer; // $2007 read buffer
+			u8 latch;  // Last value written to a register (open bus)
+			u8 nmi;    // NMI edge waiting to be taken by the CPU
+		};
+
+		// Everything mutable inside the PPU, kept in the console's state block (see
+		// `nes::State`). The framebuffer is output, not state: it is left out so
+		// rolling back keeps the last picture.
+		struct State {
+			Registers reg;
+			std::array<u8, 32> palette;
+			std::array<u8, 256> oam;
+		};
+
+		// Dots, from the start of a line, at which its status flags get set.
+		struct LineTiming {
+			static constexpr u16 NONE { 0 };
+
+			u16 sprite0_hit { NONE };
+			u16 sprite_overflow { NONE };
+		};
+
+		// One NES color (palette index, 0-63) per pixel.
+		using Framebuffer = std::array<u8, PPU_SCREEN_WIDTH * PPU_SCREEN_HEIGHT>;
+
+		// Color emphasis (PPUMASK bits 5-7, red, green, blue) of every line.
+		using Emphasis = std::array<u8, PPU_SCREEN_HEIGHT>;
+
+		// What drawing a line reads: the registers it starts with, the palette,
+		// OAM and the cartridge windows. The live state when drawing inline, a
+		// replayed `FrameLog` when drawing deferred.
+		struct LineSource {
+			u16 v;
+			u8 x;
+			u8 ctrl;
+			u8 mask;
+			const u8 *palette;
+			const u8 *oam;
+			const Mapper::PpuWindows& windows;
+		};
+
+		explicit PPU(State& state);
+		PPU(const PPU&) = delete;
+		PPU& operator=(const PPU&) = delete;
+
+		void connectBus(Bus *bus);
+
+		void reset();
+
+		// CPU side register access, `reg` is the register number (0-7).
+		[[nodiscard]] u8 cpuRead(u8 reg, bool ro);
+		void cpuWrite(u8 reg, u8 data);
+
+		// OAM DMA: 256 bytes written to OAMDATA, starting at OAMADDR and wrapping.
+		void writeOamDma(const u8 *data);
+
+		// Visible scanline `line` (0-239) starts. Pixels are only drawn when drawing
+		// is on, the returned timing is always exact.
+		[[nodiscard]] LineTiming renderLine(u16 line);
+
+		// Horizontal blank of a visible or the pre-render line: scroll updates.
+		void endLine(u16 line);
+
+		void startVblank();
+		void endVblank();
+
+		inline void setSprite0Hit() { m_state.reg.status |= STATUS_SPRITE0; }
+		inline void setSpriteOverflow() { m_state.reg.status |= STATUS_OVERFLOW; }
+
+		// Turn pixel output on or off, e.g. for skipped frames.
+		inline void setDrawing(bool drawing) { m_drawing = drawing; }
+
+		// Record drawn frames into `log` instead of drawing them, nullptr to draw
+		// inline again. The framebuffer is then left alone.
+		void setLog(FrameLog *log);
+
+		// Draw line `line` (0-239) of `source` to `pixels`.
+		static void drawLine(
+			const LineSource& source, u16 line, u8 *pixels,
+			simd::Isa isa = simd::bestIsa()
+		);
+
+		// OAM entries whose Y puts them on the line after `line`, bit n for entry n.
+		[[nodiscard]] static u64 spriteHits(
+			const u8 *oam, u8 height, u16 line, simd::Isa isa = simd::bestIsa()
+		);
+
+		// Return whether an NMI was raised since the last call.
+		[[nodiscard]] bool pollNmi();
+
+		[[nodiscard]] inline bool renderingEnabled() const {
+			return m_state.reg.mask & (MASK_BACKGROUND | MASK_SPRITES);
+		}
+
+		[[nodiscard]] inline const Framebuffer& getFramebuffer() const {
+			return m_framebuffer;
+		}
+
+		[[nodiscard]] inline const Emphasis& getEmphasis() const { return m_emphasis; }
+
+		[[nodiscard]] u64 hashState(u64 seed) const;
+
+	private:
+		enum Status : u8 {
+			STATUS_OVERFLOW = 1 << 5,
+			STATUS_SPRITE0 = 1 << 6,
+			STATUS_VBLANK = 1 << 7,
+		};
+
+		enum Mask : u8 {
+			MASK_GRAYSCALE = 1 << 0,
+			MASK_BACKGROUND_LEFT = 1 << 1,
+			MASK_SPRITES_LEFT = 1 << 2,
+			MASK_BACKGROUND = 1 << 3,
+			MASK_SPRITES = 1 << 4,
+		};
+
+		// Sprites found by the evaluation on one line, shown on the next one.
+		struct Evaluation {
+			std::array<u8, 8> sprites {}; // OAM indices, in OAM order
+			u8 count { 0 };
+			u16 overflow { LineTiming::NONE }; // Dot the overflow flag gets set
+		};
+
+		// Background pixels (palette << 2 | pattern, 0 if transparent) of a line,
+		// from the first fetched tile: screen pixel `x` is at `x + fine x`.
+		using BackgroundRow = std::array<u8, PPU_SCREEN_WIDTH + 8>;
+
+		[[nodiscard]] LineSource liveSource() const;
+
+		// Sprite evaluation as done by the hardware during `line`, including the
+		// diagonal OAM walk that makes the overflow flag unreliable.
+		[[nodiscard]] static Evaluation evaluateSprites(
+			const u8 *oam, u8 height, u16 line, simd::Isa isa
+		);
+
+		static void fetchBackground(const LineSource& source, BackgroundRow& row);
+
+		// Pattern row of a sprite on `line`, flipped so bit 7 is the leftmost pixel.
+		[[nodiscard]] static std::array<u8, 2> spritePattern(
+			const LineSource& source, u8 index, u16 line
+		);
+
+		// Add the sprites to the background `row` of `line` and write the colors.
+		static void composeLine(
+			const LineSource& source, u16 line, const BackgroundRow& row, u8 *pixels,
+			simd::Isa isa
+		);
+
+		[[nodiscard]] u8 vramRead(u16 addr) const;
+		void vramWrite(u16 addr, u8 data);
+
+		[[nodiscard]] static u8 paletteIndex(u16 addr);
+
+		[[nodiscard]] static inline u8 spriteHeight(u8 ctrl) {
+			return (ctrl & 0x20) ? 16 : 8;
+		}
+
+		// Registers and memories, in the console's state block.
+		State& m_state;
+
+		bool m_drawing { true };
+		FrameLog *m_log { nullptr };
+		Framebuffer m_framebuffer {};
+		Emphasis m_emphasis {};
+
+		Bus *m_bus { nullptr };
+	};
+} // namespace nes
+
+#endif // _NES_PPU_HPP_
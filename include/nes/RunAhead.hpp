@@ -0,0 +1,44 @@
+#ifndef _NES_RUNAHEAD_HPP_
+#define _NES_RUNAHEAD_HPP_
+
+#include "common/types.hpp"
+#include "nes/Bus.hpp"
+
+#include <functional>
+
+namespace nes {
+	// RunAhead hides the input lag games build in (reading input one or two frames
+	// before it shows up on screen).
+	//
+	// Each host frame advances the console by one real frame, saves its state,
+	// emulates `frames` more frames with the same input and presents the last one,
+	// then restores the saved state. The player sees the future the current input
+	// leads to, `frames` frames earlier than the game would show it. Only the
+	// presented frame is drawn, the framebuffer is not rolled back. With render
+	// threads (see `Bus::setRenderThreads`) that frame is waited for, run-ahead
+	// frames are not presented one frame late.
+	class RunAhead {
+	public:
+		// Called on the frame to present, before the console is rolled back.
+		using PresentFn = std::function<void(Bus&)>;
+
+		explicit RunAhead(Bus& bus, u8 frames = 0);
+		RunAhead(const RunAhead&) = delete;
+		RunAhead& operator=(const RunAhead&) = delete;
+
+		inline void setFrames(u8 frames) { m_frames = frames; }
+		[[nodiscard]] inline u8 getFrames() const { return m_frames; }
+
+		// Run one host frame with the input currently set on the bus.
+		void runFrame(const PresentFn& present = {});
+
+	private:
+		Bus& m_bus;
+		u8 m_frames;
+
+		// Reused every frame, so steady state run-ahead does not allocate.
+		State m_snapshot {};
+	};
+} // namespace nes
+
+#endif // _NES_RUNAHEAD_HPP_
@@ -0,0 +1,63 @@
+#ifndef _NES_SAVERAM_HPP_
+#define _NES_SAVERAM_HPP_
+
+#include "common/types.hpp"
+
+#include <cstddef>
+#include <string_view>
+
+#ifdef _WIN32
+	#include <string>
+	#include <vector>
+#endif
+
+// Granularity of the dirty page tracking.
+#define SAVE_RAM_PAGE_SIZE 0x1000
+
+// Default number of frames between two syncs of a modified save file.
+#define SAVE_RAM_SYNC_FRAMES 60
+
+namespace nes {
+	// SaveRam maps a battery save file (.sav) into memory with MAP_SHARED. The
+	// mapper copies its modified PRG RAM pages in every few frames: from there
+	// they reach the page cache at once, surviving a crash of the process, and
+	// `sync` only forces them out to the disk.
+	//
+	// The file descriptor is closed once mapped, so thousands of consoles do not
+	// hold thousands of descriptors open.
+	//
+	// Without mmap (Windows), the file is read into memory at open and `sync`
+	// writes the pages back, always waiting for them.
+	class SaveRam {
+	public:
+		SaveRam() = default;
+		SaveRam(const SaveRam&) = delete;
+		SaveRam& operator=(const SaveRam&) = delete;
+		~SaveRam();
+
+		// Map `size` bytes of `path`, created (zero-filled) when missing, and grown
+		// or shrunk to `size` otherwise.
+		[[nodiscard]] bool open(std::string_view path, std::size_t size);
+
+		// Write back the pages in `pages`, a bit mask of SAVE_RAM_PAGE_SIZE pages.
+		// Without `wait` the write is only scheduled, and never stalls the caller.
+		void sync(u32 pages, bool wait);
+
+		// Sync every page, waiting for the disk, and unmap.
+		void close();
+
+		[[nodiscard]] inline u8 *data() const { return m_data; }
+		[[nodiscard]] inline bool isOpen() const { return m_data != nullptr; }
+
+	private:
+		u8 *m_data { nullptr };
+		std::size_t m_size { 0 };
+
+#ifdef _WIN32
+		std::string m_path {};
+		std::vector<u8> m_buffer {};
+#endif
+	};
+} // namespace nes
+
+#endif // _NES_SAVERAM_HPP_
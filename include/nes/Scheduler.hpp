@@ -0,0 +1,65 @@
+#ifndef _NES_SCHEDULER_HPP_
+#define _NES_SCHEDULER_HPP_
+
+#include "common/types.hpp"
+
+#include <array>
+#include <limits>
+
+namespace nes {
+	// Timed events, each one is pending at most once.
+	enum class Event : u8 {
+		VBLANK_START,    // PPU enters vertical blank, may raise NMI.
+		VBLANK_END,      // Pre-render scanline, vertical blank flags clear.
+		RENDER_LINE,     // A visible scanline starts.
+		HBLANK,          // Horizontal blank of a rendered line, scroll reloads.
+		SPRITE0_HIT,     // Sprite 0 hit flag, on the dot it happens.
+		SPRITE_OVERFLOW, // Sprite overflow flag, on the dot it happens.
+		SCANLINE,        // A rendered scanline, for mappers that count them.
+		APU_FRAME,       // APU frame counter IRQ.
+		COUNT,
+	};
+
+	// Scheduler keeps the pending events in a small binary min-heap ordered by
+	// their timestamp (in master clocks), so the console can run the CPU freely
+	// until the earliest deadline instead of polling every component each cycle.
+	//
+	// The scheduler is plain data, snapshots copy it as is.
+	class Scheduler {
+	public:
+		static constexpr u64 NEVER { std::numeric_limits<u64>::max() };
+
+		// Schedule `event` at `time`, replacing its previous deadline if any.
+		void schedule(Event event, u64 time);
+		void cancel(Event event);
+		void clear();
+
+		// Time of the earliest pending event, or `NEVER`.
+		[[nodiscard]] inline u64 next() const {
+			return m_size > 0 ? m_heap[0].time : NEVER;
+		}
+
+		// Remove and return the earliest event, and the time it was scheduled at,
+		// if it is due at `now`.
+		[[nodiscard]] bool pop(u64 now, Event& event, u64& time);
+
+		// Fingerprint of the pending events and their deadlines, whatever order
+		// the heap keeps them in.
+		[[nodiscard]] u64 hashState(u64 seed) const;
+
+	private:
+		struct Entry {
+			u64 time;
+			Event event;
+		};
+
+		void remove(u8 index);
+		void siftUp(u8 index);
+		void siftDown(u8 index);
+
+		std::array<Entry, static_cast<u8>(Event::COUNT)> m_heap {};
+		u8 m_size { 0 };
+	};
+} // namespace nes
+
+#endif // _NES_SCHEDULER_HPP_
@@ -0,0 +1,69 @@
+#ifndef _NES_STATE_HPP_
+#define _NES_STATE_HPP_
+
+#include "common/types.hpp"
+#include "nes/CPU.hpp"
+#include "nes/Mapper.hpp"
+#include "nes/PPU.hpp"
+#include "nes/Scheduler.hpp"
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+#define NES_RAM_SIZE 2048
+#define NES_VRAM_SIZE 2048
+
+// Cache line size the state block is laid out for.
+#define NES_CACHE_LINE 64
+
+namespace nes {
+	// State is all the mutable state of one console in a single block of plain
+	// data; the CPU, PPU and mapper only hold a reference to their part. Saving,
+	// restoring or cloning a console is one copy of the block.
+	//
+	// Fields are ordered by how often they are touched: the CPU registers, the
+	// master clock, the bus latches and the PPU registers share the first cache
+	// line, the scheduler follows, the memories come last.
+	//
+	// Derived data stays out: the mapper re-points its bank windows after a
+	// restore (`Mapper::loadState`), and the framebuffer is output. So do the
+	// buttons held on the controllers, which are input.
+	struct alignas(NES_CACHE_LINE) State {
+		CPU::State cpu {};
+
+		// Count how many master clocks have passed.
+		u64 clock { 0 };
+
+		// Last value read or written by the CPU.
+		u8 open_bus { 0x00 };
+
+		// APU frame counter ($4017 mode bits) and its IRQ flag.
+		u8 apu_frame_mode { 0x00 };
+		bool apu_frame_irq { false };
+
+		// Controllers: the serial shift registers read by the CPU.
+		std::array<u8, 2> controller_shift {};
+		bool controller_strobe { false };
+
+		PPU::State ppu {};
+
+		Scheduler scheduler {};
+
+		// Count how many frames have been completed since power up.
+		u64 frame { 0 };
+
+		// Memory
+		std::array<u8, NES_RAM_SIZE> ram {};
+		std::array<u8, NES_VRAM_SIZE> vram {};
+		Mapper::State mapper {};
+	};
+
+	static_assert(std::is_trivially_copyable_v<State>);
+	static_assert(
+		offsetof(State, ppu) + sizeof(PPU::Registers) <= NES_CACHE_LINE,
+		"The hot fields no longer fit in one cache line"
+	);
+} // namespace nes
+
+#endif // _NES_STATE_HPP_
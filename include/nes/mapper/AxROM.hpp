@@ -0,0 +1,25 @@
+#ifndef _NES_MAPPER_AXROM_HPP_
+#define _NES_MAPPER_AXROM_HPP_
+
+#include "nes/Mapper.hpp"
+
+namespace nes::mapper {
+	// Mapper 7: 32 KB PRG bank switched at $8000, single screen mirroring selected
+	// by the same register.
+	class AxROM : public Mapper {
+	public:
+		AxROM(CartridgeImage cartridge, State& state);
+
+		void cpuWrite(u16 addr, u8 data) override;
+
+		[[nodiscard]] u64 hashState(u64 seed) const override;
+
+	private:
+		void updateBanks() override;
+
+		// In the state block.
+		u8& m_bank;
+	};
+} // namespace nes::mapper
+
+#endif // _NES_MAPPER_AXROM_HPP_
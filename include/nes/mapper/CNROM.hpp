@@ -0,0 +1,24 @@
+#ifndef _NES_MAPPER_CNROM_HPP_
+#define _NES_MAPPER_CNROM_HPP_
+
+#include "nes/Mapper.hpp"
+
+namespace nes::mapper {
+	// Mapper 3: fixed PRG ROM, 8 KB CHR ROM bank switched at $0000.
+	class CNROM : public Mapper {
+	public:
+		CNROM(CartridgeImage cartridge, State& state);
+
+		void cpuWrite(u16 addr, u8 data) override;
+
+		[[nodiscard]] u64 hashState(u64 seed) const override;
+
+	private:
+		void updateBanks() override;
+
+		// In the state block.
+		u8& m_bank;
+	};
+} // namespace nes::mapper
+
+#endif // _NES_MAPPER_CNROM_HPP_
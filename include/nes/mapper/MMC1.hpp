@@ -0,0 +1,34 @@
+#ifndef _NES_MAPPER_MMC1_HPP_
+#define _NES_MAPPER_MMC1_HPP_
+
+#include "nes/Mapper.hpp"
+
+namespace nes::mapper {
+	// Mapper 1 (SxROM): registers are written one bit at a time through a 5 bit
+	// serial shift register. Switches PRG in 16/32 KB banks, CHR in 4/8 KB banks
+	// and controls mirroring.
+	class MMC1 : public Mapper {
+	public:
+		MMC1(CartridgeImage cartridge, State& state);
+
+		void cpuWrite(u16 addr, u8 data) override;
+
+		[[nodiscard]] u64 hashState(u64 seed) const override;
+
+	private:
+		void updateBanks() override;
+
+		struct Registers {
+			u8 shift { 0x10 }; // Bit 4 marks the shift register as empty.
+			u8 control { 0x0c };
+			u8 chr0 { 0x00 };
+			u8 chr1 { 0x00 };
+			u8 prg { 0x00 };
+		};
+
+		// In the state block.
+		Registers& m_reg;
+	};
+} // namespace nes::mapper
+
+#endif // _NES_MAPPER_MMC1_HPP_
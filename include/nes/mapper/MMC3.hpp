@@ -0,0 +1,41 @@
+#ifndef _NES_MAPPER_MMC3_HPP_
+#define _NES_MAPPER_MMC3_HPP_
+
+#include "nes/Mapper.hpp"
+
+namespace nes::mapper {
+	// Mapper 4 (TxROM): 8 KB PRG and 1/2 KB CHR banks selected through eight bank
+	// registers, plus a scanline counter that raises an IRQ.
+	class MMC3 : public Mapper {
+	public:
+		MMC3(CartridgeImage cartridge, State& state);
+
+		void cpuWrite(u16 addr, u8 data) override;
+
+		void scanline() override;
+		[[nodiscard]] bool countsScanlines() const override { return true; }
+
+		[[nodiscard]] bool irqPending() const override;
+
+		[[nodiscard]] u64 hashState(u64 seed) const override;
+
+	private:
+		void updateBanks() override;
+
+		struct Registers {
+			u8 select { 0x00 }; // Target register and PRG/CHR modes.
+			std::array<u8, 8> bank {}; // R0-R7
+			u8 mirroring { 0x00 };
+			u8 irq_latch { 0x00 };
+			u8 irq_counter { 0x00 };
+			u8 irq_reload { 0x00 };
+			u8 irq_enabled { 0x00 };
+			u8 irq_pending { 0x00 };
+		};
+
+		// In the state block.
+		Registers& m_reg;
+	};
+} // namespace nes::mapper
+
+#endif // _NES_MAPPER_MMC3_HPP_
@@ -4,15 +4,12 @@
 #include "nes/Mapper.hpp"
 
 namespace nes::mapper {
+	// Mapper 0: no banking, 16 or 32 KB PRG ROM and 8 KB CHR.
 	class NROM : public Mapper {
 	public:
 		using Mapper::Mapper;
 
-		u8 cpuRead(u16 addr) override;
 		void cpuWrite(u16 addr, u8 data) override;
-
-		u8 ppuRead(u16 addr) override;
-		void ppuWrite(u16 addr, u8 data) override;
 	};
 } // namespace nes::mapper
 
@@ -0,0 +1,24 @@
+#ifndef _NES_MAPPER_UXROM_HPP_
+#define _NES_MAPPER_UXROM_HPP_
+
+#include "nes/Mapper.hpp"
+
+namespace nes::mapper {
+	// Mapper 2: 16 KB PRG bank switched at $8000, last bank fixed at $c000.
+	class UxROM : public Mapper {
+	public:
+		UxROM(CartridgeImage cartridge, State& state);
+
+		void cpuWrite(u16 addr, u8 data) override;
+
+		[[nodiscard]] u64 hashState(u64 seed) const override;
+
+	private:
+		void updateBanks() override;
+
+		// In the state block.
+		u8& m_bank;
+	};
+} // namespace nes::mapper
+
+#endif // _NES_MAPPER_UXROM_HPP_
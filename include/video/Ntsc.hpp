@@ -0,0 +1,81 @@
+#ifndef _VIDEO_NTSC_HPP_
+#define _VIDEO_NTSC_HPP_
+
+#include "common/types.hpp"
+#include "video/Video.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace video {
+	// Width of the NTSC filter output for lines `width` pixels long: every 3 pixels
+	// (2 color subcarrier cycles) become 7, 256 become 602.
+	[[nodiscard]] inline u32 ntscWidth(u32 width) { return (width + 2) / 3 * 7; }
+
+	// NtscFilter turns frames of NES pixels into what a TV makes of the composite
+	// signal the PPU puts out: color fringes, dot crawl and blurred chroma.
+	//
+	// The signal of a pixel only depends on its color, emphasis and where it
+	// falls in the subcarrier cycle, and decoding is linear, so the contribution
+	// of every pixel to the output is worked out once into a kernel. Filtering
+	// is then a sum of kernels, computed in bands of lines on a small pool of
+	// threads (the calling one included). With SIMD a frame is so short that
+	// waking the workers costs about what they save.
+	class NtscFilter {
+	public:
+		// Filter lines `width` pixels long on `threads` threads (1 to 16).
+		NtscFilter(u32 width, u32 threads);
+		NtscFilter(const NtscFilter&) = delete;
+		NtscFilter& operator=(const NtscFilter&) = delete;
+		~NtscFilter();
+
+		// Filter a frame of NES color indices (0-63, upper bits ignored) with one
+		// emphasis value per line into `out` (`ntscWidth(width)` pixels per line).
+		// `phase` (0-2) is the subcarrier phase of line 0 in thirds of a cycle,
+		// every line adds one; alternating it between frames makes the dots crawl.
+		void apply(
+			const u8 *indices, const u8 *emphasis, u32 height, u8 phase, Rgba *out,
+			simd::Isa isa = simd::bestIsa()
+		);
+
+		[[nodiscard]] inline u32 getWidth() const { return m_width; }
+		[[nodiscard]] inline u32 getThreads() const { return m_thread_count; }
+
+	private:
+		struct Job {
+			const u8 *indices;
+			const u8 *emphasis;
+			u32 height;
+			u8 phase;
+			Rgba *out;
+			simd::Isa isa;
+		};
+
+		void run(u32 worker);
+
+		// Filter lines [first, last) of `job` on the line buffer of `worker`.
+		void filterBand(const Job& job, u32 first, u32 last, u32 worker);
+
+		// Guards everything below.
+		std::mutex m_mutex {};
+		std::condition_variable m_wake {};
+		std::condition_variable m_done {};
+		u64 m_generation { 0 };
+		u32 m_busy { 0 };
+		bool m_stop { false };
+		Job m_job {};
+
+		const u32 m_width;
+		const u32 m_thread_count;
+
+		// The colors of the line being filtered, one buffer per worker (the
+		// calling thread first), with a blank group on either side.
+		std::vector<std::vector<u16>> m_lines {};
+
+		std::vector<std::thread> m_threads {};
+	};
+} // namespace video
+
+#endif // _VIDEO_NTSC_HPP_
@@ -0,0 +1,45 @@
+#ifndef _VIDEO_PALETTE_HPP_
+#define _VIDEO_PALETTE_HPP_
+
+#include "common/types.hpp"
+#include "video/Video.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace video {
+	// NES palette expanded to the 8 color emphasis combinations (PPUMASK bits 5-7),
+	// both as RGBA pixels and as one plane per channel for byte shuffles.
+	class Palette {
+	public:
+		static constexpr std::size_t COLORS { 64 };
+		static constexpr std::size_t EMPHASIS { 8 };
+
+		// The usual 2C02 palette, emphasis dims the two other channels.
+		[[nodiscard]] static Palette standard();
+
+		[[nodiscard]] inline const Rgba *colors(u8 emphasis) const {
+			return m_colors.data() + (emphasis & 0x07) * COLORS;
+		}
+
+		// Red, green or blue (`channel` 0-2) of the 64 colors, as four 16 byte
+		// shuffle tables: the first quarter of the colors, then each quarter XORed
+		// with the previous one (see `convert`).
+		[[nodiscard]] inline const u8 *plane(u8 emphasis, u8 channel) const {
+			return m_planes.data() + ((emphasis & 0x07) * 3 + channel) * COLORS;
+		}
+
+	private:
+		alignas(32) std::array<Rgba, EMPHASIS * COLORS> m_colors {};
+		alignas(16) std::array<u8, EMPHASIS * 3 * COLORS> m_planes {};
+	};
+
+	// Convert a frame of NES color indices (0-63, upper bits ignored) to RGBA, with
+	// one emphasis value per line.
+	void convert(
+		const u8 *indices, const u8 *emphasis, u32 width, u32 height,
+		const Palette& palette, Rgba *out, simd::Isa isa = simd::bestIsa()
+	);
+} // namespace video
+
+#endif // _VIDEO_PALETTE_HPP_
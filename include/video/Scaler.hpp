@@ -0,0 +1,25 @@
+#ifndef _VIDEO_SCALER_HPP_
+#define _VIDEO_SCALER_HPP_
+
+#include "common/types.hpp"
+#include "video/Video.hpp"
+
+namespace video {
+	enum class Scaler : u8 {
+		INTEGER, // Nearest neighbour, any whole factor.
+		SCALE2X, // Scale2x (EPX), factor 2: rounds diagonal edges.
+	};
+
+	// Width or height of the output for an input `size` pixels long.
+	[[nodiscard]] inline u32 scaledSize(Scaler scaler, u32 size, u32 factor) {
+		return size * (scaler == Scaler::SCALE2X ? 2 : factor);
+	}
+
+	// Scale `src` into `dst` (`dst` rows are `scaledSize` pixels long).
+	void scale(
+		Scaler scaler, const Rgba *src, u32 width, u32 height, u32 factor, Rgba *dst,
+		simd::Isa isa = simd::bestIsa()
+	);
+} // namespace video
+
+#endif // _VIDEO_SCALER_HPP_
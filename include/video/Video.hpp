@@ -0,0 +1,12 @@
+#ifndef _VIDEO_VIDEO_HPP_
+#define _VIDEO_VIDEO_HPP_
+
+#include "common/Simd.hpp"
+#include "common/types.hpp"
+
+namespace video {
+	// One RGBA8 pixel as laid out in memory (R, G, B, A), what `sf::Texture` takes.
+	using Rgba = u32;
+} // namespace video
+
+#endif // _VIDEO_VIDEO_HPP_
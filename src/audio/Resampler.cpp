@@ -0,0 +1,187 @@
+#include "audio/Resampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef SIMD_X86
+	#include <immintrin.h>
+#endif
+
+namespace {
+	// Passband edge, as a fraction of the output Nyquist frequency.
+	constexpr double cutoff { 0.9 };
+	// Sinc zero crossings on each side of the center, sets the filter length.
+	constexpr double zero_crossings { 8.0 };
+	// Kaiser window shape, about 80 dB of stopband rejection.
+	constexpr double kaiser_beta { 8.0 };
+
+	// Taps are padded to whole pairs of AVX registers.
+	constexpr std::size_t tap_multiple { 16 };
+
+	constexpr double pi { 3.14159265358979323846 };
+
+	// Zeroth order modified Bessel function of the first kind.
+	[[nodiscard]] double bessel0(double x) {
+		double sum { 1.0 };
+		double term { 1.0 };
+		for (int k { 1 }; k < 32; ++k) {
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+		}
+		return sum;
+	}
+
+	[[nodiscard]] s16 toSample(float value) {
+		const long sample { std::lround(value * 32767.0f) };
+		return static_cast<s16>(std::clamp(sample, -32768L, 32767L));
+	}
+
+	float dotScalar(const float *a, const float *b, std::size_t count) {
+		float sum { 0.0f };
+		for (std::size_t i { 0 }; i < count; ++i) {
+			sum += a[i] * b[i];
+		}
+		return sum;
+	}
+
+#ifdef SIMD_X86
+	__attribute__((target("sse3"))) float
+	dotSse(const float *a, const float *b, std::size_t count) {
+		__m128 sum0 { _mm_setzero_ps() };
+		__m128 sum1 { _mm_setzero_ps() };
+		for (std::size_t i { 0 }; i < count; i += 8) {
+			sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+			sum1 = _mm_add_ps(
+				sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4))
+			);
+		}
+
+		__m128 sum { _mm_add_ps(sum0, sum1) };
+		sum = _mm_hadd_ps(sum, sum);
+		sum = _mm_hadd_ps(sum, sum);
+		return _mm_cvtss_f32(sum);
+	}
+
+	__attribute__((target("avx2"))) float
+	dotAvx2(const float *a, const float *b, std::size_t count) {
+		__m256 sum0 { _mm256_setzero_ps() };
+		__m256 sum1 { _mm256_setzero_ps() };
+		for (std::size_t i { 0 }; i < count; i += 16) {
+			sum0 = _mm256_add_ps(
+				sum0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i))
+			);
+			sum1 = _mm256_add_ps(
+				sum1,
+				_mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8))
+			);
+		}
+
+		const __m256 sum { _mm256_add_ps(sum0, sum1) };
+		__m128 half {
+			_mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1))
+		};
+		half = _mm_hadd_ps(half, half);
+		half = _mm_hadd_ps(half, half);
+		return _mm_cvtss_f32(half);
+	}
+#endif
+} // namespace
+
+namespace audio {
+	Resampler::Resampler(double input_rate, double output_rate, simd::Isa isa)
+		: m_isa(isa)
+		, m_ratio(input_rate / output_rate) {
+		// Cutoff in cycles per input sample, only ever downsampling.
+		const double fc { 0.5 * cutoff / std::max(m_ratio, 1.0) };
+		const double half_width { zero_crossings / (2.0 * fc) };
+		m_taps = static_cast<std::size_t>(std::ceil(2.0 * half_width));
+		m_taps = (m_taps + tap_multiple - 1) / tap_multiple * tap_multiple;
+
+		const double center { static_cast<double>(m_taps / 2 - 1) };
+		const double radius { static_cast<double>(m_taps / 2) };
+		m_kernel.resize((PHASES + 1) * m_taps);
+		for (std::size_t phase { 0 }; phase <= PHASES; ++phase) {
+			float *row { m_kernel.data() + phase * m_taps };
+			const double shift { static_cast<double>(phase) / PHASES };
+
+			double sum { 0.0 };
+			for (std::size_t tap { 0 }; tap < m_taps; ++tap) {
+				const double t { static_cast<double>(tap) - center - shift };
+				const double x { 2.0 * fc * t };
+				const double sinc { x == 0.0 ? 1.0 : std::sin(pi * x) / (pi * x) };
+				const double edge { std::min(std::abs(t) / radius, 1.0) };
+				const double window {
+					bessel0(kaiser_beta * std::sqrt(1.0 - edge * edge))
+					/ bessel0(kaiser_beta)
+				};
+				row[tap] = static_cast<float>(sinc * window);
+				sum += row[tap];
+			}
+
+			// Unity gain at DC for every phase.
+			for (std::size_t tap { 0 }; tap < m_taps; ++tap) {
+				row[tap] = static_cast<float>(row[tap] / sum);
+			}
+		}
+
+		m_history.assign(m_taps / 2, 0.0f);
+		m_position = static_cast<double>(m_taps / 2);
+		setRateAdjust(0.0);
+	}
+
+	void Resampler::setRateAdjust(double adjust) {
+		adjust = std::clamp(adjust, -AUDIO_MAX_RATE_ADJUST, AUDIO_MAX_RATE_ADJUST);
+		m_step = m_ratio * (1.0 + adjust);
+	}
+
+	std::size_t
+	Resampler::process(const float *in, std::size_t count, std::vector<s16>& out) {
+		m_history.insert(m_history.end(), in, in + count);
+
+		const std::size_t before { out.size() };
+		const std::size_t lead { m_taps / 2 - 1 };
+		while (true) {
+			const double whole { std::floor(m_position) };
+			const auto start { static_cast<std::size_t>(whole) - lead };
+			if (start + m_taps > m_history.size()) {
+				break;
+			}
+
+			const auto phase { static_cast<std::size_t>(
+				std::lround((m_position - whole) * PHASES)
+			) };
+			const float *kernel { m_kernel.data() + phase * m_taps };
+			out.push_back(toSample(dot(kernel, &m_history[start])));
+			m_position += m_step;
+		}
+
+		// Keep the input from the next output's first tap on.
+		const std::size_t consumed { std::min(
+			static_cast<std::size_t>(m_position) - lead, m_history.size()
+		) };
+		m_history.erase(m_history.begin(), m_history.begin() + consumed);
+		m_position -= static_cast<double>(consumed);
+
+		return out.size() - before;
+	}
+
+	double Resampler::dynamicRate(std::size_t fill, std::size_t capacity) {
+		const double level { static_cast<double>(fill) / static_cast<double>(capacity) };
+		return std::clamp(
+			(2.0 * level - 1.0) * AUDIO_MAX_RATE_ADJUST, -AUDIO_MAX_RATE_ADJUST,
+			AUDIO_MAX_RATE_ADJUST
+		);
+	}
+
+	float Resampler::dot(const float *kernel, const float *samples) const {
+#ifdef SIMD_X86
+		if (m_isa == simd::Isa::AVX2) {
+			return dotAvx2(kernel, samples, m_taps);
+		}
+		if (m_isa == simd::Isa::SSSE3) {
+			return dotSse(kernel, samples, m_taps);
+		}
+#endif
+		return dotScalar(kernel, samples, m_taps);
+	}
+} // namespace audio
@@ -0,0 +1,39 @@
+#include "audio/Ring.hpp"
+
+#include <algorithm>
+
+namespace audio {
+	Ring::Ring(std::size_t capacity) : m_samples(capacity) {}
+
+	std::size_t Ring::push(const s16 *samples, std::size_t count) {
+		const u64 write { m_write.load(std::memory_order_relaxed) };
+		const u64 read { m_read.load(std::memory_order_acquire) };
+		count = std::min<std::size_t>(count, capacity() - (write - read));
+
+		for (std::size_t i { 0 }; i < count; ++i) {
+			m_samples[(write + i) % capacity()] = samples[i];
+		}
+		m_write.store(write + count, std::memory_order_release);
+
+		return count;
+	}
+
+	std::size_t Ring::pop(s16 *samples, std::size_t count) {
+		const u64 read { m_read.load(std::memory_order_relaxed) };
+		const u64 write { m_write.load(std::memory_order_acquire) };
+		count = std::min<std::size_t>(count, write - read);
+
+		for (std::size_t i { 0 }; i < count; ++i) {
+			samples[i] = m_samples[(read + i) % capacity()];
+		}
+		m_read.store(read + count, std::memory_order_release);
+
+		return count;
+	}
+
+	std::size_t Ring::size() const {
+		// Read index first: the write index can only have moved further since.
+		const u64 read { m_read.load(std::memory_order_acquire) };
+		return m_write.load(std::memory_order_acquire) - read;
+	}
+} // namespace audio
@@ -0,0 +1,154 @@
+#include "capture/Stream.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace {
+	// About five 256x240 4:4:4 frames.
+	constexpr std::size_t block_size { 1 << 20 };
+
+	// A shell command reading what is written, binary as files are.
+	std::FILE *openPipe(const char *command) {
+#ifdef _WIN32
+		return _popen(command, "wb");
+#else
+		return popen(command, "w");
+#endif
+	}
+
+	int closePipe(std::FILE *pipe) {
+#ifdef _WIN32
+		return _pclose(pipe);
+#else
+		return pclose(pipe);
+#endif
+	}
+} // namespace
+
+namespace capture {
+	Stream::~Stream() {
+		close();
+	}
+
+	bool Stream::open(std::string_view target) {
+		close();
+		if (target.empty()) {
+			return false;
+		}
+
+		const std::string name { target.substr(target.front() == '|' ? 1 : 0) };
+		m_pipe = target.front() == '|';
+		m_file = m_pipe ? openPipe(name.c_str()) : std::fopen(name.c_str(), "wb");
+		if (!m_file) {
+			return false;
+		}
+
+		m_front.reserve(block_size);
+		m_back.reserve(block_size);
+		m_failed = false;
+		m_stop = false;
+		m_bytes = 0;
+		m_stall_time = {};
+		m_thread = std::thread { &Stream::run, this };
+
+		return true;
+	}
+
+	u8 *Stream::append(std::size_t size) {
+		if (!m_front.empty() && m_front.size() + size > block_size) {
+			handOver();
+		}
+
+		const std::size_t offset { m_front.size() };
+		m_front.resize(offset + size);
+		m_bytes += size;
+
+		return m_front.data() + offset;
+	}
+
+	void Stream::append(const void *data, std::size_t size) {
+		std::memcpy(append(size), data, size);
+	}
+
+	void Stream::drain() {
+		if (!m_thread.joinable()) {
+			return;
+		}
+
+		if (!m_front.empty()) {
+			handOver();
+		}
+
+		{
+			const std::lock_guard lock { m_mutex };
+			m_stop = true;
+		}
+		m_wake.notify_one();
+		m_thread.join();
+	}
+
+	bool Stream::patch(u64 offset, const void *data, std::size_t size) {
+		if (m_pipe || m_thread.joinable()) {
+			return false;
+		}
+
+		const auto end { std::ftell(m_file) };
+		const bool ok {
+			std::fseek(m_file, static_cast<long>(offset), SEEK_SET) == 0
+			&& std::fwrite(data, 1, size, m_file) == size
+		};
+		std::fseek(m_file, end, SEEK_SET);
+
+		return ok;
+	}
+
+	void Stream::close() {
+		if (!m_file) {
+			return;
+		}
+
+		drain();
+		if (m_pipe) {
+			m_failed |= closePipe(m_file) != 0;
+		} else {
+			m_failed |= std::fclose(m_file) != 0;
+		}
+		m_file = nullptr;
+	}
+
+	void Stream::handOver() {
+		std::unique_lock lock { m_mutex };
+		if (m_pending) {
+			const auto start { std::chrono::steady_clock::now() };
+			m_done.wait(lock, [this] { return !m_pending; });
+			m_stall_time += std::chrono::steady_clock::now() - start;
+		}
+
+		m_front.swap(m_back);
+		m_front.clear();
+		m_pending = true;
+		lock.unlock();
+
+		m_wake.notify_one();
+	}
+
+	void Stream::run() {
+		std::unique_lock lock { m_mutex };
+		while (true) {
+			m_wake.wait(lock, [this] { return m_pending || m_stop; });
+			if (!m_pending) {
+				return;
+			}
+
+			// The producer never touches the back buffer while it is pending.
+			lock.unlock();
+			const std::size_t size { m_back.size() };
+			const bool ok { std::fwrite(m_back.data(), 1, size, m_file) == size };
+			lock.lock();
+
+			m_failed |= !ok;
+			m_pending = false;
+			m_done.notify_one();
+		}
+	}
+} // namespace capture
@@ -0,0 +1,79 @@
+#include "capture/WavWriter.hpp"
+
+#include <array>
+#include <cstring>
+
+namespace {
+	constexpr std::size_t header_size { 44 };
+	constexpr u32 unknown_size { 0xffffffff };
+
+	void put16(u8 *out, u16 value) {
+		out[0] = static_cast<u8>(value);
+		out[1] = static_cast<u8>(value >> 8);
+	}
+
+	void put32(u8 *out, u32 value) {
+		put16(out, static_cast<u16>(value));
+		put16(out + 2, static_cast<u16>(value >> 16));
+	}
+} // namespace
+
+namespace capture {
+	bool WavWriter::open(std::string_view target, u32 rate, u16 channels) {
+		close();
+		if (!m_stream.open(target)) {
+			return false;
+		}
+
+		m_rate = rate;
+		m_channels = channels;
+		m_samples = 0;
+
+		const u16 block_align { static_cast<u16>(channels * sizeof(s16)) };
+		u8 *header { m_stream.append(header_size) };
+		std::memcpy(header, "RIFF", 4);
+		put32(header + 4, unknown_size);
+		std::memcpy(header + 8, "WAVEfmt ", 8);
+		put32(header + 16, 16);
+		put16(header + 20, 1); // PCM
+		put16(header + 22, channels);
+		put32(header + 24, rate);
+		put32(header + 28, rate * block_align);
+		put16(header + 32, block_align);
+		put16(header + 34, 16);
+		std::memcpy(header + 36, "data", 4);
+		put32(header + 40, unknown_size);
+
+		return true;
+	}
+
+	void WavWriter::write(const s16 *samples, std::size_t count) {
+		u8 *out { m_stream.append(count * sizeof(s16)) };
+		for (std::size_t i { 0 }; i < count; ++i) {
+			put16(out + i * 2, static_cast<u16>(samples[i]));
+		}
+		m_samples += count;
+	}
+
+	void WavWriter::writeSilence(std::size_t count) {
+		std::memset(m_stream.append(count * sizeof(s16)), 0, count * sizeof(s16));
+		m_samples += count;
+	}
+
+	void WavWriter::close() {
+		if (!m_stream.isOpen()) {
+			return;
+		}
+
+		m_stream.drain();
+		if (!m_stream.isPipe()) {
+			const u64 data_size { m_samples * sizeof(s16) };
+			std::array<u8, 4> size {};
+			put32(size.data(), static_cast<u32>(data_size + header_size - 8));
+			m_stream.patch(4, size.data(), size.size());
+			put32(size.data(), static_cast<u32>(data_size));
+			m_stream.patch(40, size.data(), size.size());
+		}
+		m_stream.close();
+	}
+} // namespace capture
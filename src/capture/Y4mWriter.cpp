@@ -0,0 +1,112 @@
+#include "capture/Y4mWriter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace {
+	using video::Palette;
+
+	constexpr std::string_view frame_header { "FRAME\n" };
+
+	[[nodiscard]] u8 toByte(double value) {
+		return static_cast<u8>(std::clamp(std::lround(value), 0L, 255L));
+	}
+} // namespace
+
+namespace capture {
+	Y4mWriter::Y4mWriter(const video::Palette& palette) {
+		for (std::size_t emphasis { 0 }; emphasis < Palette::EMPHASIS; ++emphasis) {
+			const video::Rgba *colors { palette.colors(static_cast<u8>(emphasis)) };
+
+			for (std::size_t color { 0 }; color < Palette::COLORS; ++color) {
+				std::array<u8, 4> rgba {};
+				std::memcpy(rgba.data(), &colors[color], rgba.size());
+				const double r { rgba[0] / 255.0 };
+				const double g { rgba[1] / 255.0 };
+				const double b { rgba[2] / 255.0 };
+
+				// BT.601, limited range.
+				m_yuv.at(emphasis * Palette::COLORS + color) = {
+					toByte(16.0 + 65.481 * r + 128.553 * g + 24.966 * b),
+					toByte(128.0 - 37.797 * r - 74.203 * g + 112.0 * b),
+					toByte(128.0 + 112.0 * r - 93.786 * g - 18.214 * b),
+				};
+			}
+		}
+	}
+
+	bool
+	Y4mWriter::open(std::string_view target, u32 width, u32 height, bool skip_unchanged) {
+		close();
+		if (!m_stream.open(target)) {
+			return false;
+		}
+
+		m_width = width;
+		m_height = height;
+		m_skip_unchanged = skip_unchanged;
+		m_indices.clear();
+		m_emphasis.clear();
+		m_frame.clear();
+		m_frames = 0;
+		m_repeated = 0;
+
+		const std::string header {
+			"YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height)
+			+ " F" + std::to_string(Y4M_FPS_NUMERATOR) + ":"
+			+ std::to_string(Y4M_FPS_DENOMINATOR) + " Ip A1:1 C444\n"
+		};
+		m_stream.append(header.data(), header.size());
+
+		return true;
+	}
+
+	void Y4mWriter::writeFrame(const u8 *indices, const u8 *emphasis) {
+		const std::size_t pixels { static_cast<std::size_t>(m_width) * m_height };
+		m_stream.append(frame_header.data(), frame_header.size());
+		++m_frames;
+
+		if (!m_skip_unchanged) {
+			convert(indices, emphasis, m_stream.append(pixels * 3));
+			return;
+		}
+
+		const bool unchanged {
+			!m_frame.empty() && std::equal(indices, indices + pixels, m_indices.begin())
+			&& std::equal(emphasis, emphasis + m_height, m_emphasis.begin())
+		};
+		if (unchanged) {
+			++m_repeated;
+		} else {
+			m_indices.assign(indices, indices + pixels);
+			m_emphasis.assign(emphasis, emphasis + m_height);
+			m_frame.resize(pixels * 3);
+			convert(indices, emphasis, m_frame.data());
+		}
+		m_stream.append(m_frame.data(), m_frame.size());
+	}
+
+	void Y4mWriter::close() {
+		m_stream.close();
+	}
+
+	void Y4mWriter::convert(const u8 *indices, const u8 *emphasis, u8 *out) const {
+		const std::size_t plane { static_cast<std::size_t>(m_width) * m_height };
+		u8 *y_plane { out };
+		u8 *cb_plane { out + plane };
+		u8 *cr_plane { out + plane * 2 };
+
+		for (u32 line { 0 }; line < m_height; ++line) {
+			const auto *yuv { &m_yuv.at((emphasis[line] & 0x07) * Palette::COLORS) };
+			for (u32 x { 0 }; x < m_width; ++x) {
+				const std::size_t pixel { line * m_width + x };
+				const auto& color { yuv[indices[pixel] & 0x3f] };
+				y_plane[pixel] = color[0];
+				cb_plane[pixel] = color[1];
+				cr_plane[pixel] = color[2];
+			}
+		}
+	}
+} // namespace capture
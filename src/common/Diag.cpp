@@ -0,0 +1,171 @@
+#include "common/Diag.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+	// Slots in the queue, a power of two.
+	constexpr std::size_t queue_size { 1024 };
+
+	// How long the writer sleeps when the queue is empty.
+	constexpr std::chrono::milliseconds idle_wait { 2 };
+
+	std::atomic<diag::Site *> sites { nullptr };
+
+	// Bounded multi-producer queue (D. Vyukov's design). Each slot's sequence
+	// number tells whose turn it is: equal to the ticket, it is free for the
+	// producer holding that ticket; ticket + 1, it holds a committed message.
+	class Queue {
+	public:
+		Queue() : m_cells(queue_size) {
+			// Create spdlog's registry first so that it outlives the writer.
+			spdlog::default_logger();
+			for (std::size_t i { 0 }; i < queue_size; ++i) {
+				m_cells[i].sequence.store(i, std::memory_order_relaxed);
+			}
+			m_thread = std::thread { &Queue::run, this };
+		}
+
+		~Queue() {
+			m_stop.store(true, std::memory_order_release);
+			m_thread.join();
+		}
+
+		diag::Message *acquire() {
+			u64 ticket { m_enqueue.load(std::memory_order_relaxed) };
+			while (true) {
+				Cell& cell { m_cells[ticket % queue_size] };
+				const u64 sequence { cell.sequence.load(std::memory_order_acquire) };
+
+				if (sequence == ticket) {
+					if (m_enqueue.compare_exchange_weak(
+							ticket, ticket + 1, std::memory_order_relaxed
+						)) {
+						cell.ticket = ticket;
+						return &cell.message;
+					}
+				} else if (sequence < ticket) {
+					m_dropped.fetch_add(1, std::memory_order_relaxed);
+					return nullptr;
+				} else {
+					ticket = m_enqueue.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		void commit(diag::Message *message) {
+			// The message is the first member of its cell.
+			auto *cell { reinterpret_cast<Cell *>(message) };
+			cell->sequence.store(cell->ticket + 1, std::memory_order_release);
+		}
+
+		void flush() {
+			const u64 target { m_enqueue.load(std::memory_order_acquire) };
+			while (m_dequeue.load(std::memory_order_acquire) < target) {
+				std::this_thread::sleep_for(idle_wait);
+			}
+		}
+
+		[[nodiscard]] u64 getDropped() const {
+			return m_dropped.load(std::memory_order_relaxed);
+		}
+
+	private:
+		struct Cell {
+			diag::Message message;
+			u64 ticket;
+			std::atomic<u64> sequence;
+		};
+
+		void run() {
+			while (true) {
+				const u64 ticket { m_dequeue.load(std::memory_order_relaxed) };
+				Cell& cell { m_cells[ticket % queue_size] };
+
+				if (cell.sequence.load(std::memory_order_acquire) != ticket + 1) {
+					if (m_stop.load(std::memory_order_acquire)
+					    && m_enqueue.load(std::memory_order_acquire) == ticket) {
+						return;
+					}
+					std::this_thread::sleep_for(idle_wait);
+					continue;
+				}
+
+				write(cell.message);
+				cell.sequence.store(ticket + queue_size, std::memory_order_release);
+				m_dequeue.store(ticket + 1, std::memory_order_release);
+			}
+		}
+
+		static void write(const diag::Message& message) {
+			const std::string_view text { message.text.data(), message.size };
+			const auto level {
+				static_cast<spdlog::level::level_enum>(message.site->getLevel())
+			};
+
+			if (message.count > DIAG_BURST) {
+				spdlog::log(level, "{} (hit {} times)", text, message.count);
+			} else {
+				spdlog::log(level, "{}", text);
+			}
+		}
+
+		std::vector<Cell> m_cells;
+		std::atomic<u64> m_enqueue { 0 };
+		std::atomic<u64> m_dequeue { 0 };
+		std::atomic<u64> m_dropped { 0 };
+		std::atomic<bool> m_stop { false };
+		std::thread m_thread {};
+	};
+
+	Queue& queue() {
+		// Started on the first message, drained and stopped at exit.
+		static Queue instance {};
+		return instance;
+	}
+} // namespace
+
+namespace diag {
+	Site::Site(int level, const char *file, int line)
+		: m_level(level)
+		, m_file(file)
+		, m_line(line) {
+		m_next = sites.load(std::memory_order_relaxed);
+		while (!sites.compare_exchange_weak(m_next, this, std::memory_order_release)) {}
+	}
+
+	Message *acquire() {
+		return queue().acquire();
+	}
+
+	void commit(Message *message) {
+		queue().commit(message);
+	}
+
+	void flush() {
+		queue().flush();
+	}
+
+	void report() {
+		flush();
+
+		for (const Site *site { sites.load(std::memory_order_acquire) }; site != nullptr;
+		     site = site->m_next) {
+			if (site->getCount() > DIAG_BURST) {
+				spdlog::info(
+					"{}:{}: hit {} times, rate limited", site->getFile(), site->getLine(),
+					site->getCount()
+				);
+			}
+		}
+
+		if (const u64 dropped { queue().getDropped() }; dropped > 0) {
+			spdlog::warn("{} diagnostics dropped on a full queue", dropped);
+		}
+	}
+} // namespace diag
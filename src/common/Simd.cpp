@@ -0,0 +1,45 @@
+#include "common/Simd.hpp"
+
+#include <initializer_list>
+
+namespace simd {
+	bool isSupported(Isa isa) {
+		switch (isa) {
+		case Isa::SCALAR:
+			return true;
+#ifdef SIMD_X86
+		case Isa::SSSE3:
+			return __builtin_cpu_supports("ssse3");
+		case Isa::AVX2:
+			return __builtin_cpu_supports("avx2");
+#endif
+		default:
+			return false;
+		}
+	}
+
+	Isa bestIsa() {
+		// Checked once, the answer never changes.
+		static const Isa best { [] {
+			for (const Isa isa : { Isa::AVX2, Isa::SSSE3 }) {
+				if (isSupported(isa)) {
+					return isa;
+				}
+			}
+			return Isa::SCALAR;
+		}() };
+
+		return best;
+	}
+
+	const char *isaName(Isa isa) {
+		switch (isa) {
+		case Isa::SSSE3:
+			return "ssse3";
+		case Isa::AVX2:
+			return "avx2";
+		default:
+			return "scalar";
+		}
+	}
+} // namespace simd
@@ -0,0 +1,59 @@
+#include "frontend/FramePacer.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+	using namespace std::chrono_literals;
+
+	// Bounds of the spin margin: sleeps rarely wake up less than this late, and a
+	// longer spin costs more than a late frame once in a while.
+	constexpr std::chrono::nanoseconds min_margin { 200us };
+	constexpr std::chrono::nanoseconds max_margin { 4ms };
+
+	// The margin covers the latest wake-up seen, shrinking back by this much per
+	// frame once sleeps get more precise.
+	constexpr std::chrono::nanoseconds margin_decay { 10us };
+
+	// Frames behind schedule after which the pace starts over.
+	constexpr s64 max_lag { 3 };
+} // namespace
+
+namespace frontend {
+	FramePacer::FramePacer(std::chrono::nanoseconds period)
+		: m_period(period)
+		, m_margin(min_margin * 4) {}
+
+	std::chrono::nanoseconds FramePacer::wait() {
+		const auto now { Clock::now() };
+		if (!m_started) {
+			m_deadline = now;
+			m_started = true;
+		}
+
+		m_deadline += std::chrono::duration_cast<std::chrono::nanoseconds>(
+			m_period * (1.0 + m_adjust)
+		);
+		if (now - m_deadline > m_period * max_lag) {
+			m_deadline = now;
+			return 0ns;
+		}
+
+		const auto wake { m_deadline - m_margin };
+		if (now < wake) {
+			std::this_thread::sleep_until(wake);
+			const std::chrono::nanoseconds late { Clock::now() - wake };
+			m_margin = std::clamp(
+				std::max(m_margin - margin_decay, late + late / 4), min_margin, max_margin
+			);
+		}
+
+		// Yielding rather than a bare spin leaves the core to the audio thread when
+		// there is only one.
+		while (Clock::now() < m_deadline) {
+			std::this_thread::yield();
+		}
+
+		return std::max(Clock::now() - m_deadline, Clock::duration::zero());
+	}
+} // namespace frontend
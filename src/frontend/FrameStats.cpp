@@ -0,0 +1,129 @@
+#include "frontend/FrameStats.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <string>
+
+namespace {
+	using Milliseconds = std::chrono::duration<double, std::milli>;
+
+	// Value at `fraction` (0-1) of the sorted `values`, nearest rank.
+	[[nodiscard]] double percentile(std::vector<double> values, double fraction) {
+		if (values.empty()) {
+			return 0.0;
+		}
+
+		const auto rank { static_cast<std::size_t>(
+			fraction * static_cast<double>(values.size() - 1) + 0.5
+		) };
+		std::nth_element(values.begin(), values.begin() + rank, values.end());
+		return values[rank];
+	}
+} // namespace
+
+namespace frontend {
+	FrameStats::FrameStats(std::size_t frames)
+		: m_frames(std::max<std::size_t>(frames, 2)) {}
+
+	void FrameStats::markInput() {
+		m_current = {};
+		m_current.input = Clock::now();
+	}
+
+	void FrameStats::markPresented() {
+		m_current.presented = Clock::now();
+		if (m_count == 0) {
+			m_start = m_current.input;
+		}
+		m_frames[m_count % m_frames.size()] = m_current;
+		m_count += 1;
+
+		if (m_csv.is_open()) {
+			writeCsvLine(m_count - 1);
+		}
+	}
+
+	FrameStats::Summary FrameStats::summarize(std::size_t frames) const {
+		const u64 kept { std::min<u64>(m_count, m_frames.size()) };
+		const u64 count { frames == 0 ? kept : std::min<u64>(frames, kept) };
+
+		std::vector<double> frame_times {};
+		std::vector<double> latencies {};
+		frame_times.reserve(count);
+		latencies.reserve(count);
+		for (u64 n { m_count - count }; n < m_count; ++n) {
+			if (const double time { frameTime(n) }; time >= 0.0) {
+				frame_times.push_back(time);
+			}
+			if (const double time { latency(n) }; time >= 0.0) {
+				latencies.push_back(time);
+			}
+		}
+
+		return {
+			count,
+			percentile(frame_times, 0.50),
+			percentile(frame_times, 0.99),
+			percentile(latencies, 0.50),
+			percentile(latencies, 0.99),
+		};
+	}
+
+	bool FrameStats::openCsv(std::string_view path) {
+		m_csv.open(std::string { path });
+		if (!m_csv) {
+			return false;
+		}
+
+		m_csv << std::fixed << std::setprecision(3);
+		m_csv << "frame,input_ms,emulated_ms,presented_ms,frame_time_ms,latency_ms\n";
+		return static_cast<bool>(m_csv);
+	}
+
+	bool FrameStats::closeCsv() {
+		if (!m_csv.is_open()) {
+			return true;
+		}
+
+		m_csv.close();
+		const bool written { !m_csv.fail() };
+		m_csv.clear();
+		return written;
+	}
+
+	void FrameStats::writeCsvLine(u64 n) {
+		const auto since_start { [this](Clock::time_point time) {
+			return Milliseconds { time - m_start }.count();
+		} };
+		const Frame& written { frame(n) };
+		m_csv << n << ',' << since_start(written.input) << ','
+		      << since_start(written.emulated) << ',' << since_start(written.presented)
+		      << ',';
+
+		// Empty fields where there is nothing to measure from yet.
+		if (const double time { frameTime(n) }; time >= 0.0) {
+			m_csv << time;
+		}
+		m_csv << ',';
+		if (const double time { latency(n) }; time >= 0.0) {
+			m_csv << time;
+		}
+		m_csv << '\n';
+	}
+
+	double FrameStats::frameTime(u64 n) const {
+		if (n == 0 || !isKept(n - 1)) {
+			return -1.0;
+		}
+		return Milliseconds { frame(n).presented - frame(n - 1).presented }.count();
+	}
+
+	double FrameStats::latency(u64 n) const {
+		if (n < m_picture_lag || !isKept(n - m_picture_lag)) {
+			return -1.0;
+		}
+		const auto input { frame(n - m_picture_lag).input };
+		return Milliseconds { frame(n).presented - input }.count();
+	}
+} // namespace frontend
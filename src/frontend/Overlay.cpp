@@ -0,0 +1,103 @@
+#include "frontend/Overlay.hpp"
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+namespace {
+	constexpr u32 glyph_width { 3 };
+	constexpr u32 glyph_height { 5 };
+	// Glyphs and lines are 1 pixel apart, with 2 around the text.
+	constexpr u32 advance { glyph_width + 1 };
+	constexpr u32 line_height { glyph_height + 1 };
+	constexpr u32 border { 2 };
+
+	// RGBA as laid out in memory, read as a little-endian u32.
+	constexpr u32 text_color { 0xffffffff };
+	constexpr u32 backdrop_color { 0xb0000000 };
+
+	// One row per entry from the top, bit 2 being the leftmost pixel.
+	using Glyph = std::array<u8, glyph_height>;
+
+	constexpr std::string_view glyph_chars {
+		"0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:-/%"
+	};
+
+	// clang-format off
+	constexpr std::array<Glyph, glyph_chars.size()> glyphs { {
+		{ 7, 5, 5, 5, 7 }, { 2, 6, 2, 2, 7 }, { 7, 1, 7, 4, 7 }, { 7, 1, 7, 1, 7 },
+		{ 5, 5, 7, 1, 1 }, { 7, 4, 7, 1, 7 }, { 7, 4, 7, 5, 7 }, { 7, 1, 1, 1, 1 },
+		{ 7, 5, 7, 5, 7 }, { 7, 5, 7, 1, 7 },
+		{ 2, 5, 7, 5, 5 }, { 6, 5, 6, 5, 6 }, { 3, 4, 4, 4, 3 }, { 6, 5, 5, 5, 6 },
+		{ 7, 4, 6, 4, 7 }, { 7, 4, 6, 4, 4 }, { 3, 4, 5, 5, 3 }, { 5, 5, 7, 5, 5 },
+		{ 7, 2, 2, 2, 7 }, { 1, 1, 1, 5, 2 }, { 5, 5, 6, 5, 5 }, { 4, 4, 4, 4, 7 },
+		{ 5, 7, 7, 5, 5 }, { 6, 5, 5, 5, 5 }, { 2, 5, 5, 5, 2 }, { 6, 5, 6, 4, 4 },
+		{ 2, 5, 5, 6, 3 }, { 6, 5, 6, 5, 5 }, { 3, 4, 2, 1, 6 }, { 7, 2, 2, 2, 2 },
+		{ 5, 5, 5, 5, 7 }, { 5, 5, 5, 5, 2 }, { 5, 5, 7, 7, 5 }, { 5, 5, 2, 5, 5 },
+		{ 5, 5, 2, 2, 2 }, { 7, 1, 2, 4, 7 },
+		{ 0, 0, 0, 0, 2 }, { 0, 2, 0, 2, 0 }, { 0, 0, 7, 0, 0 }, { 1, 1, 2, 4, 4 },
+		{ 5, 1, 2, 4, 5 },
+	} };
+	// clang-format on
+
+	[[nodiscard]] Glyph glyph(char c) {
+		const auto upper { static_cast<char>(c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c) };
+		const std::size_t index { glyph_chars.find(upper) };
+		return index == std::string_view::npos ? Glyph {} : glyphs[index];
+	}
+} // namespace
+
+namespace frontend {
+	Overlay::Overlay(u32 scale) : m_scale { scale } {}
+
+	void Overlay::setText(const std::vector<std::string>& lines) {
+		std::size_t columns { 0 };
+		for (const auto& line : lines) {
+			columns = std::max(columns, line.size());
+		}
+
+		const u32 width { static_cast<u32>(columns) * advance - 1 + border * 2 };
+		const u32 height {
+			static_cast<u32>(lines.size()) * line_height - 1 + border * 2
+		};
+		m_pixels.assign(static_cast<std::size_t>(width) * height, backdrop_color);
+
+		for (std::size_t row { 0 }; row < lines.size(); ++row) {
+			for (std::size_t column { 0 }; column < lines[row].size(); ++column) {
+				const Glyph shape { glyph(lines[row][column]) };
+				const u32 left { border + static_cast<u32>(column) * advance };
+				const u32 top { border + static_cast<u32>(row) * line_height };
+				for (u32 y { 0 }; y < glyph_height; ++y) {
+					for (u32 x { 0 }; x < glyph_width; ++x) {
+						if (shape[y] & (4 >> x)) {
+							m_pixels[(top + y) * width + left + x] = text_color;
+						}
+					}
+				}
+			}
+		}
+
+		// The texture only grows, the sprite shows the part in use.
+		const sf::Vector2u size { m_texture.getSize() };
+		if (size.x < width || size.y < height) {
+			if (!m_texture.create(std::max(size.x, width), std::max(size.y, height))) {
+				m_pixels.clear();
+				return;
+			}
+		}
+		m_texture.update(
+			reinterpret_cast<const sf::Uint8 *>(m_pixels.data()), width, height, 0, 0
+		);
+		m_sprite.setTexture(m_texture);
+		m_sprite.setTextureRect(
+			{ 0, 0, static_cast<int>(width), static_cast<int>(height) }
+		);
+		m_sprite.setScale(static_cast<float>(m_scale), static_cast<float>(m_scale));
+	}
+
+	void Overlay::draw(sf::RenderTarget& target) const {
+		if (!m_pixels.empty()) {
+			target.draw(m_sprite);
+		}
+	}
+} // namespace frontend
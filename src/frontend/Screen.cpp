@@ -0,0 +1,74 @@
+#include "frontend/Screen.hpp"
+
+#include <stdexcept>
+
+namespace frontend {
+	Screen::Screen(video::Scaler scaler, u32 factor, u32 ntsc_threads)
+		: m_scaler(scaler)
+		, m_factor(factor)
+		, m_width(
+			  ntsc_threads > 0 ? video::ntscWidth(PPU_SCREEN_WIDTH) * factor / 2
+			                   : video::scaledSize(scaler, PPU_SCREEN_WIDTH, factor)
+		  )
+		, m_height(
+			  ntsc_threads > 0 ? PPU_SCREEN_HEIGHT * factor
+			                   : video::scaledSize(scaler, PPU_SCREEN_HEIGHT, factor)
+		  ) {
+		u32 texture_width { m_width };
+		u32 texture_height { m_height };
+		if (ntsc_threads > 0) {
+			m_ntsc = std::make_unique<video::NtscFilter>(PPU_SCREEN_WIDTH, ntsc_threads);
+			texture_width = video::ntscWidth(PPU_SCREEN_WIDTH);
+			texture_height = PPU_SCREEN_HEIGHT;
+		} else if (m_scaler != video::Scaler::INTEGER || m_factor != 1) {
+			m_rgba.resize(PPU_SCREEN_WIDTH * PPU_SCREEN_HEIGHT);
+		}
+		m_pixels.resize(static_cast<std::size_t>(texture_width) * texture_height);
+
+		if (!m_texture.create(texture_width, texture_height)) {
+			throw std::runtime_error("Cannot create the screen texture!");
+		}
+		m_sprite.setTexture(m_texture, true);
+
+		if (m_ntsc) {
+			m_texture.setSmooth(true);
+			m_sprite.setScale(
+				static_cast<float>(m_width) / static_cast<float>(texture_width),
+				static_cast<float>(m_height) / static_cast<float>(texture_height)
+			);
+		}
+	}
+
+	void Screen::update(const nes::Bus& bus) {
+		const u8 *indices { bus.getFramebuffer().data() };
+		const u8 *emphasis { bus.getEmphasis().data() };
+
+		if (m_ntsc) {
+			// Frames alternate between two subcarrier phases, as on the console.
+			const auto phase { static_cast<u8>(bus.getFrame() & 1) };
+			m_ntsc->apply(
+				indices, emphasis, PPU_SCREEN_HEIGHT, phase, m_pixels.data()
+			);
+		} else {
+			// Without scaling the conversion goes straight into the upload buffer.
+			video::Rgba *converted { m_rgba.empty() ? m_pixels.data() : m_rgba.data() };
+
+			video::convert(
+				indices, emphasis, PPU_SCREEN_WIDTH, PPU_SCREEN_HEIGHT, m_palette,
+				converted
+			);
+			if (!m_rgba.empty()) {
+				video::scale(
+					m_scaler, m_rgba.data(), PPU_SCREEN_WIDTH, PPU_SCREEN_HEIGHT,
+					m_factor, m_pixels.data()
+				);
+			}
+		}
+
+		m_texture.update(reinterpret_cast<const sf::Uint8 *>(m_pixels.data()));
+	}
+
+	void Screen::draw(sf::RenderTarget& target) const {
+		target.draw(m_sprite);
+	}
+} // namespace frontend
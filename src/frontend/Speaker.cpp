@@ -0,0 +1,22 @@
+#include "frontend/Speaker.hpp"
+
+#include <algorithm>
+
+namespace frontend {
+	Speaker::Speaker(audio::Ring& ring, u32 rate) : m_ring { ring } {
+		initialize(1, rate);
+	}
+
+	Speaker::~Speaker() {
+		stop();
+	}
+
+	bool Speaker::onGetData(Chunk& chunk) {
+		const std::size_t count { m_ring.pop(m_chunk.data(), m_chunk.size()) };
+		std::fill(m_chunk.begin() + count, m_chunk.end(), 0);
+
+		chunk.samples = m_chunk.data();
+		chunk.sampleCount = m_chunk.size();
+		return true;
+	}
+} // namespace frontend
@@ -0,0 +1,174 @@
+#include "frontend/Window.hpp"
+
+#include "audio/Resampler.hpp"
+#include "audio/Ring.hpp"
+#include "frontend/FramePacer.hpp"
+#include "frontend/FrameStats.hpp"
+#include "frontend/Overlay.hpp"
+#include "frontend/Screen.hpp"
+#include "frontend/Speaker.hpp"
+#include "nes/RunAhead.hpp"
+
+#include <SFML/Window.hpp>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+	constexpr u32 audio_rate { 48000 };
+	// About 85 ms, the rate control keeps it half full.
+	constexpr std::size_t audio_buffer { 4096 };
+
+	// The overlay shows the last 10 seconds, refreshed twice a second.
+	constexpr std::size_t stats_frames { 600 };
+	constexpr u64 stats_refresh { 30 };
+
+	// clang-format off
+	const std::array<std::pair<sf::Keyboard::Key, nes::Button>, 8> key_map { {
+		{ sf::Keyboard::X, nes::BUTTON_A },
+		{ sf::Keyboard::Z, nes::BUTTON_B },
+		{ sf::Keyboard::RShift, nes::BUTTON_SELECT },
+		{ sf::Keyboard::Enter, nes::BUTTON_START },
+		{ sf::Keyboard::Up, nes::BUTTON_UP },
+		{ sf::Keyboard::Down, nes::BUTTON_DOWN },
+		{ sf::Keyboard::Left, nes::BUTTON_LEFT },
+		{ sf::Keyboard::Right, nes::BUTTON_RIGHT },
+	} };
+	// clang-format on
+
+	[[nodiscard]] u8 readKeyboard() {
+		u8 buttons { 0 };
+		for (const auto& [key, button] : key_map) {
+			if (sf::Keyboard::isKeyPressed(key)) {
+				buttons |= button;
+			}
+		}
+		return buttons;
+	}
+
+	[[nodiscard]] const char *syncName(frontend::Sync sync) {
+		switch (sync) {
+		case frontend::Sync::CLOCK:
+			return "clock";
+		case frontend::Sync::DISPLAY:
+			return "display";
+		case frontend::Sync::AUDIO:
+			return "audio";
+		}
+		return "";
+	}
+
+	[[nodiscard]] std::vector<std::string> statsText(
+		const frontend::FrameStats::Summary& summary, frontend::Sync sync
+	) {
+		return {
+			fmt::format("sync {} - {} frames", syncName(sync), summary.frames),
+			fmt::format(
+				"frame p50 {:.2f} p99 {:.2f} ms", summary.frame_p50, summary.frame_p99
+			),
+			fmt::format(
+				"input p50 {:.2f} p99 {:.2f} ms", summary.latency_p50, summary.latency_p99
+			),
+		};
+	}
+} // namespace
+
+namespace frontend {
+	void runWindow(nes::Bus& bus, const WindowOptions& options) {
+		Screen screen { options.scaler, options.factor, options.ntsc_threads };
+
+		sf::RenderWindow window {
+			sf::VideoMode { screen.getWidth(), screen.getHeight() }, "nes",
+			sf::Style::Titlebar | sf::Style::Close
+		};
+		window.setVerticalSyncEnabled(options.sync == Sync::DISPLAY);
+
+		audio::Ring ring { audio_buffer };
+		audio::Resampler resampler { NES_CPU_HZ, audio_rate };
+		Speaker speaker { ring, audio_rate };
+		std::vector<float> apu_output {};
+		std::vector<s16> samples {};
+		speaker.play();
+
+		nes::RunAhead run_ahead { bus, options.run_ahead };
+		FramePacer pacer {};
+		// One more frame for the frame time of the oldest one shown.
+		FrameStats stats { stats_frames + 1 };
+		if (!options.stats_path.empty() && !stats.openCsv(options.stats_path)) {
+			spdlog::error("Cannot write the frame statistics to {}!", options.stats_path);
+		}
+		// Deferred drawing presents each picture one frame later, except run-ahead
+		// frames which are waited for.
+		const bool deferred { bus.getRenderer() != nullptr && options.run_ahead == 0 };
+		stats.setPictureLag(deferred ? 1 : 0);
+		Overlay overlay { options.factor };
+		bool show_overlay { options.overlay };
+
+		while (window.isOpen()) {
+			// Following the audio device, frames get longer while its buffer fills
+			// up and the resampler keeps a fixed rate.
+			if (options.sync == Sync::AUDIO) {
+				pacer.setRateAdjust(
+					audio::Resampler::dynamicRate(ring.size(), ring.capacity())
+				);
+			}
+			if (options.sync != Sync::DISPLAY) {
+				pacer.wait();
+			}
+
+			// Input is polled as late as possible, right before the frame runs.
+			stats.markInput();
+			sf::Event event {};
+			while (window.pollEvent(event)) {
+				if (event.type == sf::Event::Closed) {
+					window.close();
+				} else if (event.type == sf::Event::KeyPressed
+				           && event.key.code == sf::Keyboard::F3) {
+					show_overlay = !show_overlay;
+				}
+			}
+
+			bus.setController(0, window.hasFocus() ? readKeyboard() : 0);
+			run_ahead.runFrame([&screen](nes::Bus& presented) {
+				screen.update(presented);
+			});
+			stats.markEmulated();
+
+			// No APU yet: it outputs silence, one sample per CPU cycle of the frame.
+			const u64 frame { bus.getFrame() };
+			apu_output.assign(
+				frame * NES_FRAME_DOTS / NES_CPU_DIVIDER
+					- (frame - 1) * NES_FRAME_DOTS / NES_CPU_DIVIDER,
+				0.0f
+			);
+			resampler.setRateAdjust(
+				options.sync == Sync::AUDIO
+					? 0.0
+					: audio::Resampler::dynamicRate(ring.size(), ring.capacity())
+			);
+			samples.clear();
+			resampler.process(apu_output.data(), apu_output.size(), samples);
+			ring.push(samples.data(), samples.size());
+
+			if (frame % stats_refresh == 0) {
+				overlay.setText(statsText(stats.summarize(stats_frames), options.sync));
+			}
+
+			window.clear();
+			screen.draw(window);
+			if (show_overlay) {
+				overlay.draw(window);
+			}
+			window.display();
+			stats.markPresented();
+		}
+
+		if (!options.stats_path.empty() && !stats.closeCsv()) {
+			spdlog::error("Cannot write the frame statistics to {}!", options.stats_path);
+		}
+	}
+} // namespace frontend
@@ -0,0 +1,167 @@
+#include "libnes/nes.h"
+
+#include "nes/Bus.hpp"
+#include "nes/Cartridge.hpp"
+
+#include <exception>
+#include <string>
+#include <vector>
+
+static_assert(NES_SCREEN_WIDTH == PPU_SCREEN_WIDTH);
+static_assert(NES_SCREEN_HEIGHT == PPU_SCREEN_HEIGHT);
+static_assert(static_cast<u8>(NES_BUTTON_RIGHT) == nes::BUTTON_RIGHT);
+
+struct nes_console {
+	explicit nes_console(nes::Accuracy accuracy) : bus { accuracy } {}
+
+	nes::Bus bus;
+	bool loaded { false };
+	std::vector<s16> audio {};
+	std::string error {};
+};
+
+// Exceptions must not cross the C boundary: they become the last error.
+extern "C" {
+	uint32_t nes_api_version(void) {
+		return NES_API_VERSION;
+	}
+
+	nes_console *nes_create(nes_accuracy accuracy) {
+		const auto level {
+			accuracy == NES_ACCURACY_CYCLE ? nes::Accuracy::CYCLE : nes::Accuracy::FAST
+		};
+		try {
+			return new nes_console { level };
+		} catch (const std::exception&) {
+			// No console to hold the error.
+			return nullptr;
+		}
+	}
+
+	void nes_destroy(nes_console *console) {
+		delete console;
+	}
+
+	int nes_load_rom(nes_console *console, const uint8_t *data, size_t size) {
+		console->error.clear();
+		try {
+			auto cartridge { nes::Cartridge::loadMemory(data, size) };
+			if (!cartridge) {
+				console->error = "Invalid iNES image!";
+				return -1;
+			}
+
+			console->bus.insert(std::move(*cartridge));
+			console->bus.power();
+			console->loaded = true;
+		} catch (const std::exception& e) {
+			console->error = e.what();
+			console->loaded = false;
+			return -1;
+		}
+
+		return 0;
+	}
+
+	int nes_map_save_ram(nes_console *console, const char *path, uint32_t sync_frames) {
+		console->error.clear();
+		if (!console->loaded) {
+			console->error = "No ROM loaded!";
+			return -1;
+		}
+
+		try {
+			const u32 frames { sync_frames != 0 ? sync_frames : SAVE_RAM_SYNC_FRAMES };
+			if (!console->bus.mapSaveRam(path, frames)) {
+				console->error = "Cannot map the save file!";
+				return -1;
+			}
+		} catch (const std::exception& e) {
+			console->error = e.what();
+			return -1;
+		}
+
+		return 0;
+	}
+
+	int nes_reset(nes_console *console) {
+		console->error.clear();
+		if (!console->loaded) {
+			return 0;
+		}
+
+		try {
+			console->bus.reset();
+		} catch (const std::exception& e) {
+			console->error = e.what();
+			return -1;
+		}
+
+		return 0;
+	}
+
+	int nes_run_frame(nes_console *console, int draw) {
+		if (!console->loaded) {
+			console->error = "No ROM loaded!";
+			return -1;
+		}
+
+		try {
+			console->bus.runFrame(draw != 0);
+		} catch (const std::exception& e) {
+			console->error = e.what();
+			return -1;
+		}
+
+		return 0;
+	}
+
+	void nes_set_controller(nes_console *console, unsigned port, uint8_t buttons) {
+		if (port < 2) {
+			console->bus.setController(static_cast<u8>(port), buttons);
+		}
+	}
+
+	const uint8_t *nes_framebuffer(const nes_console *console) {
+		return console->bus.getFramebuffer().data();
+	}
+
+	const uint8_t *nes_emphasis(const nes_console *console) {
+		return console->bus.getEmphasis().data();
+	}
+
+	const int16_t *nes_audio(const nes_console *console, size_t *count) {
+		*count = console->audio.size();
+		return console->audio.data();
+	}
+
+	uint8_t *nes_ram(nes_console *console, size_t *size) {
+		*size = NES_RAM_SIZE;
+		return console->bus.getRam().data();
+	}
+
+	uint64_t nes_frame(const nes_console *console) {
+		return console->bus.getFrame();
+	}
+
+	uint64_t nes_hash_state(const nes_console *console) {
+		if (!console->loaded) {
+			return 0;
+		}
+
+		return console->bus.hashState();
+	}
+
+	size_t nes_memory_usage(const nes_console *console, size_t *shared) {
+		if (shared != nullptr) {
+			*shared = console->bus.sharedBytes();
+		}
+
+		return console->bus.privateBytes() - sizeof(nes::Bus) + sizeof(nes_console)
+		     + console->audio.capacity() * sizeof(s16) + console->error.capacity();
+	}
+
+	const char *nes_last_error(const nes_console *console) {
+		return console->error.c_str();
+	}
+}
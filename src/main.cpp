@@ -1,15 +1,34 @@
+#include "capture/WavWriter.hpp"
+#include "capture/Y4mWriter.hpp"
+#include "common/Diag.hpp"
+#include "frontend/FramePacer.hpp"
+#include "frontend/Window.hpp"
 #include "nes/Bus.hpp"
+#include "nes/FrameSkip.hpp"
+#include "nes/HashLog.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <cstdlib>
+#include <filesystem>
 #include <iostream>
 #include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+	// Rate of the captured audio track.
+	constexpr u32 capture_audio_rate { 48000 };
+} // namespace
 
 namespace nes {
 	void runDebug(Bus& bus) {
 		auto& cpu { bus.getCPU() };
 		cpu.setPC(0x8000);
 
-		u32 current_clock {};
+		u64 current_clock {};
 		while (current_clock % 3 != 0 || std::cin.get() != 'x') {
 			do {
 				current_clock = bus.clock();
@@ -20,28 +39,247 @@ namespace nes {
 			}
 		}
 	}
+
+	// Run a fixed number of frames without any interaction, optionally streaming
+	// the state hash of every frame to `hash_path` and capturing to the open
+	// writers. With a `turbo` multiplier the run is paced to that many times real
+	// time.
+	void runHeadless(
+		Bus& bus, u64 frames, std::string_view hash_path, FrameSkip& frame_skip,
+		double turbo, capture::Y4mWriter& video, capture::WavWriter& audio
+	) {
+		HashLog log {};
+		if (!hash_path.empty() && !log.open(hash_path)) {
+			throw std::runtime_error("Cannot open hash log file!");
+		}
+
+		std::chrono::nanoseconds hash_time {};
+		const auto start { std::chrono::steady_clock::now() };
+		frontend::FramePacer pacer { std::chrono::nanoseconds {
+			turbo > 0.0 ? static_cast<s64>(NES_FRAME_NS / turbo) : 0
+		} };
+		u64 drawn { 0 };
+
+		for (u64 frame { 0 }; frame < frames; ++frame) {
+			const auto frame_start { std::chrono::steady_clock::now() };
+
+			const bool draw { frame_skip.nextFrame() };
+			bus.runFrame(draw);
+			drawn += draw ? 1 : 0;
+
+			if (!hash_path.empty()) {
+				const auto hash_start { std::chrono::steady_clock::now() };
+				log.append(bus.hashState());
+				hash_time += std::chrono::steady_clock::now() - hash_start;
+			}
+
+			if (video.isOpen()) {
+				video.writeFrame(bus.getFramebuffer().data(), bus.getEmphasis().data());
+			}
+			if (audio.isOpen()) {
+				// No APU yet: a silent track of the exact length keeps muxing in sync.
+				const u64 samples {
+					(frame + 1) * audio.getRate() * NES_FRAME_NS / 1'000'000'000
+				};
+				audio.writeSilence(samples - audio.getSamples());
+			}
+
+			frame_skip.frameTime(std::chrono::steady_clock::now() - frame_start);
+			if (turbo > 0.0) {
+				pacer.wait();
+			}
+		}
+
+		const std::chrono::duration<double> elapsed {
+			std::chrono::steady_clock::now() - start
+		};
+		spdlog::info(
+			"Ran {} frames in {:.3f}s ({:.1f} fps, {} accuracy, {} drawn), hashing took "
+			"{:.3f}% of it.",
+			frames, elapsed.count(), static_cast<double>(frames) / elapsed.count(),
+			accuracyName(bus.getAccuracy()), drawn,
+			100.0 * std::chrono::duration<double>(hash_time).count() / elapsed.count()
+		);
+
+		if (video.isOpen() || audio.isOpen()) {
+			const u64 bytes {
+				video.getStream().getBytes() + audio.getStream().getBytes()
+			};
+			const std::chrono::duration<double> stalled {
+				video.getStream().getStallTime() + audio.getStream().getStallTime()
+			};
+			video.close();
+			audio.close();
+
+			spdlog::info(
+				"Captured {} frames ({} unchanged) and {} samples, {:.1f} MB, waited "
+				"{:.3f}s on the writers.",
+				video.getFrames(), video.getRepeated(), audio.getSamples(),
+				static_cast<double>(bytes) / 1e6, stalled.count()
+			);
+			if (video.getStream().failed() || audio.getStream().failed()) {
+				throw std::runtime_error("Capture output failed!");
+			}
+		}
+	}
 } // namespace nes
 
 int main(int argc, char *argv[]) {
 	spdlog::set_pattern("%X %^[%L]%$ | %v");
 
-	if (argc != 2) {
-		spdlog::error("Usage: {} <rom>", argv[0]);
+	std::string_view rom_path {};
+	std::string_view hash_path {};
+	u64 frames {};
+	auto accuracy { nes::Accuracy::CYCLE };
+	u32 frame_skip { 1 };
+	u32 render_threads { 0 };
+	double turbo {};
+	std::string_view video_path {};
+	std::string_view audio_path {};
+	std::string_view save_path {};
+	bool skip_unchanged { false };
+	bool window { false };
+	frontend::WindowOptions window_options {};
+
+	for (int i { 1 }; i < argc; ++i) {
+		const std::string_view arg { argv[i] };
+
+		if (arg == "--hash-log" && i + 1 < argc) {
+			hash_path = argv[++i];
+		} else if (arg == "--frames" && i + 1 < argc) {
+			frames = std::strtoull(argv[++i], nullptr, 10);
+		} else if (arg == "--frame-skip" && i + 1 < argc) {
+			frame_skip = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--render-threads" && i + 1 < argc) {
+			render_threads = std::strtoul(argv[++i], nullptr, 10);
+		} else if (arg == "--turbo" && i + 1 < argc) {
+			turbo = std::strtod(argv[++i], nullptr);
+		} else if (arg == "--video" && i + 1 < argc) {
+			video_path = argv[++i];
+		} else if (arg == "--audio" && i + 1 < argc) {
+			audio_path = argv[++i];
+		} else if (arg == "--save" && i + 1 < argc) {
+			save_path = argv[++i];
+		} else if (arg == "--skip-unchanged") {
+			skip_unchanged = true;
+		} else if (arg == "--window") {
+			window = true;
+		} else if (arg == "--scale" && i + 1 < argc) {
+			const u32 factor { static_cast<u32>(std::strtoul(argv[++i], nullptr, 10)) };
+			window_options.factor = std::max<u32>(factor, 1);
+		} else if (arg == "--scaler" && i + 1 < argc) {
+			const std::string_view scaler { argv[++i] };
+			if (scaler != "integer" && scaler != "scale2x") {
+				rom_path = {};
+				break;
+			}
+			window_options.scaler =
+				scaler == "scale2x" ? video::Scaler::SCALE2X : video::Scaler::INTEGER;
+		} else if (arg == "--ntsc") {
+			// One thread keeps up on its own, more only when asked for.
+			window_options.ntsc_threads = 1;
+			const std::string_view next { i + 1 < argc ? argv[i + 1] : "" };
+			if (!next.empty() && std::isdigit(static_cast<unsigned char>(next[0]))) {
+				const auto threads { std::strtoul(argv[++i], nullptr, 10) };
+				window_options.ntsc_threads = std::max<u32>(static_cast<u32>(threads), 1);
+			}
+		} else if (arg == "--sync" && i + 1 < argc) {
+			const std::string_view sync { argv[++i] };
+			if (sync == "clock") {
+				window_options.sync = frontend::Sync::CLOCK;
+			} else if (sync == "display") {
+				window_options.sync = frontend::Sync::DISPLAY;
+			} else if (sync == "audio") {
+				window_options.sync = frontend::Sync::AUDIO;
+			} else {
+				rom_path = {};
+				break;
+			}
+		} else if (arg == "--run-ahead" && i + 1 < argc) {
+			const auto ahead { std::strtoul(argv[++i], nullptr, 10) };
+			window_options.run_ahead =
+				static_cast<u8>(std::min<unsigned long>(ahead, 0xff));
+		} else if (arg == "--overlay") {
+			window_options.overlay = true;
+		} else if (arg == "--stats" && i + 1 < argc) {
+			window_options.stats_path = argv[++i];
+		} else if (arg == "--accuracy" && i + 1 < argc) {
+			const std::string_view level { argv[++i] };
+			if (level != "fast" && level != "cycle") {
+				rom_path = {};
+				break;
+			}
+			accuracy = level == "fast" ? nes::Accuracy::FAST : nes::Accuracy::CYCLE;
+		} else if (rom_path.empty()) {
+			rom_path = arg;
+		} else {
+			rom_path = {};
+			break;
+		}
+	}
+
+	if (rom_path.empty()) {
+		spdlog::error(
+			"Usage: {} <rom> [--frames <n>] [--hash-log <file>] [--accuracy fast|cycle] "
+			"[--frame-skip <n>] [--render-threads <n>] [--turbo <multiplier>] "
+			"[--video <file|'|command'> [--skip-unchanged]] [--audio <file|'|command'>] "
+			"[--window [--scale <n>] [--scaler integer|scale2x] [--ntsc [threads]] "
+			"[--sync clock|display|audio] [--run-ahead <n>] [--overlay] "
+			"[--stats <file.csv>]] "
+			"[--save <file.sav>]",
+			argv[0]
+		);
 		return EXIT_FAILURE;
 	}
 
 	try {
-		auto bus { nes::Bus() };
-		auto cartridge { nes::Cartridge::loadFile(argv[1]) };
+		auto bus { nes::Bus(accuracy) };
+		auto cartridge { nes::Cartridge::loadFile(rom_path) };
 		bus.insert(cartridge.value());
+
+		// Battery saves go next to the ROM unless told otherwise.
+		if (bus.hasBattery() || !save_path.empty()) {
+			const std::string path { save_path.empty()
+				? std::filesystem::path { rom_path }.replace_extension(".sav").string()
+				: std::string { save_path } };
+			if (!bus.mapSaveRam(path)) {
+				throw std::runtime_error("Cannot map the save file!");
+			}
+		}
 		bus.power();
+		bus.setRenderThreads(render_threads);
 
 		// TODO: Create engine.
-		nes::runDebug(bus);
+		if (window) {
+			frontend::runWindow(bus, window_options);
+		} else if (frames > 0) {
+			nes::FrameSkip skip { frame_skip };
+			skip.setTarget(turbo);
+
+			capture::Y4mWriter video {};
+			if (!video_path.empty()) {
+				const bool opened { video.open(
+					video_path, PPU_SCREEN_WIDTH, PPU_SCREEN_HEIGHT, skip_unchanged
+				) };
+				if (!opened) {
+					throw std::runtime_error("Cannot open the video output!");
+				}
+			}
+			capture::WavWriter audio {};
+			if (!audio_path.empty() && !audio.open(audio_path, capture_audio_rate)) {
+				throw std::runtime_error("Cannot open the audio output!");
+			}
+
+			nes::runHeadless(bus, frames, hash_path, skip, turbo, video, audio);
+		} else {
+			nes::runDebug(bus);
+		}
 	} catch (const std::exception& e) {
+		diag::flush();
 		spdlog::error("{}", e.what());
 		return EXIT_FAILURE;
 	}
 
+	diag::report();
 	return EXIT_SUCCESS;
 }
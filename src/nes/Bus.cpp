@@ -1,80 +1,484 @@
 #include "nes/Bus.hpp"
 
+#include "common/Hash.hpp"
+
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 #include <utility>
 
 namespace nes {
+	Bus::Bus(Accuracy accuracy)
+		: m_accuracy(accuracy)
+		, m_cpu(m_state.cpu, accuracy)
+		, m_ppu(m_state.ppu) {}
+
 	void Bus::insert(Cartridge cartridge) {
-		m_mapper = Mapper::create(std::move(cartridge));
+		// The frame being drawn may read the previous cartridge image.
+		if (m_renderer) {
+			m_renderer->finish();
+			m_renderer->getLog().abort();
+		}
+
+		// The previous board flushes its save file from the state block before the
+		// new one clears it.
+		m_mapper.reset();
+		m_mapper = Mapper::create(std::move(cartridge), m_state.mapper);
 		if (m_mapper == nullptr) {
 			throw std::runtime_error("No supported cartridge!");
 		}
+		m_mapper->connectNametables(m_state.vram.data());
+	}
+
+	void Bus::setRenderThreads(u32 threads) {
+		m_ppu.setLog(nullptr);
+		m_renderer.reset();
+		if (threads == 0) {
+			return;
+		}
+
+		m_renderer = std::make_unique<FrameRenderer>(threads);
+		m_renderer->connect(
+			m_state.vram.data(), m_state.mapper.chr_ram.data(),
+			m_state.ppu.palette.data(), m_state.ppu.oam.data()
+		);
+		m_ppu.setLog(&m_renderer->getLog());
+	}
+
+	void Bus::finishDrawing() {
+		if (m_renderer) {
+			m_renderer->finish();
+		}
 	}
 
 	void Bus::power() {
 		m_cpu.connectBus(this);
+		m_ppu.connectBus(this);
 
 		reset();
 	}
 
 	void Bus::reset() {
 		m_cpu.reset();
+		m_ppu.reset();
 
-		m_clock = 0;
+		m_state.clock = 0;
+		m_state.frame = 0;
+
+		m_state.controller_shift = {};
+		m_state.controller_strobe = false;
+		m_state.open_bus = 0x00;
+
+		// Every event is rescheduled from the time it fired, relative to frame 0.
+		m_state.scheduler.clear();
+		m_state.scheduler.schedule(
+			Event::VBLANK_START, PPU_VBLANK_SCANLINE * PPU_DOTS_PER_SCANLINE + 1
+		);
+		m_state.scheduler.schedule(
+			Event::VBLANK_END, PPU_PRERENDER_SCANLINE * PPU_DOTS_PER_SCANLINE + 1
+		);
+		m_state.scheduler.schedule(Event::RENDER_LINE, 0);
+		m_state.scheduler.schedule(Event::HBLANK, PPU_HBLANK_DOT);
+		if (m_mapper->countsScanlines()) {
+			// MMC3 sees the sprite pattern fetches around dot 260.
+			m_state.scheduler.schedule(Event::SCANLINE, 260);
+		}
+
+		// The frame counter powers up in 4-step mode with its IRQ enabled.
+		m_state.apu_frame_irq = false;
+		writeApuFrameCounter(0x00);
 	}
 
-	u32 Bus::clock() {
-		if (m_clock % 3 == 0) {
+	u64 Bus::clock() {
+		if (m_state.clock % NES_CPU_DIVIDER == 0) {
 			m_cpu.clock();
 		}
 
-		m_clock += 1;
-		return m_clock;
+		m_state.clock += 1;
+		dispatchEvents();
+		return m_state.clock;
+	}
+
+	void Bus::run(u64 until) {
+		while (m_state.clock < until) {
+			const u64 deadline { std::min(until, m_state.scheduler.next()) };
+			if (m_state.clock < deadline) {
+				const u64 cycles {
+					(deadline - m_state.clock + NES_CPU_DIVIDER - 1) / NES_CPU_DIVIDER
+				};
+				m_batch_cycles = m_cpu.getCycleCount();
+				m_in_batch = true;
+				const u32 ran { m_cpu.run(cycles) };
+				m_in_batch = false;
+				m_state.clock += static_cast<u64>(ran) * NES_CPU_DIVIDER;
+			}
+
+			dispatchEvents(until);
+		}
+	}
+
+	void Bus::runFrame(bool draw) {
+		m_ppu.setDrawing(draw);
+		run((m_state.frame + 1) * NES_FRAME_DOTS);
+		m_state.frame += 1;
+
+		if (m_save_sync_frames != 0 && !m_speculative
+		    && m_state.frame % m_save_sync_frames == 0) {
+			m_mapper->syncSaveRam(false);
+		}
+	}
+
+	bool Bus::mapSaveRam(std::string_view path, u32 sync_frames) {
+		if (!m_mapper->mapSaveRam(path)) {
+			return false;
+		}
+
+		m_save_sync_frames = std::max<u32>(sync_frames, 1);
+		return true;
+	}
+
+	void Bus::syncSaveRam() {
+		m_mapper->syncSaveRam(true);
+	}
+
+	bool Bus::hasBattery() const {
+		return m_mapper->hasBattery();
+	}
+
+	std::size_t Bus::privateBytes() const {
+		return sizeof(Bus) + (m_mapper ? m_mapper->privateBytes() : 0)
+		     + (m_renderer ? sizeof(FrameRenderer) : 0);
+	}
+
+	std::size_t Bus::sharedBytes() const {
+		return m_mapper ? m_mapper->sharedBytes() : 0;
+	}
+
+	void Bus::dispatchEvents(u64 until) {
+		const u64 due { std::min(m_state.clock, until - 1) };
+
+		Event event {};
+		u64 time {};
+		while (m_state.scheduler.pop(due, event, time)) {
+			switch (event) {
+			case Event::VBLANK_START:
+				if (m_renderer) {
+					m_renderer->endFrame();
+					m_ppu.setLog(&m_renderer->getLog());
+				}
+				m_ppu.startVblank();
+				if (m_ppu.pollNmi()) {
+					m_cpu.requestNmi();
+				}
+				m_state.scheduler.schedule(Event::VBLANK_START, time + NES_FRAME_DOTS);
+				break;
+			case Event::VBLANK_END:
+				m_ppu.endVblank();
+				m_state.scheduler.schedule(Event::VBLANK_END, time + NES_FRAME_DOTS);
+				break;
+			case Event::RENDER_LINE: {
+				const u64 start { time - time % PPU_DOTS_PER_SCANLINE };
+				const u16 line = (time % NES_FRAME_DOTS) / PPU_DOTS_PER_SCANLINE;
+
+				const auto timing { m_ppu.renderLine(line) };
+				if (timing.sprite0_hit != PPU::LineTiming::NONE) {
+					m_state.scheduler.schedule(
+						Event::SPRITE0_HIT, start + timing.sprite0_hit
+					);
+				}
+				if (timing.sprite_overflow != PPU::LineTiming::NONE) {
+					m_state.scheduler.schedule(
+						Event::SPRITE_OVERFLOW, start + timing.sprite_overflow
+					);
+				}
+
+				// Lines 0-239, then line 0 of the next frame.
+				u64 next { PPU_DOTS_PER_SCANLINE };
+				if (line == PPU_VISIBLE_SCANLINES - 1) {
+					next = (PPU_SCANLINES - line) * PPU_DOTS_PER_SCANLINE;
+				}
+				m_state.scheduler.schedule(Event::RENDER_LINE, time + next);
+				break;
+			}
+			case Event::HBLANK: {
+				const u16 line = (time % NES_FRAME_DOTS) / PPU_DOTS_PER_SCANLINE;
+				m_ppu.endLine(line);
+
+				// Lines 0-239 and the pre-render line.
+				u64 next { PPU_DOTS_PER_SCANLINE };
+				if (line == PPU_VISIBLE_SCANLINES - 1) {
+					next = (PPU_PRERENDER_SCANLINE - line) * PPU_DOTS_PER_SCANLINE;
+				}
+				m_state.scheduler.schedule(Event::HBLANK, time + next);
+				break;
+			}
+			case Event::SPRITE0_HIT:
+				m_ppu.setSprite0Hit();
+				break;
+			case Event::SPRITE_OVERFLOW:
+				m_ppu.setSpriteOverflow();
+				break;
+			case Event::SCANLINE: {
+				if (m_ppu.renderingEnabled()) {
+					m_mapper->scanline();
+					m_cpu.setIrq(CPU::IRQ_MAPPER, m_mapper->irqPending());
+				}
+
+				// Visible scanlines 0-239 and the pre-render scanline.
+				const u64 line { (time % NES_FRAME_DOTS) / PPU_DOTS_PER_SCANLINE };
+				u64 next { PPU_DOTS_PER_SCANLINE };
+				if (line == PPU_VISIBLE_SCANLINES - 1) {
+					next = (PPU_PRERENDER_SCANLINE - line) * PPU_DOTS_PER_SCANLINE;
+				}
+				m_state.scheduler.schedule(Event::SCANLINE, time + next);
+				break;
+			}
+			case Event::APU_FRAME:
+				m_state.apu_frame_irq = true;
+				m_cpu.setIrq(CPU::IRQ_APU_FRAME, true);
+				m_state.scheduler.schedule(
+					Event::APU_FRAME, time + NES_APU_FRAME_CYCLES * NES_CPU_DIVIDER
+				);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	u64 Bus::hashState() const {
+		u64 seed { m_cpu.hashState(0) };
+		seed = m_ppu.hashState(seed);
+		seed = hash::xxh64(m_state.ram.data(), m_state.ram.size(), seed);
+		seed = hash::xxh64(m_state.vram.data(), m_state.vram.size(), seed);
+		seed = m_state.scheduler.hashState(seed);
+
+		// Field by field, the state block has padding.
+		const std::array<u8, 14> latches {
+			m_state.open_bus,
+			m_state.apu_frame_mode,
+			m_state.apu_frame_irq,
+			m_state.controller_shift[0],
+			m_state.controller_shift[1],
+			m_state.controller_strobe,
+			static_cast<u8>(m_state.frame),
+			static_cast<u8>(m_state.frame >> 8),
+			static_cast<u8>(m_state.frame >> 16),
+			static_cast<u8>(m_state.frame >> 24),
+			static_cast<u8>(m_state.frame >> 32),
+			static_cast<u8>(m_state.frame >> 40),
+			static_cast<u8>(m_state.frame >> 48),
+			static_cast<u8>(m_state.frame >> 56),
+		};
+		seed = hash::xxh64(latches.data(), latches.size(), seed);
+
+		// Without a cartridge there is no board state to add.
+		return m_mapper ? m_mapper->hashState(seed) : seed;
+	}
+
+	u64 Bus::hashProgress() const {
+		u64 seed { m_cpu.hashState(0) };
+		seed = m_ppu.hashState(seed);
+		seed = hash::xxh64(m_state.ram.data(), m_state.ram.size(), seed);
+
+		const auto& prg_ram { m_state.mapper.prg_ram };
+		return hash::xxh64(prg_ram.data(), prg_ram.size(), seed);
+	}
+
+	void Bus::saveState(State& snapshot) const {
+		snapshot = m_state;
+	}
+
+	void Bus::loadState(const State& snapshot) {
+		m_mapper->markPrgRamChanges(snapshot.mapper);
+		m_state = snapshot;
+		m_mapper->loadState();
+
+		// The frame being recorded mixes two timelines now.
+		if (m_renderer) {
+			m_renderer->getLog().abort();
+		}
+	}
+
+	void Bus::setController(u8 port, u8 buttons) {
+		m_controller.at(port & 0x01) = buttons;
+	}
+
+	u8 Bus::cpuRead(u16 addr, bool ro) {
+		if (m_accuracy == Accuracy::CYCLE) {
+			return cpuRead<accuracy::Cycle>(addr, ro);
+		}
+		return cpuRead<accuracy::Fast>(addr, ro);
+	}
+
+	void Bus::cpuWrite(u16 addr, u8 data) {
+		if (m_accuracy == Accuracy::CYCLE) {
+			cpuWrite<accuracy::Cycle>(addr, data);
+		} else {
+			cpuWrite<accuracy::Fast>(addr, data);
+		}
 	}
 
-	u8 Bus::cpuRead(u16 addr, bool /* ro */) const {
+	template<typename Policy>
+	u8 Bus::cpuRead(u16 addr, bool ro) {
 		u8 data { 0x00 };
 
 		if (addr >= 0x0000 && addr < 0x2000) {
 			// System RAM Address range, mirrorred every 2048
-			data = m_cpu_ram.at(addr & 0x07ff);
+			data = m_state.ram.at(addr & 0x07ff);
 		} else if (addr >= 0x2000 && addr < 0x4000) {
-			// TODO: Implement PPU!
+			// PPU registers, mirrored every 8
+			data = m_ppu.cpuRead(addr & 0x0007, ro);
+		} else if (addr == 0x4015) {
+			// APU status, only the frame IRQ flag so far. Reading acknowledges it.
+			data = m_state.apu_frame_irq ? 0x40 : 0x00;
+			if (!ro) {
+				m_state.apu_frame_irq = false;
+				m_cpu.setIrq(CPU::IRQ_APU_FRAME, false);
+			}
+		} else if (addr == 0x4016 || addr == 0x4017) {
+			// Controllers: serial read, one button per read, 1s after 8 reads.
+			auto& shift { m_state.controller_shift.at(addr & 0x01) };
+			if (m_state.controller_strobe) {
+				shift = m_controller.at(addr & 0x01);
+			}
+
+			// Upper bits are open bus, usually $40 from the address operand.
+			data = (Policy::open_bus ? (m_state.open_bus & 0xe0) : 0x40) | (shift & 0x01);
+			if (!ro && !m_state.controller_strobe) {
+				shift = (shift >> 1) | 0x80;
+			}
 		} else if (addr >= 0x4000 && addr < 0x4018) {
-			// TODO: Implement APU and Joysticks!
+			// TODO: Implement APU!
+			data = openBus<Policy>();
 		} else if (addr >= 0x4018 && addr < 0x4020) {
 			// APU and I/0 functionality
 			// But it's normally disabled
+			data = openBus<Policy>();
+		} else if (addr < 0x6000 && Policy::open_bus) {
+			// Expansion area, no supported board decodes it.
+			data = m_state.open_bus;
 		} else {
-			// Cartridge space: PRG ROM, PRG RAM, and mapper registers
-			data = m_mapper->cpuRead(addr);
+			// Cartridge space: PRG ROM, PRG RAM, and mapper registers.
+			// PRG ROM and RAM are read straight from the mapper.
+			if (addr >= 0x8000) {
+				data = m_mapper->readPrg(addr);
+			} else if (addr >= 0x6000) {
+				data = m_mapper->readPrgRam(addr);
+			} else {
+				data = m_mapper->cpuRead(addr);
+			}
 		}
 
+		if constexpr (Policy::open_bus) {
+			if (!ro) {
+				m_state.open_bus = data;
+			}
+		}
 		return data;
 	}
 
-	u16 Bus::cpuRead16(u16 addr, bool ro) const {
-		auto l { cpuRead(addr, ro) };
-		auto h { cpuRead(addr + 1, ro) };
+	template<typename Policy>
+	u16 Bus::cpuRead16(u16 addr, bool ro) {
+		auto l { cpuRead<Policy>(addr, ro) };
+		auto h { cpuRead<Policy>(addr + 1, ro) };
 
 		return (h << 8) | l;
 	}
 
+	template<typename Policy>
 	void Bus::cpuWrite(u16 addr, u8 data) {
+		if constexpr (Policy::open_bus) {
+			m_state.open_bus = data;
+		}
+
 		if (addr >= 0x0000 && addr < 0x2000) {
 			// PPU Address range, mirrored every 8
-			m_cpu_ram.at(addr & 0x07ff) = data;
+			m_state.ram.at(addr & 0x07ff) = data;
 		} else if (addr >= 0x2000 && addr < 0x4000) {
-			// TODO: Implement PPU!
+			// PPU registers, mirrored every 8
+			m_ppu.cpuWrite(addr & 0x0007, data);
+			if (m_ppu.pollNmi()) {
+				m_cpu.requestNmi();
+			}
+		} else if (addr == 0x4014) {
+			oamDma<Policy>(data);
+		} else if (addr == 0x4016) {
+			// Controllers: latch the buttons while strobe is high.
+			m_state.controller_strobe = data & 0x01;
+			if (m_state.controller_strobe) {
+				m_state.controller_shift = m_controller;
+			}
+		} else if (addr == 0x4017) {
+			writeApuFrameCounter(data);
 		} else if (addr >= 0x4000 && addr < 0x4018) {
-			// TODO: Implement APU and Joysticks!
+			// TODO: Implement APU!
 		} else if (addr >= 0x4018 && addr < 0x4020) {
 			// APU and I/0 functionality
 			// But it's normally disabled
+		} else if (addr >= 0x6000 && addr < 0x8000) {
+			m_mapper->writePrgRam(addr, data);
 		} else {
-			// Save RAM and PRG ROM that stored in cartridge
+			// Mapper registers, usually in the PRG ROM range
 			m_mapper->cpuWrite(addr, data);
+			m_cpu.setIrq(CPU::IRQ_MAPPER, m_mapper->irqPending());
+		}
+	}
+
+	void Bus::ppuWrite(u16 addr, u8 data) {
+		addr &= 0x3fff;
+		if (addr < 0x2000) {
+			m_mapper->ppuWrite(addr, data);
+			return;
+		}
+
+		m_mapper->writeNametable(addr, data);
+	}
+
+	template<typename Policy>
+	void Bus::oamDma(u8 page) {
+		const u16 base = page << 8;
+
+		// RAM and PRG ROM pages are contiguous in memory, copy them in one go. Other
+		// pages go through the bus, one read per byte like the hardware.
+		if (base < 0x2000) {
+			m_ppu.writeOamDma(&m_state.ram.at(base & 0x07ff));
+		} else if (base >= 0x8000) {
+			m_ppu.writeOamDma(m_mapper->prgWindow(base) + (base & 0x1fff));
+		} else {
+			std::array<u8, 256> buffer {};
+			for (u16 i { 0 }; i < buffer.size(); ++i) {
+				buffer.at(i) = cpuRead<Policy>(base + i, false);
+			}
+			m_ppu.writeOamDma(buffer.data());
 		}
+
+		m_cpu.stallForDma();
 	}
+
+	void Bus::writeApuFrameCounter(u8 data) {
+		m_state.apu_frame_mode = data & 0xc0;
+
+		// Setting the inhibit flag clears a pending IRQ.
+		if (m_state.apu_frame_mode & 0x40) {
+			m_state.apu_frame_irq = false;
+			m_cpu.setIrq(CPU::IRQ_APU_FRAME, false);
+		}
+
+		// Only the 4-step sequence without inhibit raises the IRQ, at its last step.
+		if (m_state.apu_frame_mode == 0x00) {
+			const u64 delay { (NES_APU_FRAME_CYCLES - 1) * NES_CPU_DIVIDER };
+			m_state.scheduler.schedule(Event::APU_FRAME, now() + delay);
+		} else {
+			m_state.scheduler.cancel(Event::APU_FRAME);
+		}
+	}
+
+	// The CPU runs on these from another translation unit.
+	template u8 Bus::cpuRead<accuracy::Fast>(u16 addr, bool ro);
+	template u8 Bus::cpuRead<accuracy::Cycle>(u16 addr, bool ro);
+	template u16 Bus::cpuRead16<accuracy::Fast>(u16 addr, bool ro);
+	template u16 Bus::cpuRead16<accuracy::Cycle>(u16 addr, bool ro);
+	template void Bus::cpuWrite<accuracy::Fast>(u16 addr, u8 data);
+	template void Bus::cpuWrite<accuracy::Cycle>(u16 addr, u8 data);
 } // namespace nes
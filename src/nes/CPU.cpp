@@ -1,178 +1,281 @@
 #include "nes/CPU.hpp"
 
+#include "common/Diag.hpp"
+#include "common/Hash.hpp"
 #include "nes/Bus.hpp"
+#include "nes/Coverage.hpp"
+#include "nes/FlatBus.hpp"
 
 #include <spdlog/fmt/fmt.h>
-#include <spdlog/spdlog.h>
+
+#include <cassert>
 
 namespace {
 	[[nodiscard]] bool isPageCrossed(u16 a, u16 b) {
 		return (a & 0xff00) != (b & 0xff00);
 	}
+
+	// N and Z bits of P for every result value.
+	constexpr std::array<u8, 256> nz_table { [] {
+		std::array<u8, 256> table {};
+		for (std::size_t value { 0 }; value < table.size(); ++value) {
+			table.at(value) = (value & 0x80) | (value == 0x00 ? 0x02 : 0x00);
+		}
+		return table;
+	}() };
 } // namespace
 
-namespace nes {
-	CPU::CPU() {
-		// clang-format off
-		m_optable = {
-			Opcode { "BRK", IMP, &CPU::BRK, 7, 0 }, Opcode { "ORA", IZX, &CPU::ORA, 6, 0 }, Opcode { "???", IMP, &CPU::NIL, 2, 0 }, Opcode { "???", IZX, &CPU::NIL, 8, 0 },
-			Opcode { "NOP", ZP0, &CPU::NOP, 3, 0 }, Opcode { "ORA", ZP0, &CPU::ORA, 3, 0 }, Opcode { "ASL", ZP0, &CPU::ASL, 5, 0 }, Opcode { "???", ZP0, &CPU::NIL, 5, 0 },
-			Opcode { "PHP", IMP, &CPU::PHP, 3, 0 }, Opcode { "ORA", IMM, &CPU::ORA, 2, 0 }, Opcode { "ASL", ACC, &CPU::ASL, 2, 0 }, Opcode { "???", IMM, &CPU::NIL, 2, 0 },
-			Opcode { "NOP", ABS, &CPU::NOP, 4, 0 }, Opcode { "ORA", ABS, &CPU::ORA, 4, 0 }, Opcode { "ASL", ABS, &CPU::ASL, 6, 0 }, Opcode { "???", ABS, &CPU::NIL, 6, 0 },
-			Opcode { "BPL", REL, &CPU::BPL, 2, 1 }, Opcode { "ORA", IZY, &CPU::ORA, 5, 1 }, Opcode { "???", IMP, &CPU::NIL, 2, 0 }, Opcode { "???", IZY, &CPU::NIL, 8, 0 },
-			Opcode { "NOP", ZPX, &CPU::NOP, 4, 0 }, Opcode { "ORA", ZPX, &CPU::ORA, 4, 0 }, Opcode { "ASL", ZPX, &CPU::ASL, 6, 0 }, Opcode { "???", ZPX, &CPU::NIL, 6, 0 },
-			Opcode { "CLC", IMP, &CPU::CLC, 2, 0 }, Opcode { "ORA", ABY, &CPU::ORA, 4, 1 }, Opcode { "NOP", IMP, &CPU::NOP, 2, 0 }, Opcode { "???", ABY, &CPU::NIL, 7, 0 },
-			Opcode { "NOP", ABX, &CPU::NOP, 4, 1 }, Opcode { "ORA", ABX, &CPU::ORA, 4, 1 }, Opcode { "ASL", ABX, &CPU::ASL, 7, 0 }, Opcode { "???", ABX, &CPU::NIL, 7, 0 },
-			Opcode { "JSR", ABS, &CPU::JSR, 6, 0 }, Opcode { "AND", IZX, &CPU::AND, 6, 0 }, Opcode { "???", IMP, &CPU::NIL, 2, 0 }, Opcode { "???", IZX, &CPU::NIL, 8, 0 },
-			Opcode { "BIT", ZP0, &CPU::BIT, 3, 0 }, Opcode { "AND", ZP0, &CPU::AND, 3, 0 }, Opcode { "ROL", ZP0, &CPU::ROL, 5, 0 }, Opcode { "???", ZP0, &CPU::NIL, 5, 0 },
-			Opcode { "PLP", IMP, &CPU::PLP, 4, 0 }, Opcode { "AND", IMM, &CPU::AND, 2, 0 }, Opcode { "ROL", ACC, &CPU::ROL, 2, 0 }, Opcode { "???", IMM, &CPU::NIL, 2, 0 },
-			Opcode { "BIT", ABS, &CPU::BIT, 4, 0 }, Opcode { "AND", ABS, &CPU::AND, 4, 0 }, Opcode { "ROL", ABS, &CPU::ROL, 6, 0 }, Opcode { "???", ABS, &CPU::NIL, 6, 0 },
-			Opcode { "BMI", REL, &CPU::BMI, 2, 1 }, Opcode { "AND", IZY, &CPU::AND, 5, 1 }, Opcode { "???", IMP, &CPU::NIL, 2, 0 }, Opcode { "???", IZY, &CPU::NIL, 8, 0 },
-			Opcode { "NOP", ZPX, &CPU::NOP, 4, 0 }, Opcode { "AND", ZPX, &CPU::AND, 4, 0 }, Opcode { "ROL", ZPX, &CPU::ROL, 6, 0 }, Opcode { "???", ZPX, &CPU::NIL, 6, 0 },
-			Opcode { "SEC", IMP, &CPU::SEC, 2, 0 }, Opcode { "AND", ABY, &CPU::AND, 4, 1 }, Opcode { "NOP", IMP, &CPU::NOP, 2, 0 }, Opcode { "???", ABY, &CPU::NIL, 7, 0 },
-			Opcode { "NOP", ABX, &CPU::NOP, 4, 1 }, Opcode { "AND", ABX, &CPU::AND, 4, 1 }, Opcode { "ROL", ABX, &CPU::ROL, 7, 0 }, Opcode { "???", ABX, &CPU::NIL, 7, 0 },
-			Opcode { "RTI", IMP, &CPU::RTI, 6, 0 }, Opcode { "EOR", IZX, &CPU::EOR, 6, 0 }, Opcode { "???", IMP, &CPU::NIL, 2, 0 }, Opcode { "???", IZX, &CPU::NIL, 8, 0 },
-			Opcode { "NOP", ZP0, &CPU::NOP, 3, 0 }, Opcode { "EOR", ZP0, &CPU::EOR, 3, 0 }, Opcode { "LSR", ZP0, &CPU::LSR, 5, 0 }, Opcode { "???", ZP0, &CPU::NIL, 5, 0 },
-			Opcode { "PHA", IMP, &CPU::PHA, 3, 0 }, Opcode { "EOR", IMM, &CPU::EOR, 2, 0 }, Opcode { "LSR", ACC, &CPU::LSR, 2, 0 }, Opcode { "???", IMM, &CPU::NIL, 2, 0 },
-			Opcode { "JMP", ABS, &CPU::JMP, 3, 0 }, Opcode { "EOR", ABS, &CPU::EOR, 4, 0 }, Opcode { "LSR", ABS, &CPU::LSR, 6, 0 }, Opcode { "???", ABS, &CPU::NIL, 6, 0 },
-			Opcode { "BVC", REL, &CPU::BVC, 2, 1 }, Opcode { "EOR", IZY, &CPU::EOR, 5, 1 }, Opcode { "???", IMP, &CPU::NIL, 2, 0 }, Opcode { "???", IZY, &CPU::NIL, 8, 0 },
-			Opcode { "NOP", ZPX, &CPU::NOP, 4, 0 }, Opcode { "EOR", ZPX, &CPU::EOR, 4, 0 }, Opcode { "LSR", ZPX, &CPU::LSR, 6, 0 }, Opcode { "???", ZPX, &CPU::NIL, 6, 0 },
-			Opcode { "CLI", IMP, &CPU::CLI, 2, 0 }, Opcode { "EOR", ABY, &CPU::EOR, 4, 1 }, Opcode { "NOP", IMP, &CPU::NOP, 2, 0 }, Opcode { "???", ABY, &CPU::NIL, 7, 0 },
-			Opcode { "NOP", ABX, &CPU::NOP, 4, 1 }, Opcode { "EOR", ABX, &CPU::EOR, 4, 1 }, Opcode { "LSR", ABX, &CPU::LSR, 7, 0 }, Opcode { "???", ABX, &CPU::NIL, 7, 0 },
-			Opcode { "RTS", IMP, &CPU::RTS, 6, 0 }, Opcode { "ADC", IZX, &CPU::ADC, 6, 0 }, Opcode { "???", IMP, &CPU::NIL, 2, 0 }, Opcode { "???", IZX, &CPU::NIL, 8, 0 },
-			Opcode { "NOP", ZP0, &CPU::NOP, 3, 0 }, Opcode { "ADC", ZP0, &CPU::ADC, 3, 0 }, Opcode { "ROR", ZP0, &CPU::ROR, 5, 0 }, Opcode { "???", ZP0, &CPU::NIL, 5, 0 },
-			Opcode { "PLA", IMP, &CPU::PLA, 4, 0 }, Opcode { "ADC", IMM, &CPU::ADC, 2, 0 }, Opcode { "ROR", ACC, &CPU::ROR, 2, 0 }, Opcode { "???", IMM, &CPU::NIL, 2, 0 },
-			Opcode { "JMP", IND, &CPU::JMP, 5, 0 }, Opcode { "ADC", ABS, &CPU::ADC, 4, 0 }, Opcode { "ROR", ABS, &CPU::ROR, 6, 0 }, Opcode { "???", ABS, &CPU::NIL, 6, 0 },
-			Opcode { "BVS", REL, &CPU::BVS, 2, 1 }, Opcode { "ADC", IZY, &CPU::ADC, 5, 1 }, Opcode { "???", IMP, &CPU::NIL, 2, 0 }, Opcode { "???", IZY, &CPU::NIL, 8, 0 },
-			Opcode { "NOP", ZPX, &CPU::NOP, 4, 0 }, Opcode { "ADC", ZPX, &CPU::ADC, 4, 0 }, Opcode { "ROR", ZPX, &CPU::ROR, 6, 0 }, Opcode { "???", ZPX, &CPU::NIL, 6, 0 },
-			Opcode { "SEI", IMP, &CPU::SEI, 2, 0 }, Opcode { "ADC", ABY, &CPU::ADC, 4, 1 }, Opcode { "NOP", IMP, &CPU::NOP, 2, 0 }, Opcode { "???", ABY, &CPU::NIL, 7, 0 },
-			Opcode { "NOP", ABX, &CPU::NOP, 4, 1 }, Opcode { "ADC", ABX, &CPU::ADC, 4, 1 }, Opcode { "ROR", ABX, &CPU::ROR, 7, 0 }, Opcode { "???", ABX, &CPU::NIL, 7, 0 },
-			Opcode { "NOP", IMM, &CPU::NOP, 2, 0 }, Opcode { "STA", IZX, &CPU::STA, 6, 0 }, Opcode { "NOP", IMM, &CPU::NOP, 2, 0 }, Opcode { "???", IZX, &CPU::NIL, 6, 0 },
-			Opcode { "STY", ZP0, &CPU::STY, 3, 0 }, Opcode { "STA", ZP0, &CPU::STA, 3, 0 }, Opcode { "STX", ZP0, &CPU::STX, 3, 0 }, Opcode { "???", ZP0, &CPU::NIL, 3, 0 },
-			Opcode { "DEY", IMP, &CPU::DEY, 2, 0 }, Opcode { "NOP", IMM, &CPU::NOP, 2, 0 }, Opcode { "TXA", IMP, &CPU::TXA, 2, 0 }, Opcode { "???", IMM, &CPU::NIL, 2, 0 },
-			Opcode { "STY", ABS, &CPU::STY, 4, 0 }, Opcode { "STA", ABS, &CPU::STA, 4, 0 }, Opcode { "STX", ABS, &CPU::STX, 4, 0 }, Opcode { "???", ABS, &CPU::NIL, 4, 0 },
-			Opcode { "BCC", REL, &CPU::BCC, 2, 1 }, Opcode { "STA", IZY, &CPU::STA, 6, 0 }, Opcode { "???", IMP, &CPU::NIL, 2, 0 }, Opcode { "???", IZY, &CPU::NIL, 6, 0 },
-			Opcode { "STY", ZPX, &CPU::STY, 4, 0 }, Opcode { "STA", ZPX, &CPU::STA, 4, 0 }, Opcode { "STX", ZPY, &CPU::STX, 4, 0 }, Opcode { "???", ZPY, &CPU::NIL, 4, 0 },
-			Opcode { "TYA", IMP, &CPU::TYA, 2, 0 }, Opcode { "STA", ABY, &CPU::STA, 5, 0 }, Opcode { "TXS", IMP, &CPU::TXS, 2, 0 }, Opcode { "???", ABY, &CPU::NIL, 5, 0 },
-			Opcode { "???", ABX, &CPU::NIL, 5, 0 }, Opcode { "STA", ABX, &CPU::STA, 5, 0 }, Opcode { "???", ABY, &CPU::NIL, 5, 0 }, Opcode { "???", ABY, &CPU::NIL, 5, 0 },
-			Opcode { "LDY", IMM, &CPU::LDY, 2, 0 }, Opcode { "LDA", IZX, &CPU::LDA, 6, 0 }, Opcode { "LDX", IMM, &CPU::LDX, 2, 0 }, Opcode { "???", IZX, &CPU::NIL, 6, 0 },
-			Opcode { "LDY", ZP0, &CPU::LDY, 3, 0 }, Opcode { "LDA", ZP0, &CPU::LDA, 3, 0 }, Opcode { "LDX", ZP0, &CPU::LDX, 3, 0 }, Opcode { "???", ZP0, &CPU::NIL, 3, 0 },
-			Opcode { "TAY", IMP, &CPU::TAY, 2, 0 }, Opcode { "LDA", IMM, &CPU::LDA, 2, 0 }, Opcode { "TAX", IMP, &CPU::TAX, 2, 0 }, Opcode { "???", IMM, &CPU::NIL, 2, 0 },
-			Opcode { "LDY", ABS, &CPU::LDY, 4, 0 }, Opcode { "LDA", ABS, &CPU::LDA, 4, 0 }, Opcode { "LDX", ABS, &CPU::LDX, 4, 0 }, Opcode { "???", ABS, &CPU::NIL, 4, 0 },
-			Opcode { "BCS", REL, &CPU::BCS, 2, 1 }, Opcode { "LDA", IZY, &CPU::LDA, 5, 1 }, Opcode { "???", IMP, &CPU::NIL, 2, 0 }, Opcode { "???", IZY, &CPU::NIL, 5, 1 },
-			Opcode { "LDY", ZPX, &CPU::LDY, 4, 0 }, Opcode { "LDA", ZPX, &CPU::LDA, 4, 0 }, Opcode { "LDX", ZPY, &CPU::LDX, 4, 0 }, Opcode { "???", ZPY, &CPU::NIL, 4, 0 },
-			Opcode { "CLV", IMP, &CPU::CLV, 2, 0 }, Opcode { "LDA", ABY, &CPU::LDA, 4, 1 }, Opcode { "TSX", IMP, &CPU::TSX, 2, 0 }, Opcode { "???", ABY, &CPU::NIL, 4, 1 },
-			Opcode { "LDY", ABX, &CPU::LDY, 4, 1 }, Opcode { "LDA", ABX, &CPU::LDA, 4, 1 }, Opcode { "LDX", ABY, &CPU::LDX, 4, 1 }, Opcode { "???", ABY, &CPU::NIL, 4, 1 },
-			Opcode { "CPY", IMM, &CPU::CPY, 2, 0 }, Opcode { "CMP", IZX, &CPU::CMP, 6, 0 }, Opcode { "NOP", IMM, &CPU::NOP, 2, 0 }, Opcode { "???", IZX, &CPU::NIL, 8, 0 },
-			Opcode { "CPY", ZP0, &CPU::CPY, 3, 0 }, Opcode { "CMP", ZP0, &CPU::CMP, 3, 0 }, Opcode { "DEC", ZP0, &CPU::DEC, 5, 0 }, Opcode { "???", ZP0, &CPU::NIL, 5, 0 },
-			Opcode { "INY", IMP, &CPU::INY, 2, 0 }, Opcode { "CMP", IMM, &CPU::CMP, 2, 0 }, Opcode { "DEX", IMP, &CPU::DEX, 2, 0 }, Opcode { "???", IMM, &CPU::NIL, 2, 0 },
-			Opcode { "CPY", ABS, &CPU::CPY, 4, 0 }, Opcode { "CMP", ABS, &CPU::CMP, 4, 0 }, Opcode { "DEC", ABS, &CPU::DEC, 6, 0 }, Opcode { "???", ABS, &CPU::NIL, 6, 0 },
-			Opcode { "BNE", REL, &CPU::BNE, 2, 1 }, Opcode { "CMP", IZY, &CPU::CMP, 5, 1 }, Opcode { "???", IMP, &CPU::NIL, 2, 0 }, Opcode { "???", IZY, &CPU::NIL, 8, 0 },
-			Opcode { "NOP", ZPX, &CPU::NOP, 4, 0 }, Opcode { "CMP", ZPX, &CPU::CMP, 4, 0 }, Opcode { "DEC", ZPX, &CPU::DEC, 6, 0 }, Opcode { "???", ZPX, &CPU::NIL, 6, 0 },
-			Opcode { "CLD", IMP, &CPU::CLD, 2, 0 }, Opcode { "CMP", ABY, &CPU::CMP, 4, 1 }, Opcode { "NOP", IMP, &CPU::NOP, 2, 0 }, Opcode { "???", ABY, &CPU::NIL, 7, 0 },
-			Opcode { "NOP", ABX, &CPU::NOP, 4, 1 }, Opcode { "CMP", ABX, &CPU::CMP, 4, 1 }, Opcode { "DEC", ABX, &CPU::DEC, 7, 0 }, Opcode { "???", ABX, &CPU::NIL, 7, 0 },
-			Opcode { "CPX", IMM, &CPU::CPX, 2, 0 }, Opcode { "SBC", IZX, &CPU::SBC, 6, 0 }, Opcode { "NOP", IMM, &CPU::NOP, 2, 0 }, Opcode { "???", IZX, &CPU::NIL, 8, 0 },
-			Opcode { "CPX", ZP0, &CPU::CPX, 3, 0 }, Opcode { "SBC", ZP0, &CPU::SBC, 3, 0 }, Opcode { "INC", ZP0, &CPU::INC, 5, 0 }, Opcode { "???", ZP0, &CPU::NIL, 5, 0 },
-			Opcode { "INX", IMP, &CPU::INX, 2, 0 }, Opcode { "SBC", IMM, &CPU::SBC, 2, 0 }, Opcode { "NOP", IMP, &CPU::NOP, 2, 0 }, Opcode { "SBC", IMM, &CPU::SBC, 2, 0 },
-			Opcode { "CPX", ABS, &CPU::CPX, 4, 0 }, Opcode { "SBC", ABS, &CPU::SBC, 4, 0 }, Opcode { "INC", ABS, &CPU::INC, 6, 0 }, Opcode { "???", ABS, &CPU::NIL, 6, 0 },
-			Opcode { "BEQ", REL, &CPU::BEQ, 2, 1 }, Opcode { "SBC", IZY, &CPU::SBC, 5, 1 }, Opcode { "???", IMP, &CPU::NIL, 2, 0 }, Opcode { "???", IZY, &CPU::NIL, 8, 0 },
-			Opcode { "NOP", ZPX, &CPU::NOP, 4, 0 }, Opcode { "SBC", ZPX, &CPU::SBC, 4, 0 }, Opcode { "INC", ZPX, &CPU::INC, 6, 0 }, Opcode { "???", ZPX, &CPU::NIL, 6, 0 },
-			Opcode { "SED", IMP, &CPU::SED, 2, 0 }, Opcode { "SBC", ABY, &CPU::SBC, 4, 1 }, Opcode { "NOP", IMP, &CPU::NOP, 2, 0 }, Opcode { "???", ABY, &CPU::NIL, 7, 0 },
-			Opcode { "NOP", ABX, &CPU::NOP, 4, 1 }, Opcode { "SBC", ABX, &CPU::SBC, 4, 1 }, Opcode { "INC", ABX, &CPU::INC, 7, 0 }, Opcode { "???", ABX, &CPU::NIL, 7, 0 },
-		};
-		// clang-format on
-	}
+#ifdef NES_FUZZING
+namespace nes::coverage {
+	__attribute__((section("__libfuzzer_extra_counters")))
+	u8 edge_map[NES_COVERAGE_MAP_SIZE];
+} // namespace nes::coverage
+#endif
 
-	void CPU::connectBus(Bus *bus) {
+namespace nes {
+	// Shared by every CPU: the table is immutable.
+	// clang-format off
+	template<typename Memory>
+	template<typename Policy>
+	const std::array<typename BasicCPU<Memory>::Opcode, 256> BasicCPU<Memory>::optable {
+		Opcode { "BRK", IMP, &BasicCPU::BRK<Policy>, 7, 0 }, Opcode { "ORA", IZX, &BasicCPU::ORA<Policy>, 6, 0 }, Opcode { "???", IMP, &BasicCPU::NIL<Policy>, 2, 0 }, Opcode { "???", IZX, &BasicCPU::NIL<Policy>, 8, 0 },
+		Opcode { "NOP", ZP0, &BasicCPU::NOP<Policy>, 3, 0 }, Opcode { "ORA", ZP0, &BasicCPU::ORA<Policy>, 3, 0 }, Opcode { "ASL", ZP0, &BasicCPU::ASL<Policy>, 5, 0 }, Opcode { "???", ZP0, &BasicCPU::NIL<Policy>, 5, 0 },
+		Opcode { "PHP", IMP, &BasicCPU::PHP<Policy>, 3, 0 }, Opcode { "ORA", IMM, &BasicCPU::ORA<Policy>, 2, 0 }, Opcode { "ASL", ACC, &BasicCPU::ASL<Policy>, 2, 0 }, Opcode { "???", IMM, &BasicCPU::NIL<Policy>, 2, 0 },
+		Opcode { "NOP", ABS, &BasicCPU::NOP<Policy>, 4, 0 }, Opcode { "ORA", ABS, &BasicCPU::ORA<Policy>, 4, 0 }, Opcode { "ASL", ABS, &BasicCPU::ASL<Policy>, 6, 0 }, Opcode { "???", ABS, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "BPL", REL, &BasicCPU::BPL<Policy>, 2, 1 }, Opcode { "ORA", IZY, &BasicCPU::ORA<Policy>, 5, 1 }, Opcode { "???", IMP, &BasicCPU::NIL<Policy>, 2, 0 }, Opcode { "???", IZY, &BasicCPU::NIL<Policy>, 8, 0 },
+		Opcode { "NOP", ZPX, &BasicCPU::NOP<Policy>, 4, 0 }, Opcode { "ORA", ZPX, &BasicCPU::ORA<Policy>, 4, 0 }, Opcode { "ASL", ZPX, &BasicCPU::ASL<Policy>, 6, 0 }, Opcode { "???", ZPX, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "CLC", IMP, &BasicCPU::CLC<Policy>, 2, 0 }, Opcode { "ORA", ABY, &BasicCPU::ORA<Policy>, 4, 1 }, Opcode { "NOP", IMP, &BasicCPU::NOP<Policy>, 2, 0 }, Opcode { "???", ABY, &BasicCPU::NIL<Policy>, 7, 0 },
+		Opcode { "NOP", ABX, &BasicCPU::NOP<Policy>, 4, 1 }, Opcode { "ORA", ABX, &BasicCPU::ORA<Policy>, 4, 1 }, Opcode { "ASL", ABX, &BasicCPU::ASL<Policy>, 7, 0 }, Opcode { "???", ABX, &BasicCPU::NIL<Policy>, 7, 0 },
+		Opcode { "JSR", ABS, &BasicCPU::JSR<Policy>, 6, 0 }, Opcode { "AND", IZX, &BasicCPU::AND<Policy>, 6, 0 }, Opcode { "???", IMP, &BasicCPU::NIL<Policy>, 2, 0 }, Opcode { "???", IZX, &BasicCPU::NIL<Policy>, 8, 0 },
+		Opcode { "BIT", ZP0, &BasicCPU::BIT<Policy>, 3, 0 }, Opcode { "AND", ZP0, &BasicCPU::AND<Policy>, 3, 0 }, Opcode { "ROL", ZP0, &BasicCPU::ROL<Policy>, 5, 0 }, Opcode { "???", ZP0, &BasicCPU::NIL<Policy>, 5, 0 },
+		Opcode { "PLP", IMP, &BasicCPU::PLP<Policy>, 4, 0 }, Opcode { "AND", IMM, &BasicCPU::AND<Policy>, 2, 0 }, Opcode { "ROL", ACC, &BasicCPU::ROL<Policy>, 2, 0 }, Opcode { "???", IMM, &BasicCPU::NIL<Policy>, 2, 0 },
+		Opcode { "BIT", ABS, &BasicCPU::BIT<Policy>, 4, 0 }, Opcode { "AND", ABS, &BasicCPU::AND<Policy>, 4, 0 }, Opcode { "ROL", ABS, &BasicCPU::ROL<Policy>, 6, 0 }, Opcode { "???", ABS, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "BMI", REL, &BasicCPU::BMI<Policy>, 2, 1 }, Opcode { "AND", IZY, &BasicCPU::AND<Policy>, 5, 1 }, Opcode { "???", IMP, &BasicCPU::NIL<Policy>, 2, 0 }, Opcode { "???", IZY, &BasicCPU::NIL<Policy>, 8, 0 },
+		Opcode { "NOP", ZPX, &BasicCPU::NOP<Policy>, 4, 0 }, Opcode { "AND", ZPX, &BasicCPU::AND<Policy>, 4, 0 }, Opcode { "ROL", ZPX, &BasicCPU::ROL<Policy>, 6, 0 }, Opcode { "???", ZPX, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "SEC", IMP, &BasicCPU::SEC<Policy>, 2, 0 }, Opcode { "AND", ABY, &BasicCPU::AND<Policy>, 4, 1 }, Opcode { "NOP", IMP, &BasicCPU::NOP<Policy>, 2, 0 }, Opcode { "???", ABY, &BasicCPU::NIL<Policy>, 7, 0 },
+		Opcode { "NOP", ABX, &BasicCPU::NOP<Policy>, 4, 1 }, Opcode { "AND", ABX, &BasicCPU::AND<Policy>, 4, 1 }, Opcode { "ROL", ABX, &BasicCPU::ROL<Policy>, 7, 0 }, Opcode { "???", ABX, &BasicCPU::NIL<Policy>, 7, 0 },
+		Opcode { "RTI", IMP, &BasicCPU::RTI<Policy>, 6, 0 }, Opcode { "EOR", IZX, &BasicCPU::EOR<Policy>, 6, 0 }, Opcode { "???", IMP, &BasicCPU::NIL<Policy>, 2, 0 }, Opcode { "???", IZX, &BasicCPU::NIL<Policy>, 8, 0 },
+		Opcode { "NOP", ZP0, &BasicCPU::NOP<Policy>, 3, 0 }, Opcode { "EOR", ZP0, &BasicCPU::EOR<Policy>, 3, 0 }, Opcode { "LSR", ZP0, &BasicCPU::LSR<Policy>, 5, 0 }, Opcode { "???", ZP0, &BasicCPU::NIL<Policy>, 5, 0 },
+		Opcode { "PHA", IMP, &BasicCPU::PHA<Policy>, 3, 0 }, Opcode { "EOR", IMM, &BasicCPU::EOR<Policy>, 2, 0 }, Opcode { "LSR", ACC, &BasicCPU::LSR<Policy>, 2, 0 }, Opcode { "???", IMM, &BasicCPU::NIL<Policy>, 2, 0 },
+		Opcode { "JMP", ABS, &BasicCPU::JMP<Policy>, 3, 0 }, Opcode { "EOR", ABS, &BasicCPU::EOR<Policy>, 4, 0 }, Opcode { "LSR", ABS, &BasicCPU::LSR<Policy>, 6, 0 }, Opcode { "???", ABS, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "BVC", REL, &BasicCPU::BVC<Policy>, 2, 1 }, Opcode { "EOR", IZY, &BasicCPU::EOR<Policy>, 5, 1 }, Opcode { "???", IMP, &BasicCPU::NIL<Policy>, 2, 0 }, Opcode { "???", IZY, &BasicCPU::NIL<Policy>, 8, 0 },
+		Opcode { "NOP", ZPX, &BasicCPU::NOP<Policy>, 4, 0 }, Opcode { "EOR", ZPX, &BasicCPU::EOR<Policy>, 4, 0 }, Opcode { "LSR", ZPX, &BasicCPU::LSR<Policy>, 6, 0 }, Opcode { "???", ZPX, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "CLI", IMP, &BasicCPU::CLI<Policy>, 2, 0 }, Opcode { "EOR", ABY, &BasicCPU::EOR<Policy>, 4, 1 }, Opcode { "NOP", IMP, &BasicCPU::NOP<Policy>, 2, 0 }, Opcode { "???", ABY, &BasicCPU::NIL<Policy>, 7, 0 },
+		Opcode { "NOP", ABX, &BasicCPU::NOP<Policy>, 4, 1 }, Opcode { "EOR", ABX, &BasicCPU::EOR<Policy>, 4, 1 }, Opcode { "LSR", ABX, &BasicCPU::LSR<Policy>, 7, 0 }, Opcode { "???", ABX, &BasicCPU::NIL<Policy>, 7, 0 },
+		Opcode { "RTS", IMP, &BasicCPU::RTS<Policy>, 6, 0 }, Opcode { "ADC", IZX, &BasicCPU::ADC<Policy>, 6, 0 }, Opcode { "???", IMP, &BasicCPU::NIL<Policy>, 2, 0 }, Opcode { "???", IZX, &BasicCPU::NIL<Policy>, 8, 0 },
+		Opcode { "NOP", ZP0, &BasicCPU::NOP<Policy>, 3, 0 }, Opcode { "ADC", ZP0, &BasicCPU::ADC<Policy>, 3, 0 }, Opcode { "ROR", ZP0, &BasicCPU::ROR<Policy>, 5, 0 }, Opcode { "???", ZP0, &BasicCPU::NIL<Policy>, 5, 0 },
+		Opcode { "PLA", IMP, &BasicCPU::PLA<Policy>, 4, 0 }, Opcode { "ADC", IMM, &BasicCPU::ADC<Policy>, 2, 0 }, Opcode { "ROR", ACC, &BasicCPU::ROR<Policy>, 2, 0 }, Opcode { "???", IMM, &BasicCPU::NIL<Policy>, 2, 0 },
+		Opcode { "JMP", IND, &BasicCPU::JMP<Policy>, 5, 0 }, Opcode { "ADC", ABS, &BasicCPU::ADC<Policy>, 4, 0 }, Opcode { "ROR", ABS, &BasicCPU::ROR<Policy>, 6, 0 }, Opcode { "???", ABS, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "BVS", REL, &BasicCPU::BVS<Policy>, 2, 1 }, Opcode { "ADC", IZY, &BasicCPU::ADC<Policy>, 5, 1 }, Opcode { "???", IMP, &BasicCPU::NIL<Policy>, 2, 0 }, Opcode { "???", IZY, &BasicCPU::NIL<Policy>, 8, 0 },
+		Opcode { "NOP", ZPX, &BasicCPU::NOP<Policy>, 4, 0 }, Opcode { "ADC", ZPX, &BasicCPU::ADC<Policy>, 4, 0 }, Opcode { "ROR", ZPX, &BasicCPU::ROR<Policy>, 6, 0 }, Opcode { "???", ZPX, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "SEI", IMP, &BasicCPU::SEI<Policy>, 2, 0 }, Opcode { "ADC", ABY, &BasicCPU::ADC<Policy>, 4, 1 }, Opcode { "NOP", IMP, &BasicCPU::NOP<Policy>, 2, 0 }, Opcode { "???", ABY, &BasicCPU::NIL<Policy>, 7, 0 },
+		Opcode { "NOP", ABX, &BasicCPU::NOP<Policy>, 4, 1 }, Opcode { "ADC", ABX, &BasicCPU::ADC<Policy>, 4, 1 }, Opcode { "ROR", ABX, &BasicCPU::ROR<Policy>, 7, 0 }, Opcode { "???", ABX, &BasicCPU::NIL<Policy>, 7, 0 },
+		Opcode { "NOP", IMM, &BasicCPU::NOP<Policy>, 2, 0 }, Opcode { "STA", IZX, &BasicCPU::STA<Policy>, 6, 0 }, Opcode { "NOP", IMM, &BasicCPU::NOP<Policy>, 2, 0 }, Opcode { "???", IZX, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "STY", ZP0, &BasicCPU::STY<Policy>, 3, 0 }, Opcode { "STA", ZP0, &BasicCPU::STA<Policy>, 3, 0 }, Opcode { "STX", ZP0, &BasicCPU::STX<Policy>, 3, 0 }, Opcode { "???", ZP0, &BasicCPU::NIL<Policy>, 3, 0 },
+		Opcode { "DEY", IMP, &BasicCPU::DEY<Policy>, 2, 0 }, Opcode { "NOP", IMM, &BasicCPU::NOP<Policy>, 2, 0 }, Opcode { "TXA", IMP, &BasicCPU::TXA<Policy>, 2, 0 }, Opcode { "???", IMM, &BasicCPU::NIL<Policy>, 2, 0 },
+		Opcode { "STY", ABS, &BasicCPU::STY<Policy>, 4, 0 }, Opcode { "STA", ABS, &BasicCPU::STA<Policy>, 4, 0 }, Opcode { "STX", ABS, &BasicCPU::STX<Policy>, 4, 0 }, Opcode { "???", ABS, &BasicCPU::NIL<Policy>, 4, 0 },
+		Opcode { "BCC", REL, &BasicCPU::BCC<Policy>, 2, 1 }, Opcode { "STA", IZY, &BasicCPU::STA<Policy>, 6, 0 }, Opcode { "???", IMP, &BasicCPU::NIL<Policy>, 2, 0 }, Opcode { "???", IZY, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "STY", ZPX, &BasicCPU::STY<Policy>, 4, 0 }, Opcode { "STA", ZPX, &BasicCPU::STA<Policy>, 4, 0 }, Opcode { "STX", ZPY, &BasicCPU::STX<Policy>, 4, 0 }, Opcode { "???", ZPY, &BasicCPU::NIL<Policy>, 4, 0 },
+		Opcode { "TYA", IMP, &BasicCPU::TYA<Policy>, 2, 0 }, Opcode { "STA", ABY, &BasicCPU::STA<Policy>, 5, 0 }, Opcode { "TXS", IMP, &BasicCPU::TXS<Policy>, 2, 0 }, Opcode { "???", ABY, &BasicCPU::NIL<Policy>, 5, 0 },
+		Opcode { "???", ABX, &BasicCPU::NIL<Policy>, 5, 0 }, Opcode { "STA", ABX, &BasicCPU::STA<Policy>, 5, 0 }, Opcode { "???", ABY, &BasicCPU::NIL<Policy>, 5, 0 }, Opcode { "???", ABY, &BasicCPU::NIL<Policy>, 5, 0 },
+		Opcode { "LDY", IMM, &BasicCPU::LDY<Policy>, 2, 0 }, Opcode { "LDA", IZX, &BasicCPU::LDA<Policy>, 6, 0 }, Opcode { "LDX", IMM, &BasicCPU::LDX<Policy>, 2, 0 }, Opcode { "???", IZX, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "LDY", ZP0, &BasicCPU::LDY<Policy>, 3, 0 }, Opcode { "LDA", ZP0, &BasicCPU::LDA<Policy>, 3, 0 }, Opcode { "LDX", ZP0, &BasicCPU::LDX<Policy>, 3, 0 }, Opcode { "???", ZP0, &BasicCPU::NIL<Policy>, 3, 0 },
+		Opcode { "TAY", IMP, &BasicCPU::TAY<Policy>, 2, 0 }, Opcode { "LDA", IMM, &BasicCPU::LDA<Policy>, 2, 0 }, Opcode { "TAX", IMP, &BasicCPU::TAX<Policy>, 2, 0 }, Opcode { "???", IMM, &BasicCPU::NIL<Policy>, 2, 0 },
+		Opcode { "LDY", ABS, &BasicCPU::LDY<Policy>, 4, 0 }, Opcode { "LDA", ABS, &BasicCPU::LDA<Policy>, 4, 0 }, Opcode { "LDX", ABS, &BasicCPU::LDX<Policy>, 4, 0 }, Opcode { "???", ABS, &BasicCPU::NIL<Policy>, 4, 0 },
+		Opcode { "BCS", REL, &BasicCPU::BCS<Policy>, 2, 1 }, Opcode { "LDA", IZY, &BasicCPU::LDA<Policy>, 5, 1 }, Opcode { "???", IMP, &BasicCPU::NIL<Policy>, 2, 0 }, Opcode { "???", IZY, &BasicCPU::NIL<Policy>, 5, 1 },
+		Opcode { "LDY", ZPX, &BasicCPU::LDY<Policy>, 4, 0 }, Opcode { "LDA", ZPX, &BasicCPU::LDA<Policy>, 4, 0 }, Opcode { "LDX", ZPY, &BasicCPU::LDX<Policy>, 4, 0 }, Opcode { "???", ZPY, &BasicCPU::NIL<Policy>, 4, 0 },
+		Opcode { "CLV", IMP, &BasicCPU::CLV<Policy>, 2, 0 }, Opcode { "LDA", ABY, &BasicCPU::LDA<Policy>, 4, 1 }, Opcode { "TSX", IMP, &BasicCPU::TSX<Policy>, 2, 0 }, Opcode { "???", ABY, &BasicCPU::NIL<Policy>, 4, 1 },
+		Opcode { "LDY", ABX, &BasicCPU::LDY<Policy>, 4, 1 }, Opcode { "LDA", ABX, &BasicCPU::LDA<Policy>, 4, 1 }, Opcode { "LDX", ABY, &BasicCPU::LDX<Policy>, 4, 1 }, Opcode { "???", ABY, &BasicCPU::NIL<Policy>, 4, 1 },
+		Opcode { "CPY", IMM, &BasicCPU::CPY<Policy>, 2, 0 }, Opcode { "CMP", IZX, &BasicCPU::CMP<Policy>, 6, 0 }, Opcode { "NOP", IMM, &BasicCPU::NOP<Policy>, 2, 0 }, Opcode { "???", IZX, &BasicCPU::NIL<Policy>, 8, 0 },
+		Opcode { "CPY", ZP0, &BasicCPU::CPY<Policy>, 3, 0 }, Opcode { "CMP", ZP0, &BasicCPU::CMP<Policy>, 3, 0 }, Opcode { "DEC", ZP0, &BasicCPU::DEC<Policy>, 5, 0 }, Opcode { "???", ZP0, &BasicCPU::NIL<Policy>, 5, 0 },
+		Opcode { "INY", IMP, &BasicCPU::INY<Policy>, 2, 0 }, Opcode { "CMP", IMM, &BasicCPU::CMP<Policy>, 2, 0 }, Opcode { "DEX", IMP, &BasicCPU::DEX<Policy>, 2, 0 }, Opcode { "???", IMM, &BasicCPU::NIL<Policy>, 2, 0 },
+		Opcode { "CPY", ABS, &BasicCPU::CPY<Policy>, 4, 0 }, Opcode { "CMP", ABS, &BasicCPU::CMP<Policy>, 4, 0 }, Opcode { "DEC", ABS, &BasicCPU::DEC<Policy>, 6, 0 }, Opcode { "???", ABS, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "BNE", REL, &BasicCPU::BNE<Policy>, 2, 1 }, Opcode { "CMP", IZY, &BasicCPU::CMP<Policy>, 5, 1 }, Opcode { "???", IMP, &BasicCPU::NIL<Policy>, 2, 0 }, Opcode { "???", IZY, &BasicCPU::NIL<Policy>, 8, 0 },
+		Opcode { "NOP", ZPX, &BasicCPU::NOP<Policy>, 4, 0 }, Opcode { "CMP", ZPX, &BasicCPU::CMP<Policy>, 4, 0 }, Opcode { "DEC", ZPX, &BasicCPU::DEC<Policy>, 6, 0 }, Opcode { "???", ZPX, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "CLD", IMP, &BasicCPU::CLD<Policy>, 2, 0 }, Opcode { "CMP", ABY, &BasicCPU::CMP<Policy>, 4, 1 }, Opcode { "NOP", IMP, &BasicCPU::NOP<Policy>, 2, 0 }, Opcode { "???", ABY, &BasicCPU::NIL<Policy>, 7, 0 },
+		Opcode { "NOP", ABX, &BasicCPU::NOP<Policy>, 4, 1 }, Opcode { "CMP", ABX, &BasicCPU::CMP<Policy>, 4, 1 }, Opcode { "DEC", ABX, &BasicCPU::DEC<Policy>, 7, 0 }, Opcode { "???", ABX, &BasicCPU::NIL<Policy>, 7, 0 },
+		Opcode { "CPX", IMM, &BasicCPU::CPX<Policy>, 2, 0 }, Opcode { "SBC", IZX, &BasicCPU::SBC<Policy>, 6, 0 }, Opcode { "NOP", IMM, &BasicCPU::NOP<Policy>, 2, 0 }, Opcode { "???", IZX, &BasicCPU::NIL<Policy>, 8, 0 },
+		Opcode { "CPX", ZP0, &BasicCPU::CPX<Policy>, 3, 0 }, Opcode { "SBC", ZP0, &BasicCPU::SBC<Policy>, 3, 0 }, Opcode { "INC", ZP0, &BasicCPU::INC<Policy>, 5, 0 }, Opcode { "???", ZP0, &BasicCPU::NIL<Policy>, 5, 0 },
+		Opcode { "INX", IMP, &BasicCPU::INX<Policy>, 2, 0 }, Opcode { "SBC", IMM, &BasicCPU::SBC<Policy>, 2, 0 }, Opcode { "NOP", IMP, &BasicCPU::NOP<Policy>, 2, 0 }, Opcode { "SBC", IMM, &BasicCPU::SBC<Policy>, 2, 0 },
+		Opcode { "CPX", ABS, &BasicCPU::CPX<Policy>, 4, 0 }, Opcode { "SBC", ABS, &BasicCPU::SBC<Policy>, 4, 0 }, Opcode { "INC", ABS, &BasicCPU::INC<Policy>, 6, 0 }, Opcode { "???", ABS, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "BEQ", REL, &BasicCPU::BEQ<Policy>, 2, 1 }, Opcode { "SBC", IZY, &BasicCPU::SBC<Policy>, 5, 1 }, Opcode { "???", IMP, &BasicCPU::NIL<Policy>, 2, 0 }, Opcode { "???", IZY, &BasicCPU::NIL<Policy>, 8, 0 },
+		Opcode { "NOP", ZPX, &BasicCPU::NOP<Policy>, 4, 0 }, Opcode { "SBC", ZPX, &BasicCPU::SBC<Policy>, 4, 0 }, Opcode { "INC", ZPX, &BasicCPU::INC<Policy>, 6, 0 }, Opcode { "???", ZPX, &BasicCPU::NIL<Policy>, 6, 0 },
+		Opcode { "SED", IMP, &BasicCPU::SED<Policy>, 2, 0 }, Opcode { "SBC", ABY, &BasicCPU::SBC<Policy>, 4, 1 }, Opcode { "NOP", IMP, &BasicCPU::NOP<Policy>, 2, 0 }, Opcode { "???", ABY, &BasicCPU::NIL<Policy>, 7, 0 },
+		Opcode { "NOP", ABX, &BasicCPU::NOP<Policy>, 4, 1 }, Opcode { "SBC", ABX, &BasicCPU::SBC<Policy>, 4, 1 }, Opcode { "INC", ABX, &BasicCPU::INC<Policy>, 7, 0 }, Opcode { "???", ABX, &BasicCPU::NIL<Policy>, 7, 0 },
+	};
+	// clang-format on
+
+	template<typename Memory>
+	BasicCPU<Memory>::BasicCPU(State& state, Accuracy accuracy)
+		: m_state(state)
+		, m_accuracy(accuracy) {}
+
+	template<typename Memory>
+	void BasicCPU<Memory>::connectBus(Memory *bus) {
 		m_bus = bus;
 		assert(m_bus != nullptr);
 	}
 
-	void CPU::clock() {
+	template<typename Memory>
+	void BasicCPU<Memory>::clock() {
 		// Verify if there is remaining cycles.
-		if (m_cycles == 0) {
-			m_reg.p.u = true; // NOTE: Always set Unused bit to 1.
+		if (m_state.cycles == 0) {
 			step();
 		}
-		m_cycles -= 1;
+		m_state.cycles -= 1;
+		m_state.cycle_count += 1;
 	}
 
-	void CPU::step() {
-		m_opcode = memRead(m_reg.pc);
-		m_reg.pc += 1;
+	template<typename Memory>
+	void BasicCPU<Memory>::step() {
+		if (m_accuracy == Accuracy::CYCLE) {
+			stepWith<accuracy::Cycle>();
+		} else {
+			stepWith<accuracy::Fast>();
+		}
+	}
+
+	template<typename Memory>
+	u32 BasicCPU<Memory>::run(u32 cycles) {
+		if (m_accuracy == Accuracy::CYCLE) {
+			return runWith<accuracy::Cycle>(cycles);
+		}
+		return runWith<accuracy::Fast>(cycles);
+	}
+
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::stepWith() {
+		// Calls into the bus may store anywhere, a local reference is not reloaded.
+		State& state { m_state };
+
+		if (state.nmi_pending) {
+			state.nmi_pending = false;
+			nmi<Policy>();
+			return;
+		}
+
+		if (state.irq_lines != 0 && !state.p.interrupt()) {
+			irq<Policy>();
+			return;
+		}
+
+#ifdef NES_FUZZING
+		coverage::edge(m_prev_pc, state.pc);
+		m_prev_pc = state.pc;
+#endif
+
+		m_opcode = memRead<Policy>(state.pc);
+		state.pc += 1;
 
 		try {
-			m_instruction = m_optable.at(m_opcode);
+			m_instruction = optable<Policy>.at(m_opcode);
 		} catch (std::out_of_range& e) {
-			spdlog::warn("Opcode {:#04x} is not implemented! {}", m_opcode, e.what());
+			NES_WARN("Opcode {:#04x} is not implemented! {}", m_opcode, e.what());
 			// Just set current opcode to NOP if not doesn't exist.
-			m_instruction = m_optable.at(0xea);
+			m_instruction = optable<Policy>.at(0xea);
 		}
 
-		auto [addr, page_crossed] { getOperandAddress(m_instruction.addressing) };
+		auto [addr, page_crossed] { getOperandAddress<Policy>(m_instruction.addressing) };
 
 		(this->*m_instruction.operation)(addr);
-		m_cycles += m_instruction.cycles;
+		state.cycles += m_instruction.cycles;
 
 		if (page_crossed) {
-			m_cycles += m_instruction.page_cycles;
+			state.cycles += m_instruction.page_cycles;
+		}
+	}
+
+	template<typename Memory>
+	template<typename Policy>
+	u32 BasicCPU<Memory>::runWith(u32 cycles) {
+		State& state { m_state };
+		u32 elapsed { state.cycles };
+		state.cycle_count += state.cycles;
+		state.cycles = 0;
+
+		while (elapsed < cycles) {
+			stepWith<Policy>();
+			elapsed += state.cycles;
+			state.cycle_count += state.cycles;
+			state.cycles = 0;
 		}
+
+		return elapsed;
+	}
+
+	template<typename Memory>
+	void BasicCPU<Memory>::stallForDma() {
+		// The CPU halts after the writing instruction: one cycle, one more to align
+		// when that cycle is odd, then 256 read/write pairs. The cycle count is the
+		// start of the current instruction.
+		const u64 start { m_state.cycle_count + m_instruction.cycles };
+		m_state.cycles += 513 + (start & 0x01);
 	}
 
-	void CPU::reset() {
-		m_reg.pc = memRead16(0xfffc);
-		m_reg.p.raw = 0x34; // 0b0011010, Interrupt = 1, Break = 1, Unused = 1
-		m_reg.sp = 0xfd;
+	template<typename Memory>
+	void BasicCPU<Memory>::reset() {
+		m_state.pc = m_accuracy == Accuracy::CYCLE ? memRead16<accuracy::Cycle>(0xfffc)
+		                                           : memRead16<accuracy::Fast>(0xfffc);
+		m_state.p.unpack(0x24); // 0b0010100, Interrupt = 1, Unused = 1
+		m_state.sp = 0xfd;
 
-		m_reg.a = 0x00;
-		m_reg.x = 0x00;
-		m_reg.y = 0x00;
+		m_state.a = 0x00;
+		m_state.x = 0x00;
+		m_state.y = 0x00;
 
-		m_cycles = 8; // Reset takes time.
+		m_state.cycles = 8; // Reset takes time.
+
+		m_state.irq_lines = 0;
+		m_state.nmi_pending = false;
 	}
 
-	void CPU::irq() {
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::irq() {
 		// Is interrupt allowed
-		if (m_reg.p.i) {
+		if (m_state.p.interrupt()) {
 			return;
 		}
 
-		stackPush16(m_reg.pc);
+		stackPush16<Policy>(m_state.pc);
 
-		m_reg.p.b = false;
-		m_reg.p.u = true;
-		m_reg.p.i = true;
-		stackPush(m_reg.p.raw);
+		// Pushed with Break = 0, Unused = 1.
+		stackPush<Policy>((m_state.p.pack() & ~Status::FLAG_B) | Status::FLAG_U);
+		m_state.p.flags |= Status::FLAG_I;
 
-		m_reg.pc = memRead(0xfffe);
+		m_state.pc = memRead16<Policy>(0xfffe);
 
-		m_cycles = 7; // IRQs take time.
+		m_state.cycles += 7; // IRQs take time.
 	}
 
-	void CPU::nmi() {
-		stackPush16(m_reg.pc);
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::nmi() {
+		stackPush16<Policy>(m_state.pc);
 
-		m_reg.p.b = false;
-		m_reg.p.u = true;
-		m_reg.p.i = true;
-		stackPush(m_reg.p.raw);
+		// Pushed with Break = 0, Unused = 1.
+		stackPush<Policy>((m_state.p.pack() & ~Status::FLAG_B) | Status::FLAG_U);
+		m_state.p.flags |= Status::FLAG_I;
 
-		m_reg.pc = memRead(0xfffa);
+		m_state.pc = memRead16<Policy>(0xfffa);
 
-		m_cycles = 8; // NMIs take time.
+		m_state.cycles += 7; // NMIs take time.
 	}
 
-	std::string CPU::getDebugString() const {
+	template<typename Memory>
+	std::string BasicCPU<Memory>::getDebugString() const {
 		// Check if some instruction is running.
-		if (m_cycles > 0) {
+		if (m_state.cycles > 0) {
 			return "";
 		}
 
 		// Get next Opcode
-		auto next_opcode { memRead(m_reg.pc) };
+		// Read-only, the accuracy policy makes no difference.
+		auto next_opcode { memRead<accuracy::Fast>(m_state.pc, true) };
 		std::string opcode_name {};
 		try {
-			opcode_name = m_optable.at(next_opcode).name;
+			opcode_name = optable<accuracy::Fast>.at(next_opcode).name;
 		} catch (std::out_of_range& e) {
 			// Just set current opcode to XXX if not doesn't exist.
 			opcode_name = "XXX";
@@ -181,670 +284,900 @@ namespace nes {
 		return fmt::format(
 			"{0:#06x} {1:#04x} {2}      A:{3:#04x} X:{4:#04x} Y:{5:#04x} P:{6:#04x} "
 			"SP:{7:#04x}",
-			m_reg.pc, next_opcode, opcode_name, m_reg.a, m_reg.x, m_reg.y, m_reg.p.raw,
-			m_reg.sp
+			m_state.pc, next_opcode, opcode_name, m_state.a, m_state.x, m_state.y,
+			m_state.p.pack(), m_state.sp
 		);
 	}
 
-	u8 CPU::memRead(u16 addr, bool ro) const {
+	template<typename Memory>
+	u64 BasicCPU<Memory>::hashState(u64 seed) const {
+		// Hash the fields one by one so struct padding never leaks into the result.
+		// The cycle count is left out: it only grows, so no two states would match.
+		const std::array<u8, 11> state {
+			static_cast<u8>(m_state.pc & 0x00ff),
+			static_cast<u8>(m_state.pc >> 8),
+			m_state.sp,
+			m_state.a,
+			m_state.x,
+			m_state.y,
+			m_state.p.pack(),
+			static_cast<u8>(m_state.cycles & 0x00ff),
+			static_cast<u8>(m_state.cycles >> 8),
+			m_state.irq_lines,
+			static_cast<u8>(m_state.nmi_pending),
+		};
+
+		return hash::xxh64(state.data(), state.size(), seed);
+	}
+
+	template<typename Memory>
+	u8 BasicCPU<Memory>::Status::pack() const {
+		return flags | (nz_table.at(n) & FLAG_N) | (nz_table.at(z) & FLAG_Z) | c
+		     | ((v & 0x80) >> 1);
+	}
+
+	template<typename Memory>
+	void BasicCPU<Memory>::Status::unpack(u8 p) {
+		// Break only exists on the stack copy of P, Unused always reads as 1.
+		flags = (p & (FLAG_I | FLAG_D)) | FLAG_U;
+		n = p;
+		z = ~p & FLAG_Z;
+		c = p & FLAG_C;
+		v = p << 1;
+	}
+
+	template<typename Memory>
+	void BasicCPU<Memory>::addDecimal(u8 m) {
+		const u8 a { m_state.a };
+		const u8 carry { m_state.p.c };
+
+		// Z comes from the binary sum.
+		m_state.p.z = static_cast<u8>(a + m + carry);
+
+		u16 low = (a & 0x0f) + (m & 0x0f) + carry;
+		if (low >= 0x0a) {
+			low = ((low + 0x06) & 0x0f) + 0x10;
+		}
+		u16 sum = (a & 0xf0) + (m & 0xf0) + low;
+
+		// N and V come from the sum before the high digit is adjusted.
+		m_state.p.n = static_cast<u8>(sum);
+		m_state.p.v = (a ^ sum) & (m ^ sum);
+
+		if (sum >= 0xa0) {
+			sum += 0x60;
+		}
+		m_state.p.c = sum >= 0x100 ? 1 : 0;
+		m_state.a = sum & 0x00ff;
+	}
+
+	template<typename Memory>
+	void BasicCPU<Memory>::subtractDecimal(u8 m) {
+		const u8 a { m_state.a };
+		const u8 borrow = 1 - m_state.p.c;
+
+		// Every flag comes from the binary difference.
+		const u8 inverted = ~m;
+		const u16 binary = a + inverted + m_state.p.c;
+		m_state.p.c = binary >> 8;
+		m_state.p.v = (a ^ binary) & (inverted ^ binary);
+		setNZ(binary & 0x00ff);
+
+		s16 low = (a & 0x0f) - (m & 0x0f) - borrow;
+		if (low < 0) {
+			low = ((low - 0x06) & 0x0f) - 0x10;
+		}
+		s16 difference = (a & 0xf0) - (m & 0xf0) + low;
+		if (difference < 0) {
+			difference -= 0x60;
+		}
+		m_state.a = difference & 0x00ff;
+	}
+
+	template<typename Memory>
+	template<typename Policy>
+	u8 BasicCPU<Memory>::memRead(u16 addr, bool ro) const {
 		assert(m_bus != nullptr);
-		return m_bus->cpuRead(addr, ro);
+		return m_bus->template cpuRead<Policy>(addr, ro);
 	}
 
-	u16 CPU::memRead16(u16 addr, bool ro) const {
+	template<typename Memory>
+	template<typename Policy>
+	u16 BasicCPU<Memory>::memRead16(u16 addr, bool ro) const {
 		assert(m_bus != nullptr);
-		return m_bus->cpuRead16(addr, ro);
+		return m_bus->template cpuRead16<Policy>(addr, ro);
+	}
+
+	template<typename Memory>
+	template<typename Policy>
+	u16 BasicCPU<Memory>::memReadZp16(u8 ptr) const {
+		const u8 low { memRead<Policy>(ptr) };
+		return (memRead<Policy>(static_cast<u8>(ptr + 1)) << 8) | low;
 	}
 
-	void CPU::memWrite(u16 addr, u8 data) {
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::memWrite(u16 addr, u8 data) {
 		assert(m_bus != nullptr);
-		m_bus->cpuWrite(addr, data);
+		m_bus->template cpuWrite<Policy>(addr, data);
 	}
 
-	void CPU::stackPush(u8 data) {
-		memWrite(0x0100 + m_reg.sp, data);
-		m_reg.sp -= 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::stackPush(u8 data) {
+		memWrite<Policy>(0x0100 + m_state.sp, data);
+		m_state.sp -= 1;
 	}
 
-	void CPU::stackPush16(u16 data) {
-		stackPush((data >> 8) & 0x00ff);
-		stackPush(data & 0x00ff);
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::stackPush16(u16 data) {
+		stackPush<Policy>((data >> 8) & 0x00ff);
+		stackPush<Policy>(data & 0x00ff);
 	}
 
-	u8 CPU::stackPop() {
-		m_reg.sp += 1;
-		return memRead(0x0100 + m_reg.sp);
+	template<typename Memory>
+	template<typename Policy>
+	u8 BasicCPU<Memory>::stackPop() {
+		m_state.sp += 1;
+		return memRead<Policy>(0x0100 + m_state.sp);
 	}
 
-	u16 CPU::stackPop16() {
-		auto l { stackPop() };
-		auto h { stackPop() };
+	template<typename Memory>
+	template<typename Policy>
+	u16 BasicCPU<Memory>::stackPop16() {
+		auto l { stackPop<Policy>() };
+		auto h { stackPop<Policy>() };
 		return (h << 8) | l;
 	}
 
-	std::tuple<u16, bool> CPU::getOperandAddress(AddressingMode mode) {
+	template<typename Memory>
+	template<typename Policy>
+	std::tuple<u16, bool> BasicCPU<Memory>::getOperandAddress(AddressingMode mode) {
+		State& state { m_state };
 		u16 addr {};
 		bool page_crossed { false };
 
 		switch (mode) {
 		case AddressingMode::IMP: // FALLTHROUGH
 		case AddressingMode::ACC:
+			if constexpr (Policy::dummy_reads) {
+				// One-byte instructions still fetch the byte after the opcode.
+				std::ignore = memRead<Policy>(state.pc);
+			}
 			break;
 		case AddressingMode::IMM:
-			addr = m_reg.pc;
-			m_reg.pc += 1;
+			addr = state.pc;
+			state.pc += 1;
 
 			break;
 		case AddressingMode::REL:
-			addr = memRead(m_reg.pc);
-			m_reg.pc += 1;
+			addr = memRead<Policy>(state.pc);
+			state.pc += 1;
 
 			if (addr & 0x80) {
 				addr |= 0xff00;
 			}
 			break;
 		case AddressingMode::ZP0:
-			addr = memRead(m_reg.pc) & 0x00ff;
-			m_reg.pc += 1;
+			addr = memRead<Policy>(state.pc) & 0x00ff;
+			state.pc += 1;
 			break;
 		case AddressingMode::ZPX:
-			addr = (memRead(m_reg.pc) + m_reg.x) & 0x00ff;
-			m_reg.pc += 1;
+			addr = (memRead<Policy>(state.pc) + state.x) & 0x00ff;
+			state.pc += 1;
 			break;
 		case AddressingMode::ZPY:
-			addr = (memRead(m_reg.pc) + m_reg.y) & 0x00ff;
-			m_reg.pc += 1;
+			addr = (memRead<Policy>(state.pc) + state.y) & 0x00ff;
+			state.pc += 1;
 			break;
 		case AddressingMode::ABS:
-			addr = memRead16(m_reg.pc);
-			m_reg.pc += 2;
+			addr = memRead16<Policy>(state.pc);
+			state.pc += 2;
 			break;
 		case AddressingMode::ABX:
-			addr = memRead16(m_reg.pc) + m_reg.x;
-			m_reg.pc += 2;
-			page_crossed = isPageCrossed(addr - m_reg.x, addr);
+			addr = memRead16<Policy>(state.pc) + state.x;
+			state.pc += 2;
+			page_crossed = isPageCrossed(addr - state.x, addr);
 			break;
 		case AddressingMode::ABY:
-			addr = memRead16(m_reg.pc) + m_reg.y;
-			m_reg.pc += 2;
-			page_crossed = isPageCrossed(addr - m_reg.y, addr);
+			addr = memRead16<Policy>(state.pc) + state.y;
+			state.pc += 2;
+			page_crossed = isPageCrossed(addr - state.y, addr);
 			break;
 		case AddressingMode::IND: {
-			auto ptr { memRead16(m_reg.pc) };
-			m_reg.pc += 2;
+			auto ptr { memRead16<Policy>(state.pc) };
+			state.pc += 2;
 
 			if ((ptr & 0x00ff) == 0x00ff) {
 				// HACK: Simulate page boundary hardware bug.
-				addr = (memRead(ptr & 0xff00) << 8) | memRead(ptr);
+				addr = (memRead<Policy>(ptr & 0xff00) << 8) | memRead<Policy>(ptr);
 			} else {
-				addr = memRead16(ptr);
+				addr = memRead16<Policy>(ptr);
 			}
 		} break;
 		case AddressingMode::IZX:
-			addr = memRead16(memRead(m_reg.pc) + m_reg.x);
-			m_reg.pc += 1;
+			addr = memReadZp16<Policy>(memRead<Policy>(state.pc) + state.x);
+			state.pc += 1;
 			break;
 		case AddressingMode::IZY:
-			addr = memRead16(memRead(m_reg.pc)) + m_reg.y;
-			page_crossed = isPageCrossed(addr - m_reg.y, addr);
-			m_reg.pc += 1;
+			addr = memReadZp16<Policy>(memRead<Policy>(state.pc)) + state.y;
+			page_crossed = isPageCrossed(addr - state.y, addr);
+			state.pc += 1;
 			break;
 		default:
 			break;
 		}
 
+		if constexpr (Policy::dummy_reads) {
+			// Indexed modes read the address before the high byte is fixed up: on a
+			// page cross, and always for stores and read-modify-write instructions
+			// (the ones without a page crossing penalty).
+			const bool indexed {
+				mode == AddressingMode::ABX || mode == AddressingMode::ABY
+				|| mode == AddressingMode::IZY
+			};
+			if (indexed && (page_crossed || m_instruction.page_cycles == 0)) {
+				const u8 index { mode == AddressingMode::ABX ? state.x : state.y };
+				const u16 base = addr - index;
+				std::ignore = memRead<Policy>((base & 0xff00) | (addr & 0x00ff));
+			}
+		}
+
 		return std::make_tuple(addr, page_crossed);
 	}
 
 	// Instruction: Add with Carry In
 	// Result     : A = A + M + C
 	// Flags      : C, V, N, Z
-	void CPU::ADC(u16 addr) {
-		auto m { memRead(addr) };
-		auto sum { static_cast<u16>(m_reg.a + m + m_reg.p.c) };
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::ADC(u16 addr) {
+		auto m { memRead<Policy>(addr) };
+		if constexpr (Memory::decimal_mode) {
+			if (m_state.p.flags & Status::FLAG_D) {
+				addDecimal(m);
+				return;
+			}
+		}
+
+		auto sum { static_cast<u16>(m_state.a + m + m_state.p.c) };
 
-		m_reg.p.c = sum > 0xff;
-		m_reg.p.v = (m_reg.a ^ sum) & (m ^ sum) & 0x80 != 0x00;
+		m_state.p.c = sum >> 8;
+		m_state.p.v = (m_state.a ^ sum) & (m ^ sum); // Sign changed unexpectedly.
 
-		m_reg.a = sum & 0x00ff;
+		m_state.a = sum & 0x00ff;
 
-		m_reg.p.z = m_reg.a == 0x00;
-		m_reg.p.n = m_reg.a & 0x80;
+		setNZ(m_state.a);
 	}
 
 	// Instruction: Bitwise logical AND
 	// Result     : A = A & M
 	// Flags      : A, Z, N
-	void CPU::AND(u16 addr) {
-		m_reg.a &= memRead(addr);
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::AND(u16 addr) {
+		m_state.a &= memRead<Policy>(addr);
 
-		m_reg.p.z = m_reg.a == 0x00;
-		m_reg.p.n = m_reg.a & 0x80;
+		setNZ(m_state.a);
 	}
 
 	// Instruction: Arithmetic Shift Left
 	// Result     : A = A << 1 or M = M << 1
 	// Flags      : N, Z, C
-	void CPU::ASL(u16 addr) {
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::ASL(u16 addr) {
 		if (m_instruction.addressing == AddressingMode::ACC) {
-			m_reg.p.c = m_reg.a & 0x80;
-			m_reg.a <<= 1;
+			m_state.p.c = m_state.a >> 7;
+			m_state.a <<= 1;
 
-			m_reg.p.z = m_reg.a == 0x00;
-			m_reg.p.n = m_reg.a & 0x80;
+			setNZ(m_state.a);
 		} else {
-			auto m { memRead(addr) };
-			m_reg.p.z = m & 0x80;
+			auto m { memRead<Policy>(addr) };
+			m_state.p.c = m >> 7;
 			m <<= 1;
-			memWrite(addr, m);
+			memWrite<Policy>(addr, m);
 
-			m_reg.p.z = m == 0x00;
-			m_reg.p.n = m & 0x80;
+			setNZ(m);
 		}
 	}
 
 	// Instruction: Branch if Carry Clear
 	// Result     : if (C == 0) pc = addr
-	void CPU::BCC(u16 addr) {
-		if (!m_reg.p.c) {
-			m_reg.pc += addr;
-			m_cycles += isPageCrossed(m_reg.pc, m_reg.pc - addr) ? 2 : 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::BCC(u16 addr) {
+		if (!m_state.p.carry()) {
+			m_state.pc += addr;
+			m_state.cycles += isPageCrossed(m_state.pc, m_state.pc - addr) ? 2 : 1;
 		}
 	}
 
 	// Instruction: Branch if Carry Set
 	// Result     : if (C == 1) pc = addr
-	void CPU::BCS(u16 addr) {
-		if (m_reg.p.c) {
-			m_reg.pc += addr;
-			m_cycles += isPageCrossed(m_reg.pc, m_reg.pc - addr) ? 2 : 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::BCS(u16 addr) {
+		if (m_state.p.carry()) {
+			m_state.pc += addr;
+			m_state.cycles += isPageCrossed(m_state.pc, m_state.pc - addr) ? 2 : 1;
 		}
 	}
 
 	// Instruction: Branch if Equal
 	// Result     : if (Z == 1) pc = addr
-	void CPU::BEQ(u16 addr) {
-		if (m_reg.p.z) {
-			m_reg.pc += addr;
-			m_cycles += isPageCrossed(m_reg.pc, m_reg.pc - addr) ? 2 : 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::BEQ(u16 addr) {
+		if (m_state.p.zero()) {
+			m_state.pc += addr;
+			m_state.cycles += isPageCrossed(m_state.pc, m_state.pc - addr) ? 2 : 1;
 		}
 	}
 
 	// Instruction: Use ANDed A and value in Memory to set or clear Zero flag. Bits 7
 	//              and 6 of the value from memory are copied into the N and V flags
 	// Flags      : A&M, N=M7, V=M6
-	void CPU::BIT(u16 addr) {
-		auto m { memRead(addr) };
-		m_reg.p.z = (m & m_reg.a) == 0x00;
-		m_reg.p.v = m & 0x40;
-		m_reg.p.n = m & 0x80;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::BIT(u16 addr) {
+		auto m { memRead<Policy>(addr) };
+		m_state.p.z = m & m_state.a;
+		m_state.p.v = m << 1;
+		m_state.p.n = m;
 	}
 
 	// Instruction: Branch if Negative
 	// Result     : if (N == 1) pc = addr
-	void CPU::BMI(u16 addr) {
-		if (m_reg.p.n) {
-			m_reg.pc += addr;
-			m_cycles += isPageCrossed(m_reg.pc, m_reg.pc - addr) ? 2 : 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::BMI(u16 addr) {
+		if (m_state.p.negative()) {
+			m_state.pc += addr;
+			m_state.cycles += isPageCrossed(m_state.pc, m_state.pc - addr) ? 2 : 1;
 		}
 	}
 
 	// Instruction: Branch if Not Equal
 	// Result     : if (Z == 0) pc = addr
-	void CPU::BNE(u16 addr) {
-		if (!m_reg.p.z) {
-			m_reg.pc += addr;
-			m_cycles += isPageCrossed(m_reg.pc, m_reg.pc - addr) ? 2 : 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::BNE(u16 addr) {
+		if (!m_state.p.zero()) {
+			m_state.pc += addr;
+			m_state.cycles += isPageCrossed(m_state.pc, m_state.pc - addr) ? 2 : 1;
 		}
 	}
 
 	// Instruction: Branch if Positive
 	// Result     : if (N == 0) pc = addr
-	void CPU::BPL(u16 addr) {
-		if (!m_reg.p.n) {
-			m_reg.pc += addr;
-			m_cycles += isPageCrossed(m_reg.pc, m_reg.pc - addr) ? 2 : 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::BPL(u16 addr) {
+		if (!m_state.p.negative()) {
+			m_state.pc += addr;
+			m_state.cycles += isPageCrossed(m_state.pc, m_state.pc - addr) ? 2 : 1;
 		}
 	}
 
 	// Instruction: Break
 	// Result     : Program sourced interrupt
-	void CPU::BRK(u16 /*unused*/) {
-		m_reg.p.i = true;
-		stackPush16(m_reg.pc);
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::BRK(u16 /*unused*/) {
+		// BRK is 2 bytes long: RTI skips the padding byte after the opcode.
+		stackPush16<Policy>(m_state.pc + 1);
 
-		stackPush(m_reg.p.raw);
+		stackPush<Policy>(m_state.p.pack() | 0x30); // 0bxx11xxxx, Unused = 1, Break = 1
+		m_state.p.flags |= Status::FLAG_I;
 
-		m_reg.pc = memRead16(0xfffe);
+		m_state.pc = memRead16<Policy>(0xfffe);
 	}
 
 	// Instruction: Branch if Overflow Clear
 	// Result     : if (V == 0) pc = addr
-	void CPU::BVC(u16 addr) {
-		if (!m_reg.p.v) {
-			m_reg.pc += addr;
-			m_cycles += isPageCrossed(m_reg.pc, m_reg.pc - addr) ? 2 : 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::BVC(u16 addr) {
+		if (!m_state.p.overflow()) {
+			m_state.pc += addr;
+			m_state.cycles += isPageCrossed(m_state.pc, m_state.pc - addr) ? 2 : 1;
 		}
 	}
 
 	// Instruction: Branch if Overflow Set
 	// Result     : if (V == 1) pc = addr
-	void CPU::BVS(u16 addr) {
-		if (m_reg.p.v) {
-			m_reg.pc += addr;
-			m_cycles += isPageCrossed(m_reg.pc, m_reg.pc - addr) ? 2 : 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::BVS(u16 addr) {
+		if (m_state.p.overflow()) {
+			m_state.pc += addr;
+			m_state.cycles += isPageCrossed(m_state.pc, m_state.pc - addr) ? 2 : 1;
 		}
 	}
 
 	// Instruction: Clear Carry Flag
 	// Result     : C = 0
-	void CPU::CLC(u16 /*unused*/) {
-		m_reg.p.c = 0;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::CLC(u16 /*unused*/) {
+		m_state.p.c = 0;
 	}
 
 	// Instruction: Clear Decimal Flag
 	// Result     : D = 0
-	void CPU::CLD(u16 /*unused*/) {
-		m_reg.p.c = 0;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::CLD(u16 /*unused*/) {
+		m_state.p.flags &= ~Status::FLAG_D;
 	}
 
 	// Instruction: Clear Interrupt Flag
 	// Result     : I = 0
-	void CPU::CLI(u16 /*unused*/) {
-		m_reg.p.i = 0;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::CLI(u16 /*unused*/) {
+		m_state.p.flags &= ~Status::FLAG_I;
 	}
 
 	// Instruction: Clear Overflow Flag
 	// Result     : V = 0
-	void CPU::CLV(u16 /*unused*/) {
-		m_reg.p.v = 0;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::CLV(u16 /*unused*/) {
+		m_state.p.v = 0;
 	}
 
 	// Instruction: Compare accumulator
 	// Result     : C <- A >= M    Z <- A == M
 	// Flags      : C, Z, N
-	void CPU::CMP(u16 addr) {
-		auto m { memRead(addr) };
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::CMP(u16 addr) {
+		auto m { memRead<Policy>(addr) };
 
-		m_reg.p.c = m_reg.a >= m;
-		m_reg.p.z = m_reg.a == m;
-		m_reg.p.n = (m_reg.a - m) & 0x80;
+		m_state.p.c = m_state.a >= m;
+		setNZ(m_state.a - m);
 	}
 
 	// Instruction: Compare X register
 	// Result     : C <- X >= M    Z <- X == M
 	// Flags      : C, Z, N
-	void CPU::CPX(u16 addr) {
-		auto m { memRead(addr) };
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::CPX(u16 addr) {
+		auto m { memRead<Policy>(addr) };
 
-		m_reg.p.c = m_reg.x >= m;
-		m_reg.p.z = m_reg.x == m;
-		m_reg.p.n = (m_reg.x - m) & 0x80;
+		m_state.p.c = m_state.x >= m;
+		setNZ(m_state.x - m);
 	}
 
 	// Instruction: Compare Y register
 	// Result     : C <- Y >= M    Z <- Y == M
 	// Flags      : C, Z, N
-	void CPU::CPY(u16 addr) {
-		auto m { memRead(addr) };
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::CPY(u16 addr) {
+		auto m { memRead<Policy>(addr) };
 
-		m_reg.p.c = m_reg.y >= m;
-		m_reg.p.z = m_reg.y == m;
-		m_reg.p.n = (m_reg.y - m) & 0x80;
+		m_state.p.c = m_state.y >= m;
+		setNZ(m_state.y - m);
 	}
 
 	// Instruction: Decrement value at memory location
 	// Result     : M = M - 1
 	// Flags      : Z, N
-	void CPU::DEC(u16 addr) {
-		auto m { memRead(addr) };
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::DEC(u16 addr) {
+		auto m { memRead<Policy>(addr) };
 		m -= 1;
-		memWrite(addr, m);
+		memWrite<Policy>(addr, m);
 
-		m_reg.p.z = m == 0x00;
-		m_reg.p.n = m & 0x80;
+		setNZ(m);
 	}
 
 	// Instruction: Decrement X register
 	// Result     : X = X - 1
 	// Flags      : Z, N
-	void CPU::DEX(u16 /*unused*/) {
-		m_reg.x -= 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::DEX(u16 /*unused*/) {
+		m_state.x -= 1;
 
-		m_reg.p.z = m_reg.x == 0x00;
-		m_reg.p.n = m_reg.x & 0x80;
+		setNZ(m_state.x);
 	}
 
 	// Instruction: Decrement Y register
 	// Result     : Y = Y - 1
 	// Flags      : Z, N
-	void CPU::DEY(u16 /*unused*/) {
-		m_reg.y -= 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::DEY(u16 /*unused*/) {
+		m_state.y -= 1;
 
-		m_reg.p.z = m_reg.y == 0x00;
-		m_reg.p.n = m_reg.y & 0x80;
+		setNZ(m_state.y);
 	}
 
 	// Instruction: Bitwise logic XOR
 	// Result     : A = A xor M
 	// Flags      : Z, N
-	void CPU::EOR(u16 addr) {
-		m_reg.a ^= memRead(addr);
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::EOR(u16 addr) {
+		m_state.a ^= memRead<Policy>(addr);
 
-		m_reg.p.z = m_reg.a == 0x00;
-		m_reg.p.n = m_reg.a & 0x80;
+		setNZ(m_state.a);
 	}
 
 	// Instruction: Increment value at memory location
 	// Result     : M = M + 1
 	// Flags      : Z, N
-	void CPU::INC(u16 addr) {
-		auto m { memRead(addr) };
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::INC(u16 addr) {
+		auto m { memRead<Policy>(addr) };
 		m += 1;
-		memWrite(addr, m);
+		memWrite<Policy>(addr, m);
 
-		m_reg.p.z = m == 0x00;
-		m_reg.p.n = m & 0x80;
+		setNZ(m);
 	}
 
 	// Instruction: Increment X register by 1
 	// Result     : X + 1
 	// Flags      : Z, N
-	void CPU::INX(u16 /*unused*/) {
-		m_reg.x += 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::INX(u16 /*unused*/) {
+		m_state.x += 1;
 
-		m_reg.p.z = m_reg.x == 0x00;
-		m_reg.p.n = m_reg.x & 0x80;
+		setNZ(m_state.x);
 	}
 
 	// Instruction: Increment Y register by 1
 	// Result     : Y + 1
 	// Flags      : Z, N
-	void CPU::INY(u16 /*unused*/) {
-		m_reg.y += 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::INY(u16 /*unused*/) {
+		m_state.y += 1;
 
-		m_reg.p.z = m_reg.y == 0x00;
-		m_reg.p.n = m_reg.y & 0x80;
+		setNZ(m_state.y);
 	}
 
 	// Instruction: Jump to location
 	// Result     : PC = addr
-	void CPU::JMP(u16 addr) {
-		m_reg.pc = addr;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::JMP(u16 addr) {
+		m_state.pc = addr;
 	}
 
 	// Instruction: Jump to sub-routine
 	// Result     : Push PC - 1; PC = addr
-	void CPU::JSR(u16 addr) {
-		stackPush16(m_reg.pc - 1);
-		m_reg.pc = addr;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::JSR(u16 addr) {
+		stackPush16<Policy>(m_state.pc - 1);
+		m_state.pc = addr;
 	}
 
 	// Instruction: Load the accumulator
 	// Result     : A = M
 	// Flags      : Z, N
-	void CPU::LDA(u16 addr) {
-		m_reg.a = memRead(addr);
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::LDA(u16 addr) {
+		m_state.a = memRead<Policy>(addr);
 
-		m_reg.p.z = m_reg.a == 0x00;
-		m_reg.p.n = m_reg.a & 0x80;
+		setNZ(m_state.a);
 	}
 
 	// Instruction: Load the X register
 	// Result     : X = M
 	// Flags      : Z, N
-	void CPU::LDX(u16 addr) {
-		m_reg.x = memRead(addr);
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::LDX(u16 addr) {
+		m_state.x = memRead<Policy>(addr);
 
-		m_reg.p.z = m_reg.x == 0x00;
-		m_reg.p.n = m_reg.x & 0x80;
+		setNZ(m_state.x);
 	}
 
 	// Instruction: Load the Y register
 	// Result     : Y = M
 	// Flags      : Z, N
-	void CPU::LDY(u16 addr) {
-		m_reg.y = memRead(addr);
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::LDY(u16 addr) {
+		m_state.y = memRead<Policy>(addr);
 
-		m_reg.p.z = m_reg.y == 0x00;
-		m_reg.p.n = m_reg.y & 0x80;
+		setNZ(m_state.y);
 	}
 
 	// Instruction: Arithmetic Shift Right
 	// Result     : A = A >> 1 or M = M >> 1
 	// Flags      : N, Z, C
-	void CPU::LSR(u16 addr) {
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::LSR(u16 addr) {
 		if (m_instruction.addressing == AddressingMode::ACC) {
-			m_reg.p.c = m_reg.a & 0x01;
-			m_reg.a >>= 1;
+			m_state.p.c = m_state.a & 0x01;
+			m_state.a >>= 1;
 
-			m_reg.p.z = m_reg.a == 0x00;
-			m_reg.p.n = m_reg.a & 0x80;
+			setNZ(m_state.a);
 		} else {
-			auto m { memRead(addr) };
-			m_reg.p.c = m & 0x01;
+			auto m { memRead<Policy>(addr) };
+			m_state.p.c = m & 0x01;
 			m >>= 1;
-			memWrite(addr, m);
+			memWrite<Policy>(addr, m);
 
-			m_reg.p.z = m == 0x00;
-			m_reg.p.n = m & 0x80;
+			setNZ(m);
 		}
 	}
 
 	// Instruction: Simply do nothing
 	// Result     : Consume cycles
-	void CPU::NOP(u16 /*unused*/) {
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::NOP(u16 /*unused*/) {
 		// NOTE: DO NOTHING!
 	}
 
 	// Instruction: Bitwise logic OR
 	// Result     : A = A | M
 	// Flags      : N, Z
-	void CPU::ORA(u16 addr) {
-		m_reg.a |= memRead(addr);
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::ORA(u16 addr) {
+		m_state.a |= memRead<Policy>(addr);
 
-		m_reg.p.z = m_reg.a == 0x00;
-		m_reg.p.n = m_reg.a & 0x80;
+		setNZ(m_state.a);
 	}
 
 	// Instruction: Push accumulator to stack
 	// Result     : A -> Stack
-	void CPU::PHA(u16 /*unused*/) {
-		stackPush(m_reg.a);
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::PHA(u16 /*unused*/) {
+		stackPush<Policy>(m_state.a);
 	}
 
 	// Instruction: Push status register to stack
 	// Result     : Status -> Stack
-	void CPU::PHP(u16 /*unused*/) {
-		stackPush(m_reg.p.raw | 0x30); // 0bxx11xxxx, Unused = 1, Break = 1
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::PHP(u16 /*unused*/) {
+		stackPush<Policy>(m_state.p.pack() | 0x30); // 0bxx11xxxx, Unused = 1, Break = 1
 	}
 
 	// Instruction: Pull accumulator off stack
 	// Result     : A <- Stack
-	void CPU::PLA(u16 /*unused*/) {
-		m_reg.a = stackPop();
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::PLA(u16 /*unused*/) {
+		m_state.a = stackPop<Policy>();
 
-		m_reg.p.z = m_reg.a == 0x00;
-		m_reg.p.n = m_reg.a & 0x80;
+		setNZ(m_state.a);
 	}
 
 	// Instruction: Pull status register off stack
 	// Result     : Status <- Stack
-	void CPU::PLP(u16 /*unused*/) {
-		m_reg.p.raw = stackPop() | 0x20; // Unused bit is always on.
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::PLP(u16 /*unused*/) {
+		m_state.p.unpack(stackPop<Policy>()); // Unused bit is always on.
 	}
 
 	// Instruction: Move bits left and fill 7th bit with old carry value
 	// Result     : A = (A << 1) | OLD_C or M = (M << 1) | OLD_C
 	// Flags      : N, Z, C
-	void CPU::ROL(u16 addr) {
-		auto old_carry { m_reg.p.c };
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::ROL(u16 addr) {
+		auto old_carry { m_state.p.c };
 
 		if (m_instruction.addressing == AddressingMode::ACC) {
-			m_reg.p.c = m_reg.a & 0x80;
-			m_reg.a = (m_reg.a << 1) | old_carry;
+			m_state.p.c = m_state.a >> 7;
+			m_state.a = (m_state.a << 1) | old_carry;
 
-			m_reg.p.z = m_reg.a == 0x00;
-			m_reg.p.n = m_reg.a & 0x80;
+			setNZ(m_state.a);
 		} else {
-			auto m { memRead(addr) };
-			m_reg.p.c = m & 0x80;
+			auto m { memRead<Policy>(addr) };
+			m_state.p.c = m >> 7;
 			m = (m << 1) | old_carry;
-			memWrite(addr, m);
+			memWrite<Policy>(addr, m);
 
-			m_reg.p.z = m == 0x00;
-			m_reg.p.n = m & 0x80;
+			setNZ(m);
 		}
 	}
 
 	// Instruction: Move bits right and fill bit 0 with old carry value
 	// Result     : A = (A >> 1) | (OLD_C >> 7) or M = (M >> 1) | (OLD_C >> 7)
 	// Flags      : N, Z, C
-	void CPU::ROR(u16 addr) {
-		auto old_carry { m_reg.p.c << 7 };
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::ROR(u16 addr) {
+		auto old_carry { m_state.p.c << 7 };
 
 		if (m_instruction.addressing == AddressingMode::ACC) {
-			m_reg.p.c = m_reg.a & 0x01;
-			m_reg.a = (m_reg.a >> 1) | old_carry;
+			m_state.p.c = m_state.a & 0x01;
+			m_state.a = (m_state.a >> 1) | old_carry;
 
-			m_reg.p.z = m_reg.a == 0x00;
-			m_reg.p.n = m_reg.a & 0x80;
+			setNZ(m_state.a);
 		} else {
-			auto m { memRead(addr) };
-			m_reg.p.c = m & 0x01;
+			auto m { memRead<Policy>(addr) };
+			m_state.p.c = m & 0x01;
 			m = (m >> 1) | old_carry;
-			memWrite(addr, m);
+			memWrite<Policy>(addr, m);
 
-			m_reg.p.z = m == 0x00;
-			m_reg.p.n = m & 0x80;
+			setNZ(m);
 		}
 	}
 
 	// Instruction: Return from interrupt.
 	// Result     : Status <- Stack and PC <- Stack
-	void CPU::RTI(u16 /*unused*/) {
-		m_reg.p.raw = stackPop() | 0x20; // Unused bit is always on.
-		m_reg.pc = stackPop16();
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::RTI(u16 /*unused*/) {
+		m_state.p.unpack(stackPop<Policy>()); // Unused bit is always on.
+		m_state.pc = stackPop16<Policy>();
 	}
 
 	// Instruction: Return from sub-routine
 	// Result     : PC <- Stack
-	void CPU::RTS(u16 /*unused*/) {
-		m_reg.pc = stackPop16() + 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::RTS(u16 /*unused*/) {
+		m_state.pc = stackPop16<Policy>() + 1;
 	}
 
 	// Instruction: Subtract with Borrow In
 	// Result     : A = A - M - (1 - C)
 	// Flags      : C, V, N, Z
-	void CPU::SBC(u16 addr) {
-		auto m { memRead(addr) };
-		u16 result { static_cast<u16>(static_cast<u16>(m_reg.a) - m - (1 - m_reg.p.c)) };
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::SBC(u16 addr) {
+		if constexpr (Memory::decimal_mode) {
+			if (m_state.p.flags & Status::FLAG_D) {
+				subtractDecimal(memRead<Policy>(addr));
+				return;
+			}
+		}
 
-		m_reg.p.c = result > 0xff;
-		m_reg.p.v = ((m_reg.a ^ result) & (~m ^ result) & 0x80) != 0x00;
+		// A - M - (1 - C) == A + ~M + C, with C meaning "no borrow".
+		auto m { static_cast<u8>(~memRead<Policy>(addr)) };
+		auto result { static_cast<u16>(m_state.a + m + m_state.p.c) };
 
-		m_reg.a = result & 0x00ff;
+		m_state.p.c = result >> 8;
+		m_state.p.v = (m_state.a ^ result) & (m ^ result);
 
-		m_reg.p.z = m_reg.a == 0x00;
-		m_reg.p.n = m_reg.a & 0x80;
+		m_state.a = result & 0x00ff;
+
+		setNZ(m_state.a);
 	}
 
 	// Instruction: Set Carry flag
 	// Result     : C = 1
-	void CPU::SEC(u16 /*unused*/) {
-		m_reg.p.c = 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::SEC(u16 /*unused*/) {
+		m_state.p.c = 1;
 	}
 
 	// Instruction: Set Decimal flag
 	// Result     : D = 1
-	void CPU::SED(u16 /*unused*/) {
-		m_reg.p.d = 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::SED(u16 /*unused*/) {
+		m_state.p.flags |= Status::FLAG_D;
 	}
 
 	// Instruction: Set Interrupt flag
 	// Result     : I = 1
-	void CPU::SEI(u16 /*unused*/) {
-		m_reg.p.i = 1;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::SEI(u16 /*unused*/) {
+		m_state.p.flags |= Status::FLAG_I;
 	}
 
 	// Instruction: Stores the contents of the Accumulator into memory.
 	// Result     : M = A
-	void CPU::STA(u16 addr) {
-		memWrite(addr, m_reg.a);
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::STA(u16 addr) {
+		memWrite<Policy>(addr, m_state.a);
 	}
 
 	// Instruction: Stores the contents of the X register into memory.
 	// Result     : M = X
-	void CPU::STX(u16 addr) {
-		memWrite(addr, m_reg.x);
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::STX(u16 addr) {
+		memWrite<Policy>(addr, m_state.x);
 	}
 
 	// Instruction: Stores the contents of the Y register into memory.
 	// Result     : M = Y
-	void CPU::STY(u16 addr) {
-		memWrite(addr, m_reg.y);
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::STY(u16 addr) {
+		memWrite<Policy>(addr, m_state.y);
 	}
 
 	// Instruction: Copy contents of the Accumulator into the X register.
 	// Result     : X = A
 	// Flags      : Z, N
-	void CPU::TAX(u16 /*unused*/) {
-		m_reg.x = m_reg.a;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::TAX(u16 /*unused*/) {
+		m_state.x = m_state.a;
 
-		m_reg.p.z = m_reg.x == 0x00;
-		m_reg.p.n = m_reg.x & 0x80;
+		setNZ(m_state.x);
 	}
 
 	// Instruction: Copy contents of the Accumulator into the Y register.
 	// Result     : Y = A
 	// Flags      : Z, N
-	void CPU::TAY(u16 /*unused*/) {
-		m_reg.y = m_reg.a;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::TAY(u16 /*unused*/) {
+		m_state.y = m_state.a;
 
-		m_reg.p.z = m_reg.y == 0x00;
-		m_reg.p.n = m_reg.y & 0x80;
+		setNZ(m_state.y);
 	}
 
 	// Instruction: Copy contents of the Stack Pointer into the X register.
 	// Result     : X = SP
 	// Flags      : Z, N
-	void CPU::TSX(u16 /*unused*/) {
-		m_reg.x = m_reg.sp;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::TSX(u16 /*unused*/) {
+		m_state.x = m_state.sp;
 
-		m_reg.p.z = m_reg.x == 0x00;
-		m_reg.p.n = m_reg.x & 0x80;
+		setNZ(m_state.x);
 	}
 
 	// Instruction: Copy contents of the X register into the Accumulator.
 	// Result     : A = X
 	// Flags      : Z, N
-	void CPU::TXA(u16 /*unused*/) {
-		m_reg.a = m_reg.x;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::TXA(u16 /*unused*/) {
+		m_state.a = m_state.x;
 
-		m_reg.p.z = m_reg.a == 0x00;
-		m_reg.p.n = m_reg.a & 0x80;
+		setNZ(m_state.a);
 	}
 
 	// Instruction: Copy contents of the X register into the Stack Pointer.
 	// Result     : SP = X
-	void CPU::TXS(u16 /*unused*/) {
-		m_reg.sp = m_reg.x;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::TXS(u16 /*unused*/) {
+		m_state.sp = m_state.x;
 	}
 
 	// Instruction: Copy contents of the Y register into the Accumulator.
 	// Result     : A = Y
 	// Flags      : Z, N
-	void CPU::TYA(u16 /*unused*/) {
-		m_reg.a = m_reg.y;
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::TYA(u16 /*unused*/) {
+		m_state.a = m_state.y;
 
-		m_reg.p.z = m_reg.a == 0x00;
-		m_reg.p.n = m_reg.a & 0x80;
+		setNZ(m_state.a);
 	}
 
 	// Instruction: Simply do nothing
 	// Result     : Cycles wasted, have a good day!
 	// Flags      : Nothing is changed, okay?
-	void CPU::NIL(u16 /* unused */) {
+	template<typename Memory>
+	template<typename Policy>
+	void BasicCPU<Memory>::NIL(u16 /* unused */) {
 		// HEY MAN, THIS FUNCTION DOES NOTHING!
 	}
+
+	template class BasicCPU<Bus>;
+	template class BasicCPU<FlatBus>;
 } // namespace nes
@@ -1,8 +1,15 @@
 #include "nes/Cartridge.hpp"
 
-#include "spdlog/spdlog.h"
+#include "common/Diag.hpp"
+#include "common/Hash.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <fstream>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
 
 namespace {
 	// iNES format header:
@@ -29,6 +36,32 @@ namespace {
 	};
 
 	constexpr u32 constant_name { 0x1a53454e };
+
+	// Images in use, by content hash. Entries expire with the last console
+	// holding the image.
+	std::mutex images_mutex {};
+	std::unordered_multimap<u64, std::weak_ptr<const nes::Cartridge>> images {};
+
+	[[nodiscard]] u64 contentHash(const nes::Cartridge& cartridge) {
+		const std::array<u8, 5> header {
+			cartridge.prg_banks,
+			cartridge.chr_banks,
+			cartridge.mapper_id,
+			static_cast<u8>(cartridge.mirroring),
+			cartridge.battery,
+		};
+
+		u64 seed { hash::xxh64(header.data(), header.size()) };
+		seed = hash::xxh64(cartridge.prg_data.data(), cartridge.prg_data.size(), seed);
+		return hash::xxh64(cartridge.chr_data.data(), cartridge.chr_data.size(), seed);
+	}
+
+	[[nodiscard]] bool sameContent(const nes::Cartridge& a, const nes::Cartridge& b) {
+		return a.prg_banks == b.prg_banks && a.chr_banks == b.chr_banks
+		    && a.mapper_id == b.mapper_id && a.mirroring == b.mirroring
+		    && a.battery == b.battery && a.prg_data == b.prg_data
+		    && a.chr_data == b.chr_data;
+	}
 } // namespace
 
 // NOTE: I think some machines will be unable to run cartridges, but...
@@ -38,76 +71,129 @@ namespace nes {
 	std::optional<Cartridge> Cartridge::loadFile(std::string_view path) {
 		std::ifstream file(path.data(), std::ifstream::in | std::ifstream::binary);
 		if (!file) {
-			spdlog::error("Cannot open the nes file from {}", path);
+			NES_ERROR("Cannot open the nes file from {}", path);
 			return {};
 		}
 
-		spdlog::info("Reading NES file...");
+		std::vector<u8> image { std::istreambuf_iterator<char>(file), {} };
+		file.close();
+
+		return loadMemory(image.data(), image.size());
+	}
+
+	std::optional<Cartridge> Cartridge::loadMemory(const u8 *data, std::size_t size) {
+		// Never trust the header: every read is checked against the image size.
+		std::size_t offset { 0 };
+		auto take { [&](void *dest, std::size_t count) {
+			if (size - offset < count) {
+				return false;
+			}
+			std::memcpy(dest, data + offset, count);
+			offset += count;
+			return true;
+		} };
 
 		INESHeader header {};
-		file.read(reinterpret_cast<char *>(&header), sizeof(INESHeader));
-		if (!file) {
-			spdlog::error("Reading the NES file header failed!");
+		if (data == nullptr || !take(&header, sizeof(INESHeader))) {
+			NES_ERROR("Reading the NES file header failed!");
 			return {};
 		}
 
 		if (header.name != constant_name) {
-			spdlog::error(
+			NES_ERROR(
 				"Not a valid .nes file: the constant is {:#08x}, expect {:#08x}",
 				header.name, constant_name
 			);
 			return {};
 		}
 
+		if (header.prg_banks == 0) {
+			NES_ERROR("Cartridge has no PRG ROM!");
+			return {};
+		}
+
 		// Get mapper number.
 		u8 mapper_lo = (header.flag6 >> 4) & 0x0F;
 		u8 mapper_hi = (header.flag7 >> 4) & 0x0F;
 		u8 mapper_id = (mapper_hi << 4) | mapper_lo;
-		spdlog::info("Cartridge Mapper number is {}.", mapper_id);
+		NES_DEBUG("Cartridge Mapper number is {}.", mapper_id);
 
 		// Get mirroring type.
 		// 0: horizontal (vertical arrangement) (CIRAM A10 = PPU A11)
 		// 1: vertical (horizontal arrangement) (CIRAM A10 = PPU A10)
 		Mirroring mirroring_type { header.flag6 & 0x01 ? VERTICAL : HORIZONTAL };
-		spdlog::info(
+		NES_DEBUG(
 			"Cartridge mirroring type is {}.",
 			header.flag6 & 0x01 ? "Vertical" : "Horizontal"
 		);
 
 		// Persistent memory.
 		if ((header.flag6 & 0x02)) {
-			spdlog::info("Cartridge contains battery-backed PRG RAM ($6000-7fff) or "
-			             "other Persistent memory.");
+			NES_DEBUG("Cartridge contains battery-backed PRG RAM ($6000-7fff) or "
+			          "other Persistent memory.");
 		}
 
 		// Check if "trainer" is present.
 		if (header.flag6 & 0x04) {
-			spdlog::info("Cartridge have trainer! Skipping...");
-			file.seekg(512, std::ios_base::cur);
+			NES_DEBUG("Cartridge have trainer! Skipping...");
+			if (size - offset < 512) {
+				NES_ERROR("Failed to read trainer data!");
+				return {};
+			}
+			offset += 512;
 		}
 
 		// Read PRG data.
 		std::vector<u8> prg_data(header.prg_banks * 0x4000); // PRG_BANKS * 16384
-		file.read(reinterpret_cast<char *>(prg_data.data()), prg_data.size());
-		if (!file) {
-			spdlog::info("Failed to read PRG ROM data!");
+		if (!take(prg_data.data(), prg_data.size())) {
+			NES_ERROR("Failed to read PRG ROM data!");
 			return {};
 		}
-		spdlog::info("Cartridge PRG ROM size is {} KB.", prg_data.size() / 1024);
-
-		// Read CHR data.
-		std::vector<u8> chr_data(header.chr_banks * 0x2000); // CHR_BANKS * 8192
-		file.read(reinterpret_cast<char *>(chr_data.data()), chr_data.size());
-		if (!file) {
-			spdlog::info("Failed to read CHR ROM data!");
+		NES_DEBUG("Cartridge PRG ROM size is {} KB.", prg_data.size() / 1024);
+
+		// Read CHR data, a board without CHR ROM has 8 KB of CHR RAM instead.
+		std::vector<u8> chr_data(std::max(header.chr_banks, u8 { 1 }) * 0x2000);
+		if (header.chr_banks == 0) {
+			NES_DEBUG("Cartridge uses 8 KB of CHR RAM.");
+		} else if (!take(chr_data.data(), chr_data.size())) {
+			NES_ERROR("Failed to read CHR ROM data!");
 			return {};
+		} else {
+			NES_DEBUG("Cartridge CHR ROM size is {} KB.", chr_data.size() / 1024);
 		}
-		spdlog::info("Cartridge CHR ROM size is {} KB.", chr_data.size() / 1024);
 
-		file.close();
+		NES_INFO(
+			"Cartridge: mapper {}, {} KB PRG ROM, {} KB CHR {}", mapper_id,
+			prg_data.size() / 1024, chr_data.size() / 1024,
+			header.chr_banks == 0 ? "RAM" : "ROM"
+		);
+
 		return Cartridge {
 			header.prg_banks, header.chr_banks,    mapper_id,
 			mirroring_type,   std::move(prg_data), std::move(chr_data),
+			(header.flag6 & 0x02) != 0,
 		};
 	}
+
+	CartridgeImage Cartridge::share(Cartridge cartridge) {
+		const u64 key { contentHash(cartridge) };
+
+		const std::lock_guard<std::mutex> lock { images_mutex };
+		for (auto it { images.begin() }; it != images.end();) {
+			it = it->second.expired() ? images.erase(it) : std::next(it);
+		}
+
+		const auto [first, last] { images.equal_range(key) };
+		for (auto it { first }; it != last; ++it) {
+			// Compare the content too, a hash collision must not swap games.
+			auto image { it->second.lock() };
+			if (image && sameContent(*image, cartridge)) {
+				return image;
+			}
+		}
+
+		auto image { std::make_shared<const Cartridge>(std::move(cartridge)) };
+		images.emplace(key, image);
+		return image;
+	}
 } // namespace nes
@@ -0,0 +1,51 @@
+#include "nes/FrameLog.hpp"
+
+#include <algorithm>
+
+namespace nes {
+	void FrameLog::connect(
+		const u8 *vram, const u8 *chr_ram, const u8 *palette, const u8 *oam
+	) {
+		const auto region { [](const u8 *base, u16 size, u16 offset) {
+			return Region { reinterpret_cast<std::uintptr_t>(base), size, offset };
+		} };
+
+		m_regions = {
+			region(vram, FRAME_LOG_CHR_RAM - FRAME_LOG_VRAM, FRAME_LOG_VRAM),
+			region(chr_ram, FRAME_LOG_PALETTE - FRAME_LOG_CHR_RAM, FRAME_LOG_CHR_RAM),
+			region(palette, FRAME_LOG_OAM - FRAME_LOG_PALETTE, FRAME_LOG_PALETTE),
+			region(oam, FRAME_LOG_MEMORY_SIZE - FRAME_LOG_OAM, FRAME_LOG_OAM),
+		};
+		abort();
+	}
+
+	void FrameLog::recordLine(
+		u16 line, u16 v, u8 x, u8 ctrl, u8 mask, const Mapper::PpuWindows& windows
+	) {
+		if (line == 0) {
+			for (const auto& region : m_regions) {
+				const auto *base { reinterpret_cast<const u8 *>(region.base) };
+				std::copy_n(base, region.size, m_memory.begin() + region.offset);
+			}
+			m_writes.clear();
+		} else if (line != m_next_line) {
+			abort();
+			return;
+		}
+
+		Line& record { m_lines[line] };
+		record.v = v;
+		record.x = x;
+		record.ctrl = ctrl;
+		record.mask = mask;
+		record.writes = static_cast<u32>(m_writes.size());
+
+		for (std::size_t slot { 0 }; slot < windows.size(); ++slot) {
+			const u16 offset { locate(windows[slot]) };
+			record.rom[slot] = offset == NOWHERE ? windows[slot] : nullptr;
+			record.ram[slot] = offset == NOWHERE ? 0 : offset;
+		}
+
+		m_next_line = line + 1;
+	}
+} // namespace nes
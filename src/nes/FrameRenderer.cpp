@@ -0,0 +1,139 @@
+#include "nes/FrameRenderer.hpp"
+
+#include <algorithm>
+
+namespace nes {
+	FrameRenderer::FrameRenderer(u32 threads)
+		: m_thread_count(std::clamp<u32>(threads, 1, FRAME_LOG_LINES)) {
+		for (u32 worker { 0 }; worker < m_thread_count; ++worker) {
+			m_threads.emplace_back(&FrameRenderer::run, this, worker);
+		}
+	}
+
+	FrameRenderer::~FrameRenderer() {
+		{
+			const std::lock_guard lock { m_mutex };
+			m_stop = true;
+		}
+		m_wake.notify_all();
+
+		for (auto& thread : m_threads) {
+			thread.join();
+		}
+	}
+
+	void FrameRenderer::connect(
+		const u8 *vram, const u8 *chr_ram, const u8 *palette, const u8 *oam
+	) {
+		finish();
+		for (auto& log : m_logs) {
+			log.connect(vram, chr_ram, palette, oam);
+		}
+	}
+
+	void FrameRenderer::endFrame() {
+		finish();
+
+		FrameLog& log { m_logs[m_recording] };
+		if (log.complete()) {
+			{
+				const std::lock_guard lock { m_mutex };
+				m_drawn_log = m_recording;
+				m_target = m_output ^ 1;
+				m_busy = getThreads();
+				m_in_flight = true;
+				m_generation += 1;
+				m_submitted = std::chrono::steady_clock::now();
+			}
+			m_wake.notify_all();
+			m_recording ^= 1;
+		}
+
+		// Whatever the log held, the next frame starts from scratch.
+		m_logs[m_recording].abort();
+	}
+
+	void FrameRenderer::finish() {
+		std::unique_lock lock { m_mutex };
+		if (!m_in_flight) {
+			return;
+		}
+
+		if (m_busy != 0) {
+			const auto start { std::chrono::steady_clock::now() };
+			m_done.wait(lock, [this] { return m_busy == 0; });
+			m_stall_time += std::chrono::steady_clock::now() - start;
+		}
+
+		m_output = m_target;
+		m_in_flight = false;
+		m_frames += 1;
+		m_draw_time += m_drawn - m_submitted;
+	}
+
+	void FrameRenderer::run(u32 worker) {
+		const u32 threads { getThreads() };
+		const u16 first = worker * FRAME_LOG_LINES / threads;
+		const u16 last = (worker + 1) * FRAME_LOG_LINES / threads;
+
+		u64 generation { 0 };
+		std::unique_lock lock { m_mutex };
+		while (true) {
+			m_wake.wait(lock, [&] { return m_stop || m_generation != generation; });
+			if (m_stop) {
+				return;
+			}
+			generation = m_generation;
+
+			// Neither the log nor the target change until every band is done.
+			const FrameLog& log { m_logs[m_drawn_log] };
+			const u8 target { m_target };
+			lock.unlock();
+			drawBand(log, first, last, target);
+			lock.lock();
+
+			m_busy -= 1;
+			if (m_busy == 0) {
+				m_drawn = std::chrono::steady_clock::now();
+				m_done.notify_one();
+			}
+		}
+	}
+
+	void FrameRenderer::drawBand(const FrameLog& log, u16 first, u16 last, u8 target) {
+		// The memories as they were when line 0 started, brought forward to the
+		// first line of the band.
+		FrameLog::Memory memory { log.getMemory() };
+		const auto& writes { log.getWrites() };
+		u32 applied { 0 };
+
+		PPU::Framebuffer& framebuffer { m_framebuffers[target] };
+		PPU::Emphasis& emphasis { m_emphasis[target] };
+
+		for (u16 line { first }; line < last; ++line) {
+			const FrameLog::Line& record { log.getLine(line) };
+			for (; applied < record.writes; ++applied) {
+				memory[writes[applied].offset] = writes[applied].data;
+			}
+
+			Mapper::PpuWindows windows {};
+			for (std::size_t slot { 0 }; slot < windows.size(); ++slot) {
+				windows[slot] = record.rom[slot] != nullptr
+				                  ? record.rom[slot]
+				                  : memory.data() + record.ram[slot];
+			}
+
+			const PPU::LineSource source {
+				record.v,
+				record.x,
+				record.ctrl,
+				record.mask,
+				memory.data() + FRAME_LOG_PALETTE,
+				memory.data() + FRAME_LOG_OAM,
+				windows,
+			};
+			emphasis[line] = record.mask >> 5;
+			PPU::drawLine(source, line, framebuffer.data() + line * PPU_SCREEN_WIDTH);
+		}
+	}
+} // namespace nes
@@ -0,0 +1,51 @@
+#include "nes/FrameSkip.hpp"
+
+#include <algorithm>
+
+namespace {
+	// Re-evaluate the interval twice per second of emulated time.
+	constexpr u32 window_frames { 30 };
+} // namespace
+
+namespace nes {
+	FrameSkip::FrameSkip(u32 interval) {
+		setInterval(interval);
+	}
+
+	void FrameSkip::setInterval(u32 interval) {
+		m_interval = std::clamp<u32>(interval, 1, MAX_INTERVAL);
+		m_counter = 0;
+	}
+
+	bool FrameSkip::nextFrame() {
+		const bool draw { m_counter == 0 };
+		m_counter = (m_counter + 1) % m_interval;
+		return draw;
+	}
+
+	void FrameSkip::frameTime(std::chrono::nanoseconds elapsed) {
+		if (m_target <= 0.0) {
+			return;
+		}
+
+		m_window_time += elapsed;
+		m_window_frames += 1;
+		if (m_window_frames < window_frames) {
+			return;
+		}
+
+		const double budget { NES_FRAME_NS / m_target };
+		const double average {
+			std::chrono::duration<double, std::nano>(m_window_time).count() / m_window_frames
+		};
+		m_window_time = {};
+		m_window_frames = 0;
+
+		// Skip more when behind, draw more again once there is clear headroom.
+		if (average > budget && m_interval < MAX_INTERVAL) {
+			m_interval += 1;
+		} else if (average < budget * 0.75 && m_interval > 1) {
+			m_interval -= 1;
+		}
+	}
+} // namespace nes
@@ -0,0 +1,79 @@
+#include "nes/HashLog.hpp"
+
+#include <array>
+#include <cstring>
+#include <string>
+
+namespace {
+	constexpr std::array<char, 8> magic { 'N', 'E', 'S', 'H', 'A', 'S', 'H', '1' };
+
+	// Flush to disk every 4096 frames (~68 seconds of emulation).
+	constexpr std::size_t buffered_frames { 4096 };
+} // namespace
+
+namespace nes {
+	HashLog::~HashLog() {
+		close();
+	}
+
+	bool HashLog::open(std::string_view path) {
+		close();
+
+		m_file.open(std::string { path }, std::ofstream::out | std::ofstream::binary);
+		if (!m_file) {
+			return false;
+		}
+
+		m_file.write(magic.data(), magic.size());
+		m_buffer.reserve(buffered_frames * sizeof(u64));
+
+		return static_cast<bool>(m_file);
+	}
+
+	void HashLog::append(u64 hash) {
+		for (int i { 0 }; i < 8; ++i) {
+			m_buffer.push_back(static_cast<u8>(hash >> (i * 8)));
+		}
+
+		if (m_buffer.size() >= buffered_frames * sizeof(u64)) {
+			flush();
+		}
+	}
+
+	void HashLog::close() {
+		if (m_file.is_open()) {
+			flush();
+			m_file.close();
+		}
+	}
+
+	void HashLog::flush() {
+		m_file.write(reinterpret_cast<const char *>(m_buffer.data()), m_buffer.size());
+		m_buffer.clear();
+	}
+
+	std::optional<std::vector<u64>> HashLog::readFile(std::string_view path) {
+		std::ifstream file(std::string { path }, std::ifstream::in | std::ifstream::binary);
+		if (!file) {
+			return {};
+		}
+
+		std::array<char, 8> header {};
+		file.read(header.data(), header.size());
+		if (!file || header != magic) {
+			return {};
+		}
+
+		std::vector<u64> hashes {};
+		std::array<u8, 8> word {};
+		while (file.read(reinterpret_cast<char *>(word.data()), word.size())) {
+			u64 hash {};
+			for (int i { 7 }; i >= 0; --i) {
+				hash = (hash << 8) | word.at(i);
+			}
+			hashes.push_back(hash);
+		}
+
+		return hashes;
+	}
+} // namespace nes
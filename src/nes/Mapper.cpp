@@ -1,31 +1,250 @@
 #include "nes/Mapper.hpp"
 
+#include "common/Diag.hpp"
+#include "common/Hash.hpp"
+#include "nes/mapper/AxROM.hpp"
+#include "nes/mapper/CNROM.hpp"
+#include "nes/mapper/MMC1.hpp"
+#include "nes/mapper/MMC3.hpp"
 #include "nes/mapper/NROM.hpp"
-#include "spdlog/spdlog.h"
+#include "nes/mapper/UxROM.hpp"
+
+#include <algorithm>
 
 namespace nes {
-	std::unique_ptr<Mapper> Mapper::create(Cartridge cartridge) {
-		switch (cartridge.mapper_id) {
+	std::unique_ptr<Mapper> Mapper::create(Cartridge cartridge, State& state) {
+		auto image { Cartridge::share(std::move(cartridge)) };
+		switch (image->mapper_id) {
 		case 0:
-			return std::make_unique<mapper::NROM>(std::move(cartridge));
+			return std::make_unique<mapper::NROM>(std::move(image), state);
+		case 1:
+			return std::make_unique<mapper::MMC1>(std::move(image), state);
+		case 2:
+			return std::make_unique<mapper::UxROM>(std::move(image), state);
+		case 3:
+			return std::make_unique<mapper::CNROM>(std::move(image), state);
+		case 4:
+			return std::make_unique<mapper::MMC3>(std::move(image), state);
+		case 7:
+			return std::make_unique<mapper::AxROM>(std::move(image), state);
 		default:
-			spdlog::error("No mapper available!");
+			NES_ERROR("No mapper available!");
 			return {};
 		}
 	}
 
-	Mapper::Mapper(Cartridge cartridge)
-		: m_cartridge(std::move(cartridge)) {}
+	Mapper::Mapper(CartridgeImage cartridge, State& state)
+		: m_cartridge(std::move(cartridge))
+		, m_state(state)
+		, m_mirroring(m_cartridge->mirroring) {
+		m_state = {};
+
+		// Power up as NROM (16 KB PRG is mirrored by the bank wrap around), boards
+		// re-point the windows they switch.
+		mapPrg32k(0);
+		mapChr8k(0);
+	}
+
+	Mapper::~Mapper() {
+		syncSaveRam(false);
+	}
+
+	u8 Mapper::cpuRead(u16 addr) {
+		if (addr >= 0x8000) {
+			return readPrg(addr);
+		}
+		if (addr >= 0x6000) {
+			return readPrgRam(addr);
+		}
+
+		return 0x00;
+	}
+
+	u8 Mapper::ppuRead(u16 addr) {
+		return readPpu(addr);
+	}
+
+	void Mapper::ppuWrite(u16 addr, u8 data) {
+		if (addr >= 0x2000) {
+			writeNametable(addr, data);
+		} else if (m_cartridge->chr_banks == 0) {
+			const auto offset { m_ppu_windows[addr >> 10] - m_state.chr_ram.data() };
+			m_state.chr_ram[offset + (addr & 0x03ff)] = data;
+		}
+	}
+
+	void Mapper::connectNametables(u8 *vram) {
+		m_vram = vram;
+		mapNametables();
+	}
+
+	u64 Mapper::hashState(u64 seed) const {
+		// CHR ROM never changes, only hash the CHR data when it is RAM.
+		if (m_cartridge->chr_banks == 0) {
+			seed = hash::xxh64(m_state.chr_ram.data(), m_state.chr_ram.size(), seed);
+		}
+
+		return hash::xxh64(m_state.prg_ram.data(), m_state.prg_ram.size(), seed);
+	}
+
+	void Mapper::markPrgRamChanges(const State& snapshot) {
+		if (!m_save_ram.isOpen()) {
+			return;
+		}
+
+		// A page left as it is keeps its dirty bit: clean, it still matches the
+		// file.
+		for (u32 page { 0 }; page < MAPPER_PRG_RAM_SIZE / SAVE_RAM_PAGE_SIZE; ++page) {
+			const u32 offset { page * SAVE_RAM_PAGE_SIZE };
+			const bool same { std::equal(
+				m_state.prg_ram.begin() + offset,
+				m_state.prg_ram.begin() + offset + SAVE_RAM_PAGE_SIZE,
+				snapshot.prg_ram.begin() + offset
+			) };
+			if (!same) {
+				m_prg_ram_dirty |= 1U << page;
+			}
+		}
+	}
+
+	void Mapper::loadState() {
+		updateBanks();
+	}
+
+	bool Mapper::mapSaveRam(std::string_view path) {
+		if (!m_save_ram.open(path, MAPPER_PRG_RAM_SIZE)) {
+			return false;
+		}
+
+		std::copy_n(m_save_ram.data(), MAPPER_PRG_RAM_SIZE, m_state.prg_ram.begin());
+		m_prg_ram_dirty = 0;
+		return true;
+	}
+
+	void Mapper::syncSaveRam(bool wait) {
+		if (!m_save_ram.isOpen()) {
+			return;
+		}
+
+		// Copy the modified pages into the file's mapping, from there they reach
+		// the page cache at once.
+		for (u32 page { 0 }; page < MAPPER_PRG_RAM_SIZE / SAVE_RAM_PAGE_SIZE; ++page) {
+			if (m_prg_ram_dirty & (1U << page)) {
+				const u32 offset { page * SAVE_RAM_PAGE_SIZE };
+				std::copy_n(
+					m_state.prg_ram.begin() + offset, SAVE_RAM_PAGE_SIZE,
+					m_save_ram.data() + offset
+				);
+			}
+		}
+
+		m_save_ram.sync(m_prg_ram_dirty, wait);
+		m_prg_ram_dirty = 0;
+	}
+
+	bool Mapper::hasBattery() const {
+		return m_cartridge->battery;
+	}
+
+	std::size_t Mapper::privateBytes() const {
+		// Board registers are a few bytes past the base class, not worth a
+		// virtual call to count. The state block is counted by the console.
+		return sizeof(Mapper);
+	}
+
+	std::size_t Mapper::sharedBytes() const {
+		return sizeof(Cartridge) + m_cartridge->prg_data.capacity()
+		     + m_cartridge->chr_data.capacity();
+	}
+
+	Cartridge::Mirroring Mapper::mirroringType() const {
+		return m_mirroring;
+	}
 
 	u8 Mapper::prgBanks() const {
-		return m_cartridge.prg_banks;
+		return m_cartridge->prg_banks;
 	}
 
 	u8 Mapper::chrBanks() const {
-		return m_cartridge.chr_banks;
+		return m_cartridge->chr_banks;
 	}
 
-	Cartridge::Mirroring Mapper::mirroringType() const {
-		return m_cartridge.mirroring;
+	void Mapper::mapPrg8k(u8 slot, u32 bank) {
+		const auto& prg { m_cartridge->prg_data };
+		const auto count { prg.size() / 0x2000 };
+		m_prg_windows.at(slot) = prg.data() + (bank % count) * 0x2000;
+	}
+
+	void Mapper::mapPrg16k(u8 slot, u32 bank) {
+		mapPrg8k(slot * 2, bank * 2);
+		mapPrg8k(slot * 2 + 1, bank * 2 + 1);
+	}
+
+	void Mapper::mapPrg32k(u32 bank) {
+		mapPrg16k(0, bank * 2);
+		mapPrg16k(1, bank * 2 + 1);
+	}
+
+	void Mapper::setMirroring(Cartridge::Mirroring mirroring) {
+		if (mirroring != m_mirroring) {
+			m_mirroring = mirroring;
+			mapNametables();
+		}
+	}
+
+	void Mapper::mapChr1k(u8 slot, u32 bank) {
+		const auto count { m_cartridge->chr_data.size() / MAPPER_PPU_WINDOW_SIZE };
+		m_ppu_windows.at(slot) = chrData() + (bank % count) * MAPPER_PPU_WINDOW_SIZE;
+	}
+
+	void Mapper::mapChr2k(u8 slot, u32 bank) {
+		mapChr1k(slot * 2, bank * 2);
+		mapChr1k(slot * 2 + 1, bank * 2 + 1);
+	}
+
+	void Mapper::mapChr4k(u8 slot, u32 bank) {
+		mapChr2k(slot * 2, bank * 2);
+		mapChr2k(slot * 2 + 1, bank * 2 + 1);
+	}
+
+	void Mapper::mapChr8k(u32 bank) {
+		mapChr4k(0, bank * 2);
+		mapChr4k(1, bank * 2 + 1);
+	}
+
+	void Mapper::mapNametables() {
+		if (m_vram == nullptr) {
+			return;
+		}
+
+		// Which 1 KB page of the RAM each of the four nametables shows.
+		std::array<u8, 4> pages {};
+		switch (m_mirroring) {
+		case Cartridge::HORIZONTAL:
+			pages = { 0, 0, 1, 1 };
+			break;
+		case Cartridge::VERTICAL:
+			pages = { 0, 1, 0, 1 };
+			break;
+		case Cartridge::ONE_SCREEN_LO:
+			pages = { 0, 0, 0, 0 };
+			break;
+		case Cartridge::ONE_SCREEN_HI:
+			pages = { 1, 1, 1, 1 };
+			break;
+		}
+
+		for (u8 table { 0 }; table < 4; ++table) {
+			m_nametables.at(table) = m_vram + pages.at(table) * MAPPER_PPU_WINDOW_SIZE;
+			m_ppu_windows.at(8 + table) = m_nametables.at(table);
+			m_ppu_windows.at(12 + table) = m_nametables.at(table);
+		}
+	}
+
+	const u8 *Mapper::chrData() const {
+		if (m_cartridge->chr_banks == 0) {
+			return m_state.chr_ram.data();
+		}
+		return m_cartridge->chr_data.data();
 	}
 } // namespace nes
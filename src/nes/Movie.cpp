@@ -0,0 +1,98 @@
+#include "nes/Movie.hpp"
+
+#include "common/Diag.hpp"
+#include "nes/Bus.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace {
+	// Gamepad fields list the buttons as "RLDUTSBA", from bit 7 (right) down to
+	// bit 0 (A). Anything but '.' or ' ' is a pressed button.
+	[[nodiscard]] u8 parseGamepad(std::string_view field) {
+		u8 buttons { 0 };
+		for (std::size_t i { 0 }; i < field.size() && i < 8; ++i) {
+			if (field[i] != '.' && field[i] != ' ') {
+				buttons |= static_cast<u8>(0x80 >> i);
+			}
+		}
+		return buttons;
+	}
+} // namespace
+
+namespace nes {
+	std::optional<Movie> Movie::loadFile(std::string_view path) {
+		std::ifstream file(path.data(), std::ifstream::in | std::ifstream::binary);
+		if (!file) {
+			NES_ERROR("Cannot open the movie file from {}", path);
+			return {};
+		}
+
+		const std::string text { std::istreambuf_iterator<char>(file), {} };
+		return parse(text);
+	}
+
+	std::optional<Movie> Movie::parse(std::string_view text) {
+		Movie movie {};
+
+		std::size_t line_number { 0 };
+		while (!text.empty()) {
+			const std::size_t end { std::min(text.find('\n'), text.size()) };
+			std::string_view line { text.substr(0, end) };
+			text.remove_prefix(std::min(end + 1, text.size()));
+			++line_number;
+
+			// Input records look like "|commands|port0|port1|port2|".
+			if (line.empty() || line.front() != '|') {
+				continue;
+			}
+
+			std::array<std::string_view, 3> fields {};
+			line.remove_prefix(1);
+			for (auto& field : fields) {
+				const std::size_t bar { line.find('|') };
+				if (bar == std::string_view::npos) {
+					NES_ERROR("Truncated movie input record on line {}", line_number);
+					return {};
+				}
+				field = line.substr(0, bar);
+				line.remove_prefix(bar + 1);
+			}
+
+			u8 commands { 0 };
+			for (const char digit : fields[0]) {
+				if (digit < '0' || digit > '9') {
+					NES_ERROR("Invalid movie command on line {}", line_number);
+					return {};
+				}
+				commands = static_cast<u8>(commands * 10 + (digit - '0'));
+			}
+
+			movie.m_frames.push_back({
+				commands,
+				{ parseGamepad(fields[1]), parseGamepad(fields[2]) },
+			});
+		}
+
+		return movie;
+	}
+
+	void Movie::apply(Bus& bus, u64 frame) const {
+		if (frame >= m_frames.size()) {
+			bus.setController(0, 0);
+			bus.setController(1, 0);
+			return;
+		}
+
+		const Frame& input { m_frames.at(frame) };
+		if (input.commands & COMMAND_HARD_RESET) {
+			bus.power();
+		} else if (input.commands & COMMAND_SOFT_RESET) {
+			bus.reset();
+		}
+		bus.setController(0, input.buttons[0]);
+		bus.setController(1, input.buttons[1]);
+	}
+} // namespace nes
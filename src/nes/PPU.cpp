@@ -0,0 +1,769 @@
+#include "nes/PPU.hpp"
+
+#include "common/Bits.hpp"
+#include "common/Hash.hpp"
+#include "nes/Bus.hpp"
+
+#include <cassert>
+#include <cstring>
+
+#ifdef SIMD_X86
+	#include <immintrin.h>
+#endif
+
+namespace {
+	// Bit order reversal of every byte, for horizontally flipped sprites.
+	constexpr std::array<u8, 256> reversed_bits { [] {
+		std::array<u8, 256> table {};
+		for (std::size_t value { 0 }; value < table.size(); ++value) {
+			for (std::size_t bit { 0 }; bit < 8; ++bit) {
+				if (value & (1 << bit)) {
+					table.at(value) |= 0x80 >> bit;
+				}
+			}
+		}
+		return table;
+	}() };
+
+	u64 spriteHitsScalar(const u8 *oam, u8 height, u16 line, u8 first) {
+		u64 hits { 0 };
+		for (u8 n { first }; n < 64; ++n) {
+			const u16 row = line - oam[n * 4];
+			if (row < height) {
+				hits |= u64 { 1 } << n;
+			}
+		}
+		return hits;
+	}
+
+	// A line to compose: background and sprite pixels as in `PPU::composeLine`,
+	// screen pixel x at index x, the clipped left columns and the colors.
+	struct Layers {
+		const u8 *background;
+		const u8 *sprites;
+		u8 background_left;
+		u8 sprites_left;
+		const u8 *palette;
+		u8 color_mask;
+	};
+
+	void composeScalar(const Layers& layers, u16 first, u8 *pixels) {
+		// Pixel stores may alias anything, keep the sources out of the loop.
+		const u8 *const background { layers.background };
+		const u8 *const sprites { layers.sprites };
+		const u8 background_left { layers.background_left };
+		const u8 sprites_left { layers.sprites_left };
+		const u8 *const palette { layers.palette };
+		const u8 color_mask { layers.color_mask };
+
+		for (u16 x { first }; x < PPU_SCREEN_WIDTH; ++x) {
+			const u8 bg { x >= background_left ? background[x] : u8 { 0 } };
+			const u8 sprite { x >= sprites_left ? sprites[x] : u8 { 0 } };
+
+			u8 entry { 0 };
+			if (sprite != 0 && (bg == 0 || !(sprite & 0x80))) {
+				entry = sprite & 0x1f;
+			} else if (bg != 0) {
+				entry = bg;
+			}
+
+			pixels[x] = palette[entry] & color_mask;
+		}
+	}
+
+#ifdef SIMD_X86
+	// 4 entries per step, Y being the low byte of each 32-bit lane: in range means
+	// line - height < Y <= line.
+	__attribute__((target("ssse3"))) u8
+	spriteHitsSsse3(const u8 *oam, u8 height, u16 line, u64& hits) {
+		const __m128i y_mask { _mm_set1_epi32(0xff) };
+		const __m128i last { _mm_set1_epi32(line) };
+		const __m128i before_first { _mm_set1_epi32(line - height) };
+
+		u8 n { 0 };
+		for (; n < 64; n += 4) {
+			const __m128i y { _mm_and_si128(
+				_mm_loadu_si128(reinterpret_cast<const __m128i *>(oam + n * 4)), y_mask
+			) };
+			const __m128i in_range { _mm_andnot_si128(
+				_mm_cmpgt_epi32(y, last), _mm_cmpgt_epi32(y, before_first)
+			) };
+			const auto bits {
+				static_cast<u32>(_mm_movemask_ps(_mm_castsi128_ps(in_range)))
+			};
+			hits |= u64 { bits } << n;
+		}
+
+		return n;
+	}
+
+	// 8 entries per step, as above.
+	__attribute__((target("avx2"))) u8
+	spriteHitsAvx2(const u8 *oam, u8 height, u16 line, u64& hits) {
+		const __m256i y_mask { _mm256_set1_epi32(0xff) };
+		const __m256i last { _mm256_set1_epi32(line) };
+		const __m256i before_first { _mm256_set1_epi32(line - height) };
+
+		u8 n { 0 };
+		for (; n < 64; n += 8) {
+			const __m256i y { _mm256_and_si256(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i *>(oam + n * 4)),
+				y_mask
+			) };
+			const __m256i in_range { _mm256_andnot_si256(
+				_mm256_cmpgt_epi32(y, last), _mm256_cmpgt_epi32(y, before_first)
+			) };
+			const auto bits {
+				static_cast<u32>(_mm256_movemask_ps(_mm256_castsi256_ps(in_range)))
+			};
+			hits |= u64 { bits } << n;
+		}
+
+		return n;
+	}
+
+	// 16 pixels per step. The sprite pixel wins where it is opaque, and in front
+	// or over a transparent background pixel. The palette lookup is the pshufb one
+	// of `video::convert`: the upper half is stored XORed with the lower one and
+	// indexed 16 lower, which gives zero for the lower half.
+	__attribute__((target("ssse3"))) u16 composeSsse3(const Layers& layers, u8 *pixels) {
+		const u8 *const background { layers.background };
+		const u8 *const sprites { layers.sprites };
+		const auto *palette { reinterpret_cast<const __m128i *>(layers.palette) };
+		const __m128i low_table { _mm_loadu_si128(palette) };
+		const __m128i high_table {
+			_mm_xor_si128(_mm_loadu_si128(palette + 1), low_table)
+		};
+
+		const __m128i zero { _mm_setzero_si128() };
+		const __m128i behind { _mm_set1_epi8(static_cast<char>(0x80)) };
+		const __m128i entry_mask { _mm_set1_epi8(0x1f) };
+		const __m128i half { _mm_set1_epi8(16) };
+		const __m128i color_mask { _mm_set1_epi8(static_cast<char>(layers.color_mask)) };
+
+		// Clipping only ever covers the first 8 columns.
+		__m128i background_clip { _mm_set_epi64x(0, layers.background_left ? -1 : 0) };
+		__m128i sprites_clip { _mm_set_epi64x(0, layers.sprites_left ? -1 : 0) };
+
+		u16 x { 0 };
+		for (; x + 16 <= PPU_SCREEN_WIDTH; x += 16) {
+			const __m128i bg { _mm_andnot_si128(
+				background_clip,
+				_mm_loadu_si128(reinterpret_cast<const __m128i *>(background + x))
+			) };
+			const __m128i sprite { _mm_andnot_si128(
+				sprites_clip,
+				_mm_loadu_si128(reinterpret_cast<const __m128i *>(sprites + x))
+			) };
+			background_clip = zero;
+			sprites_clip = zero;
+
+			const __m128i allowed { _mm_or_si128(
+				_mm_cmpeq_epi8(bg, zero),
+				_mm_cmpeq_epi8(_mm_and_si128(sprite, behind), zero)
+			) };
+			const __m128i wins {
+				_mm_andnot_si128(_mm_cmpeq_epi8(sprite, zero), allowed)
+			};
+			const __m128i entry { _mm_or_si128(
+				_mm_and_si128(wins, _mm_and_si128(sprite, entry_mask)),
+				_mm_andnot_si128(wins, bg)
+			) };
+
+			const __m128i color { _mm_xor_si128(
+				_mm_shuffle_epi8(low_table, entry),
+				_mm_shuffle_epi8(high_table, _mm_sub_epi8(entry, half))
+			) };
+			_mm_storeu_si128(
+				reinterpret_cast<__m128i *>(pixels + x), _mm_and_si128(color, color_mask)
+			);
+		}
+
+		return x;
+	}
+
+	// 32 pixels per step, as above with the palette in both lanes.
+	__attribute__((target("avx2"))) u16 composeAvx2(const Layers& layers, u8 *pixels) {
+		const u8 *const background { layers.background };
+		const u8 *const sprites { layers.sprites };
+		const auto *palette { reinterpret_cast<const __m128i *>(layers.palette) };
+		const __m128i low_half { _mm_loadu_si128(palette) };
+		const __m128i high_half { _mm_xor_si128(_mm_loadu_si128(palette + 1), low_half) };
+		const __m256i low_table { _mm256_broadcastsi128_si256(low_half) };
+		const __m256i high_table { _mm256_broadcastsi128_si256(high_half) };
+
+		const __m256i zero { _mm256_setzero_si256() };
+		const __m256i behind { _mm256_set1_epi8(static_cast<char>(0x80)) };
+		const __m256i entry_mask { _mm256_set1_epi8(0x1f) };
+		const __m256i half { _mm256_set1_epi8(16) };
+		const __m256i color_mask {
+			_mm256_set1_epi8(static_cast<char>(layers.color_mask))
+		};
+
+		__m256i background_clip {
+			_mm256_setr_epi64x(layers.background_left ? -1 : 0, 0, 0, 0)
+		};
+		__m256i sprites_clip {
+			_mm256_setr_epi64x(layers.sprites_left ? -1 : 0, 0, 0, 0)
+		};
+
+		u16 x { 0 };
+		for (; x + 32 <= PPU_SCREEN_WIDTH; x += 32) {
+			const __m256i bg { _mm256_andnot_si256(
+				background_clip,
+				_mm256_loadu_si256(reinterpret_cast<const __m256i *>(background + x))
+			) };
+			const __m256i sprite { _mm256_andnot_si256(
+				sprites_clip,
+				_mm256_loadu_si256(reinterpret_cast<const __m256i *>(sprites + x))
+			) };
+			background_clip = zero;
+			sprites_clip = zero;
+
+			const __m256i allowed { _mm256_or_si256(
+				_mm256_cmpeq_epi8(bg, zero),
+				_mm256_cmpeq_epi8(_mm256_and_si256(sprite, behind), zero)
+			) };
+			const __m256i wins {
+				_mm256_andnot_si256(_mm256_cmpeq_epi8(sprite, zero), allowed)
+			};
+			const __m256i entry {
+				_mm256_blendv_epi8(bg, _mm256_and_si256(sprite, entry_mask), wins)
+			};
+
+			const __m256i color { _mm256_xor_si256(
+				_mm256_shuffle_epi8(low_table, entry),
+				_mm256_shuffle_epi8(high_table, _mm256_sub_epi8(entry, half))
+			) };
+			_mm256_storeu_si256(
+				reinterpret_cast<__m256i *>(pixels + x),
+				_mm256_and_si256(color, color_mask)
+			);
+		}
+
+		return x;
+	}
+#endif
+} // namespace
+
+namespace nes {
+	PPU::PPU(State& state)
+		: m_state(state) {}
+
+	void PPU::connectBus(Bus *bus) {
+		m_bus = bus;
+		assert(m_bus != nullptr);
+	}
+
+	void PPU::reset() {
+		m_state.reg = Registers {};
+	}
+
+	u8 PPU::cpuRead(u8 reg, bool ro) {
+		// Write-only registers read back the open bus latch.
+		u8 data { m_state.reg.latch };
+
+		switch (reg & 0x07) {
+		case 2: // PPUSTATUS
+			data = (m_state.reg.status & 0xe0) | (m_state.reg.latch & 0x1f);
+			if (!ro) {
+				m_state.reg.status &= ~STATUS_VBLANK;
+				m_state.reg.w = 0;
+			}
+			break;
+		case 4: // OAMDATA
+			data = m_state.oam.at(m_state.reg.oam_addr);
+			break;
+		case 7: // PPUDATA
+			if ((m_state.reg.v & 0x3fff) >= 0x3f00) {
+				// Palette reads are not buffered, the buffer gets the nametable below.
+				data = m_state.palette.at(paletteIndex(m_state.reg.v));
+				if (!ro) {
+					m_state.reg.buffer = vramRead(m_state.reg.v - 0x1000);
+				}
+			} else {
+				data = m_state.reg.buffer;
+				if (!ro) {
+					m_state.reg.buffer = vramRead(m_state.reg.v);
+				}
+			}
+
+			if (!ro) {
+				const u16 step = (m_state.reg.ctrl & 0x04) ? 32 : 1;
+				m_state.reg.v = (m_state.reg.v + step) & 0x7fff;
+			}
+			break;
+		default:
+			break;
+		}
+
+		return data;
+	}
+
+	void PPU::cpuWrite(u8 reg, u8 data) {
+		m_state.reg.latch = data;
+
+		switch (reg & 0x07) {
+		case 0: // PPUCTRL
+			// Enabling NMI during vertical blank raises it immediately.
+			if (!(m_state.reg.ctrl & 0x80) && (data & 0x80)
+			    && (m_state.reg.status & STATUS_VBLANK)) {
+				m_state.reg.nmi = 1;
+			}
+
+			m_state.reg.ctrl = data;
+			m_state.reg.t = (m_state.reg.t & 0x73ff) | ((data & 0x03) << 10);
+			break;
+		case 1: // PPUMASK
+			m_state.reg.mask = data;
+			break;
+		case 3: // OAMADDR
+			m_state.reg.oam_addr = data;
+			break;
+		case 4: // OAMDATA
+			m_state.oam.at(m_state.reg.oam_addr) = data;
+			if (m_log != nullptr) {
+				m_log->write(&m_state.oam[m_state.reg.oam_addr], data);
+			}
+			m_state.reg.oam_addr += 1;
+			break;
+		case 5: // PPUSCROLL
+			if (m_state.reg.w == 0) {
+				m_state.reg.t = (m_state.reg.t & 0x7fe0) | (data >> 3);
+				m_state.reg.x = data & 0x07;
+			} else {
+				m_state.reg.t = (m_state.reg.t & 0x0c1f) | ((data & 0x07) << 12)
+				        | ((data & 0xf8) << 2);
+			}
+			m_state.reg.w ^= 1;
+			break;
+		case 6: // PPUADDR
+			if (m_state.reg.w == 0) {
+				m_state.reg.t = (m_state.reg.t & 0x00ff) | ((data & 0x3f) << 8);
+			} else {
+				m_state.reg.t = (m_state.reg.t & 0x7f00) | data;
+				m_state.reg.v = m_state.reg.t;
+			}
+			m_state.reg.w ^= 1;
+			break;
+		case 7: { // PPUDATA
+			vramWrite(m_state.reg.v, data);
+			const u16 step = (m_state.reg.ctrl & 0x04) ? 32 : 1;
+			m_state.reg.v = (m_state.reg.v + step) & 0x7fff;
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	void PPU::writeOamDma(const u8 *data) {
+		// OAMADDR ends where it started, after 256 increments.
+		const std::size_t head { m_state.oam.size() - m_state.reg.oam_addr };
+		std::memcpy(m_state.oam.data() + m_state.reg.oam_addr, data, head);
+		std::memcpy(m_state.oam.data(), data + head, m_state.reg.oam_addr);
+
+		if (m_log != nullptr) {
+			for (const u8& entry : m_state.oam) {
+				m_log->write(&entry, entry);
+			}
+		}
+	}
+
+	void PPU::setLog(FrameLog *log) {
+		if (log != nullptr && log != m_log) {
+			log->abort();
+		}
+		m_log = log;
+	}
+
+	PPU::LineTiming PPU::renderLine(u16 line) {
+		LineTiming timing {};
+		const LineSource source { liveSource() };
+		const simd::Isa isa { simd::bestIsa() };
+
+		// Deferred drawing records the line, only the timing is worked out here.
+		const bool draw { m_drawing && m_log == nullptr };
+		if (m_drawing) {
+			m_emphasis.at(line) = m_state.reg.mask >> 5;
+		}
+		// A frame not drawn misses its lines and is dropped.
+		if (m_drawing && m_log != nullptr) {
+			const Registers& reg { m_state.reg };
+			m_log->recordLine(line, reg.v, reg.x, reg.ctrl, reg.mask, source.windows);
+		}
+
+		if (!renderingEnabled()) {
+			if (draw) {
+				u8 *const pixels { m_framebuffer.data() + line * PPU_SCREEN_WIDTH };
+				drawLine(source, line, pixels, isa);
+			}
+			return timing;
+		}
+
+		const bool background { (m_state.reg.mask & MASK_BACKGROUND) != 0 };
+		const bool sprites { (m_state.reg.mask & MASK_SPRITES) != 0 };
+		const u8 height { spriteHeight(m_state.reg.ctrl) };
+
+		// The evaluation running during this line finds the sprites of the next one.
+		if (!(m_state.reg.status & STATUS_OVERFLOW)) {
+			const Evaluation found { evaluateSprites(source.oam, height, line, isa) };
+			timing.sprite_overflow = found.overflow;
+		}
+
+		// Sprites shown here were found during the previous line, the pre-render
+		// line does not evaluate any so line 0 has none. Sprite 0 is always found
+		// when it is in range, being the first one checked.
+		const u16 sprite0_row = line - 1 - m_state.oam[0];
+		const bool sprite0_shown { line > 0 && sprite0_row < height };
+		const bool hit_possible {
+			background && sprites && sprite0_shown
+			&& !(m_state.reg.status & STATUS_SPRITE0)
+		};
+		if (!draw && !hit_possible) {
+			return timing;
+		}
+
+		BackgroundRow row {};
+		if (background) {
+			fetchBackground(source, row);
+		}
+
+		// Sprite 0 hit: first opaque sprite 0 pixel over an opaque background pixel,
+		// outside the clipped left columns and never at x = 255.
+		if (hit_possible) {
+			constexpr u8 both_left { MASK_BACKGROUND_LEFT | MASK_SPRITES_LEFT };
+			const u8 left = (m_state.reg.mask & both_left) == both_left ? 0 : 8;
+			const auto pattern { spritePattern(source, 0, line) };
+			for (u16 i { 0 }; i < 8; ++i) {
+				const u16 x = m_state.oam[3] + i;
+				if (x >= PPU_SCREEN_WIDTH - 1) {
+					break;
+				}
+
+				const u8 bit = 0x80 >> i;
+				const bool opaque { ((pattern[0] | pattern[1]) & bit) != 0 };
+				if (x >= left && opaque && row[x + m_state.reg.x] != 0) {
+					timing.sprite0_hit = x + 1; // Pixel x comes out on dot x + 1.
+					break;
+				}
+			}
+		}
+
+		if (draw) {
+			composeLine(
+				source, line, row, m_framebuffer.data() + line * PPU_SCREEN_WIDTH, isa
+			);
+		}
+
+		return timing;
+	}
+
+	void PPU::drawLine(const LineSource& source, u16 line, u8 *pixels, simd::Isa isa) {
+		if (!(source.mask & (MASK_BACKGROUND | MASK_SPRITES))) {
+			std::memset(pixels, source.palette[0], PPU_SCREEN_WIDTH);
+			return;
+		}
+
+		BackgroundRow row {};
+		if (source.mask & MASK_BACKGROUND) {
+			fetchBackground(source, row);
+		}
+		composeLine(source, line, row, pixels, isa);
+	}
+
+	u64 PPU::spriteHits(const u8 *oam, u8 height, u16 line, simd::Isa isa) {
+		// The SIMD paths return how many entries they did, the scalar loop finishes.
+		u64 hits { 0 };
+		u8 done { 0 };
+#ifdef SIMD_X86
+		if (isa == simd::Isa::AVX2) {
+			done = spriteHitsAvx2(oam, height, line, hits);
+		} else if (isa == simd::Isa::SSSE3) {
+			done = spriteHitsSsse3(oam, height, line, hits);
+		}
+#endif
+		return hits | spriteHitsScalar(oam, height, line, done);
+	}
+
+	void PPU::composeLine(
+		const LineSource& source, u16 line, const BackgroundRow& row, u8 *pixels,
+		simd::Isa isa
+	) {
+		// Sprite pixels: palette << 2 | pattern (palettes 4-7), the lowest OAM index
+		// wins. Bit 7 marks sprites behind the background.
+		std::array<u8, PPU_SCREEN_WIDTH> sprite_row {};
+		if ((source.mask & MASK_SPRITES) && line > 0) {
+			const Evaluation shown {
+				evaluateSprites(source.oam, spriteHeight(source.ctrl), line - 1, isa)
+			};
+			for (u8 n { 0 }; n < shown.count; ++n) {
+				const u8 index { shown.sprites[n] };
+				const u8 attributes { source.oam[index * 4 + 2] };
+				const u8 sprite_x { source.oam[index * 4 + 3] };
+				const auto pattern { spritePattern(source, index, line) };
+				const u8 flags = 0x10 | ((attributes & 0x03) << 2)
+				               | ((attributes & 0x20) << 2);
+
+				for (u16 i { 0 }; i < 8; ++i) {
+					const u16 x = sprite_x + i;
+					if (x >= PPU_SCREEN_WIDTH) {
+						break;
+					}
+
+					const u8 bit = 0x80 >> i;
+					const u8 pixel = ((pattern[0] & bit) ? 1 : 0)
+					               | ((pattern[1] & bit) ? 2 : 0);
+					if (pixel != 0 && sprite_row[x] == 0) {
+						sprite_row[x] = flags | pixel;
+					}
+				}
+			}
+		}
+
+		const Layers layers {
+			row.data() + source.x,
+			sprite_row.data(),
+			static_cast<u8>((source.mask & MASK_BACKGROUND_LEFT) ? 0 : 8),
+			static_cast<u8>((source.mask & MASK_SPRITES_LEFT) ? 0 : 8),
+			source.palette,
+			static_cast<u8>((source.mask & MASK_GRAYSCALE) ? 0x30 : 0x3f),
+		};
+
+		// The SIMD paths return how many pixels they did, the scalar loop finishes.
+		u16 done { 0 };
+#ifdef SIMD_X86
+		if (isa == simd::Isa::AVX2) {
+			done = composeAvx2(layers, pixels);
+		} else if (isa == simd::Isa::SSSE3) {
+			done = composeSsse3(layers, pixels);
+		}
+#endif
+		composeScalar(layers, done, pixels);
+	}
+
+	void PPU::endLine(u16 line) {
+		if (!renderingEnabled()) {
+			return;
+		}
+
+		u16& v { m_state.reg.v };
+		if (line == PPU_PRERENDER_SCANLINE) {
+			// Dots 280-304 of the pre-render line: reload the vertical scroll too.
+			v = (v & ~0x7be0) | (m_state.reg.t & 0x7be0);
+		} else if ((v & 0x7000) != 0x7000) {
+			// Dot 256: next pixel row in the tile.
+			v += 0x1000;
+		} else {
+			// Next tile row, wrapping to the next nametable after row 29.
+			v &= ~0x7000;
+			u16 coarse_y = (v & 0x03e0) >> 5;
+			if (coarse_y == 29) {
+				coarse_y = 0;
+				v ^= 0x0800;
+			} else if (coarse_y == 31) {
+				coarse_y = 0;
+			} else {
+				coarse_y += 1;
+			}
+			v = (v & ~0x03e0) | (coarse_y << 5);
+		}
+
+		// Dot 257: reload the horizontal scroll.
+		v = (v & ~0x041f) | (m_state.reg.t & 0x041f);
+	}
+
+	void PPU::startVblank() {
+		m_state.reg.status |= STATUS_VBLANK;
+		if (m_state.reg.ctrl & 0x80) {
+			m_state.reg.nmi = 1;
+		}
+	}
+
+	void PPU::endVblank() {
+		m_state.reg.status &= ~(STATUS_VBLANK | STATUS_SPRITE0 | STATUS_OVERFLOW);
+	}
+
+	bool PPU::pollNmi() {
+		const bool nmi { m_state.reg.nmi != 0 };
+		m_state.reg.nmi = 0;
+		return nmi;
+	}
+
+	u64 PPU::hashState(u64 seed) const {
+		const Registers& reg { m_state.reg };
+
+		// Hash the registers field by field, the struct has padding.
+		const std::array<u8, 13> bytes {
+			reg.ctrl,
+			reg.mask,
+			reg.status,
+			reg.oam_addr,
+			static_cast<u8>(reg.v & 0x00ff),
+			static_cast<u8>(reg.v >> 8),
+			static_cast<u8>(reg.t & 0x00ff),
+			static_cast<u8>(reg.t >> 8),
+			reg.x,
+			reg.w,
+			reg.buffer,
+			reg.latch,
+			reg.nmi,
+		};
+
+		seed = hash::xxh64(bytes.data(), bytes.size(), seed);
+		seed = hash::xxh64(m_state.oam.data(), m_state.oam.size(), seed);
+		return hash::xxh64(m_state.palette.data(), m_state.palette.size(), seed);
+	}
+
+	PPU::LineSource PPU::liveSource() const {
+		const Registers& reg { m_state.reg };
+		return {
+			reg.v,
+			reg.x,
+			reg.ctrl,
+			reg.mask,
+			m_state.palette.data(),
+			m_state.oam.data(),
+			m_bus->getPpuWindows(),
+		};
+	}
+
+	PPU::Evaluation PPU::evaluateSprites(
+		const u8 *oam, u8 height, u16 line, simd::Isa isa
+	) {
+		Evaluation result {};
+
+		// The first 8 sprites in range are copied.
+		for (u64 hits { spriteHits(oam, height, line, isa) };
+		     hits != 0 && result.count < 8; hits &= hits - 1) {
+			result.sprites[result.count] = static_cast<u8>(
+				bits::countTrailingZeros(hits)
+			);
+			result.count += 1;
+		}
+
+		// Every sprite checked takes 2 dots from dot 65, copying one 6 more. The
+		// search stops right after the 8th one.
+		u8 n = result.count == 8 ? result.sprites[7] + 1 : 64;
+		u16 dot = 65 + n * 2 + result.count * 6;
+
+		// With 8 sprites found, the hardware keeps looking for a 9th one, but also
+		// steps the byte index within each entry, so it compares tile numbers,
+		// attributes and X positions as if they were Y coordinates.
+		for (u8 m { 0 }; n < 64; ++n) {
+			dot += 2;
+
+			const u16 row = line - oam[n * 4 + m];
+			if (row < height) {
+				result.overflow = dot;
+				break;
+			}
+			m = (m + 1) & 0x03;
+		}
+
+		return result;
+	}
+
+	void PPU::fetchBackground(const LineSource& source, BackgroundRow& row) {
+		// Banks cannot change within a line: fetch through the windows directly.
+		const Mapper::PpuWindows& windows { source.windows };
+		u16 v { source.v };
+		const u16 table = (source.ctrl & 0x10) ? 0x1000 : 0x0000;
+		const u16 fine_y = (v >> 12) & 0x07;
+
+		for (u16 tile { 0 }; tile < row.size() / 8; ++tile) {
+			const u8 name { Mapper::readPpu(windows, 0x2000 | (v & 0x0fff)) };
+			const u16 attribute_addr = 0x23c0 | (v & 0x0c00) | ((v >> 4) & 0x38)
+			                         | ((v >> 2) & 0x07);
+			const u8 shift = ((v >> 4) & 0x04) | (v & 0x02);
+			const u8 attribute { Mapper::readPpu(windows, attribute_addr) };
+			const u8 palette = ((attribute >> shift) & 0x03) << 2;
+
+			const u16 pattern_addr = table + name * 16 + fine_y;
+			const u8 lo { Mapper::readPpu(windows, pattern_addr) };
+			const u8 hi { Mapper::readPpu(windows, pattern_addr + 8) };
+
+			for (u16 i { 0 }; i < 8; ++i) {
+				const u8 pixel = ((lo >> (7 - i)) & 0x01)
+				               | (((hi >> (7 - i)) & 0x01) << 1);
+				row[tile * 8 + i] = pixel != 0 ? (palette | pixel) : 0;
+			}
+
+			// Coarse X, wrapping to the next nametable.
+			if ((v & 0x001f) == 31) {
+				v = (v & ~0x001f) ^ 0x0400;
+			} else {
+				v += 1;
+			}
+		}
+	}
+
+	std::array<u8, 2> PPU::spritePattern(const LineSource& source, u8 index, u16 line) {
+		const u8 y { source.oam[index * 4] };
+		const u8 tile { source.oam[index * 4 + 1] };
+		const u8 attributes { source.oam[index * 4 + 2] };
+		const u8 height { spriteHeight(source.ctrl) };
+
+		// Sprites are drawn one line below their OAM Y.
+		u16 row = line - y - 1;
+		if (attributes & 0x80) {
+			row = height - 1 - row;
+		}
+
+		u16 addr {};
+		if (height == 16) {
+			addr = ((tile & 0x01) ? 0x1000 : 0x0000) + (tile & 0xfe) * 16;
+			if (row >= 8) {
+				addr += 16;
+				row -= 8;
+			}
+		} else {
+			addr = ((source.ctrl & 0x08) ? 0x1000 : 0x0000) + tile * 16;
+		}
+
+		std::array<u8, 2> pattern {
+			Mapper::readPpu(source.windows, addr + row),
+			Mapper::readPpu(source.windows, addr + row + 8),
+		};
+		if (attributes & 0x40) {
+			// Horizontal flip.
+			pattern = { reversed_bits[pattern[0]], reversed_bits[pattern[1]] };
+		}
+
+		return pattern;
+	}
+
+	u8 PPU::vramRead(u16 addr) const {
+		assert(m_bus != nullptr);
+		return m_bus->ppuRead(addr & 0x3fff);
+	}
+
+	void PPU::vramWrite(u16 addr, u8 data) {
+		addr &= 0x3fff;
+		if (addr >= 0x3f00) {
+			u8& entry { m_state.palette.at(paletteIndex(addr)) };
+			entry = data & 0x3f;
+			if (m_log != nullptr) {
+				m_log->write(&entry, entry);
+			}
+			return;
+		}
+
+		assert(m_bus != nullptr);
+		if (m_log != nullptr) {
+			// The byte the write lands on, ignored when it is ROM.
+			const u8 *target { m_bus->getPpuWindows()[addr >> 10] + (addr & 0x03ff) };
+			m_log->write(target, data);
+		}
+		m_bus->ppuWrite(addr, data);
+	}
+
+	u8 PPU::paletteIndex(u16 addr) {
+		// $3f10/$3f14/$3f18/$3f1c mirror the background entries.
+		u8 index = addr & 0x1f;
+		if ((index & 0x13) == 0x10) {
+			index &= 0x0f;
+		}
+		return index;
+	}
+} // namespace nes
@@ -0,0 +1,35 @@
+#include "nes/RunAhead.hpp"
+
+namespace nes {
+	RunAhead::RunAhead(Bus& bus, u8 frames)
+		: m_bus(bus)
+		, m_frames(frames) {}
+
+	void RunAhead::runFrame(const PresentFn& present) {
+		// Only the presented frame is drawn.
+		m_bus.runFrame(m_frames == 0);
+		if (m_frames == 0) {
+			if (present) {
+				present(m_bus);
+			}
+			return;
+		}
+
+		// The frames run ahead are rolled back, their PRG RAM must not reach the
+		// save file.
+		m_bus.saveState(m_snapshot);
+		m_bus.setSpeculative(true);
+		for (u8 frame { 0 }; frame < m_frames; ++frame) {
+			m_bus.runFrame(frame + 1 == m_frames);
+		}
+
+		// A deferred renderer would otherwise still show the frame presented last
+		// time, one frame less ahead.
+		m_bus.finishDrawing();
+		if (present) {
+			present(m_bus);
+		}
+		m_bus.loadState(m_snapshot);
+		m_bus.setSpeculative(false);
+	}
+} // namespace nes
@@ -0,0 +1,162 @@
+#include "nes/SaveRam.hpp"
+
+#include "common/Diag.hpp"
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#else
+	#include <fstream>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+namespace nes {
+	SaveRam::~SaveRam() {
+		close();
+	}
+
+#ifndef _WIN32
+
+	bool SaveRam::open(std::string_view path, std::size_t size) {
+		close();
+
+		const std::string file_path { path };
+		const int fd { ::open(file_path.c_str(), O_RDWR | O_CREAT, 0644) };
+		if (fd < 0) {
+			NES_ERROR("Cannot open the save file {}: {}", path, std::strerror(errno));
+			return false;
+		}
+
+		struct stat info {};
+		if (::fstat(fd, &info) != 0
+		    || (static_cast<std::size_t>(info.st_size) != size
+		        && ::ftruncate(fd, static_cast<off_t>(size)) != 0)) {
+			NES_ERROR("Cannot size the save file {}: {}", path, std::strerror(errno));
+			::close(fd);
+			return false;
+		}
+
+		void *data { ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) };
+		// The mapping keeps the file alive.
+		::close(fd);
+		if (data == MAP_FAILED) {
+			NES_ERROR("Cannot map the save file {}: {}", path, std::strerror(errno));
+			return false;
+		}
+
+		m_data = static_cast<u8 *>(data);
+		m_size = size;
+		return true;
+	}
+
+	void SaveRam::sync(u32 pages, bool wait) {
+		if (m_data == nullptr || pages == 0) {
+			return;
+		}
+
+		// msync works on whole system pages, which may be larger than ours.
+		const auto system_page { static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)) };
+		const int flags { wait ? MS_SYNC : MS_ASYNC };
+
+		for (std::size_t page { 0 }; page * SAVE_RAM_PAGE_SIZE < m_size; ++page) {
+			if ((pages & (1U << page)) == 0) {
+				continue;
+			}
+
+			const std::size_t begin {
+				page * SAVE_RAM_PAGE_SIZE / system_page * system_page
+			};
+			const std::size_t end { std::min(m_size, (page + 1) * SAVE_RAM_PAGE_SIZE) };
+			if (::msync(m_data + begin, end - begin, flags) != 0) {
+				NES_WARN("Cannot sync the save file: {}", std::strerror(errno));
+			}
+		}
+	}
+
+	void SaveRam::close() {
+		if (m_data == nullptr) {
+			return;
+		}
+
+		::msync(m_data, m_size, MS_SYNC);
+		::munmap(m_data, m_size);
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+#else
+	bool SaveRam::open(std::string_view path, std::size_t size) {
+		close();
+
+		std::vector<u8> buffer(size, 0x00);
+		std::string file_path { path };
+		if (std::ifstream existing { file_path, std::ifstream::binary }) {
+			existing.read(
+				reinterpret_cast<char *>(buffer.data()),
+				static_cast<std::streamsize>(size)
+			);
+		}
+
+		// Create the file, or grow or shrink it, right away like the mapping does.
+		std::ofstream file { file_path, std::ofstream::binary | std::ofstream::trunc };
+		if (!file
+		    || !file.write(
+		        reinterpret_cast<const char *>(buffer.data()),
+		        static_cast<std::streamsize>(size)
+		    )) {
+			NES_ERROR("Cannot write the save file {}: {}", path, std::strerror(errno));
+			return false;
+		}
+
+		m_path = std::move(file_path);
+		m_buffer = std::move(buffer);
+		m_data = m_buffer.data();
+		m_size = size;
+		return true;
+	}
+
+	void SaveRam::sync(u32 pages, bool) {
+		if (m_data == nullptr || pages == 0) {
+			return;
+		}
+
+		std::fstream file {
+			m_path, std::fstream::binary | std::fstream::in | std::fstream::out
+		};
+		for (std::size_t page { 0 }; file && page * SAVE_RAM_PAGE_SIZE < m_size; ++page) {
+			if ((pages & (1U << page)) == 0) {
+				continue;
+			}
+
+			const std::size_t begin { page * SAVE_RAM_PAGE_SIZE };
+			const std::size_t end { std::min(m_size, begin + SAVE_RAM_PAGE_SIZE) };
+			file.seekp(static_cast<std::streamoff>(begin));
+			file.write(
+				reinterpret_cast<const char *>(m_data + begin),
+				static_cast<std::streamsize>(end - begin)
+			);
+		}
+		if (!file) {
+			NES_WARN("Cannot sync the save file {}: {}", m_path, std::strerror(errno));
+		}
+	}
+
+	void SaveRam::close() {
+		if (m_data == nullptr) {
+			return;
+		}
+
+		sync(~0U, true);
+		m_buffer = {};
+		m_path.clear();
+		m_data = nullptr;
+		m_size = 0;
+	}
+#endif
+} // namespace nes
@@ -0,0 +1,94 @@
+#include "nes/Scheduler.hpp"
+
+#include "common/Hash.hpp"
+
+#include <utility>
+
+namespace nes {
+	void Scheduler::schedule(Event event, u64 time) {
+		cancel(event);
+
+		m_heap.at(m_size) = Entry { time, event };
+		m_size += 1;
+		siftUp(m_size - 1);
+	}
+
+	void Scheduler::cancel(Event event) {
+		for (u8 i { 0 }; i < m_size; ++i) {
+			if (m_heap.at(i).event == event) {
+				remove(i);
+				return;
+			}
+		}
+	}
+
+	void Scheduler::clear() {
+		m_size = 0;
+	}
+
+	bool Scheduler::pop(u64 now, Event& event, u64& time) {
+		if (m_size == 0 || m_heap[0].time > now) {
+			return false;
+		}
+
+		event = m_heap[0].event;
+		time = m_heap[0].time;
+		remove(0);
+		return true;
+	}
+
+	u64 Scheduler::hashState(u64 seed) const {
+		// One deadline per event, entries have padding.
+		std::array<u64, static_cast<u8>(Event::COUNT)> deadlines {};
+		deadlines.fill(NEVER);
+		for (u8 i { 0 }; i < m_size; ++i) {
+			deadlines[static_cast<u8>(m_heap[i].event)] = m_heap[i].time;
+		}
+
+		return hash::xxh64(deadlines.data(), sizeof(deadlines), seed);
+	}
+
+	void Scheduler::remove(u8 index) {
+		m_size -= 1;
+		if (index == m_size) {
+			return;
+		}
+
+		m_heap.at(index) = m_heap.at(m_size);
+		siftUp(index);
+		siftDown(index);
+	}
+
+	void Scheduler::siftUp(u8 index) {
+		while (index > 0) {
+			const u8 parent = (index - 1) / 2;
+			if (m_heap.at(parent).time <= m_heap.at(index).time) {
+				break;
+			}
+
+			std::swap(m_heap.at(parent), m_heap.at(index));
+			index = parent;
+		}
+	}
+
+	void Scheduler::siftDown(u8 index) {
+		while (true) {
+			const u8 left = index * 2 + 1;
+			const u8 right = left + 1;
+			u8 smallest { index };
+
+			if (left < m_size && m_heap.at(left).time < m_heap.at(smallest).time) {
+				smallest = left;
+			}
+			if (right < m_size && m_heap.at(right).time < m_heap.at(smallest).time) {
+				smallest = right;
+			}
+			if (smallest == index) {
+				break;
+			}
+
+			std::swap(m_heap.at(smallest), m_heap.at(index));
+			index = smallest;
+		}
+	}
+} // namespace nes
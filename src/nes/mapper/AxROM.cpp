@@ -0,0 +1,29 @@
+#include "nes/mapper/AxROM.hpp"
+
+#include "common/Hash.hpp"
+
+namespace nes::mapper {
+	AxROM::AxROM(CartridgeImage cartridge, State& state)
+		: Mapper(std::move(cartridge), state)
+		, m_bank(emplaceRegisters<u8>()) {
+		updateBanks();
+	}
+
+	void AxROM::cpuWrite(u16 addr, u8 data) {
+		// Any write to ROM selects the PRG bank (bits 0-2) and the nametable (bit 4).
+		if (addr >= 0x8000) {
+			m_bank = data;
+			updateBanks();
+		}
+	}
+
+	u64 AxROM::hashState(u64 seed) const {
+		return hash::xxh64(&m_bank, sizeof(m_bank), Mapper::hashState(seed));
+	}
+
+	void AxROM::updateBanks() {
+		mapPrg32k(m_bank & 0x07);
+		const bool upper { (m_bank & 0x10) != 0 };
+		setMirroring(upper ? Cartridge::ONE_SCREEN_HI : Cartridge::ONE_SCREEN_LO);
+	}
+} // namespace nes::mapper
@@ -0,0 +1,27 @@
+#include "nes/mapper/CNROM.hpp"
+
+#include "common/Hash.hpp"
+
+namespace nes::mapper {
+	CNROM::CNROM(CartridgeImage cartridge, State& state)
+		: Mapper(std::move(cartridge), state)
+		, m_bank(emplaceRegisters<u8>()) {
+		updateBanks();
+	}
+
+	void CNROM::cpuWrite(u16 addr, u8 data) {
+		// Any write to ROM selects the CHR bank.
+		if (addr >= 0x8000) {
+			m_bank = data;
+			updateBanks();
+		}
+	}
+
+	u64 CNROM::hashState(u64 seed) const {
+		return hash::xxh64(&m_bank, sizeof(m_bank), Mapper::hashState(seed));
+	}
+
+	void CNROM::updateBanks() {
+		mapChr8k(m_bank);
+	}
+} // namespace nes::mapper
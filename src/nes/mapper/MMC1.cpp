@@ -0,0 +1,103 @@
+#include "nes/mapper/MMC1.hpp"
+
+#include "common/Hash.hpp"
+
+namespace nes::mapper {
+	MMC1::MMC1(CartridgeImage cartridge, State& state)
+		: Mapper(std::move(cartridge), state)
+		, m_reg(emplaceRegisters<Registers>()) {
+		updateBanks();
+	}
+
+	void MMC1::cpuWrite(u16 addr, u8 data) {
+		if (addr < 0x8000) {
+			return;
+		}
+
+		// Bit 7 resets the shift register and locks the last PRG bank at $c000.
+		if (data & 0x80) {
+			m_reg.shift = 0x10;
+			m_reg.control |= 0x0c;
+			updateBanks();
+			return;
+		}
+
+		// Bits enter at bit 4; the marker bit reaching bit 0 means this is the fifth
+		// write, and the value goes to the register selected by address bits 13-14.
+		const bool full { (m_reg.shift & 0x01) != 0 };
+		m_reg.shift = (m_reg.shift >> 1) | ((data & 0x01) << 4);
+		if (!full) {
+			return;
+		}
+
+		switch ((addr >> 13) & 0x03) {
+		case 0:
+			m_reg.control = m_reg.shift;
+			break;
+		case 1:
+			m_reg.chr0 = m_reg.shift;
+			break;
+		case 2:
+			m_reg.chr1 = m_reg.shift;
+			break;
+		case 3:
+			m_reg.prg = m_reg.shift;
+			break;
+		}
+
+		m_reg.shift = 0x10;
+		updateBanks();
+	}
+
+	u64 MMC1::hashState(u64 seed) const {
+		return hash::xxh64(&m_reg, sizeof(m_reg), Mapper::hashState(seed));
+	}
+
+	void MMC1::updateBanks() {
+		// Mirroring: 0: one-screen lower, 1: one-screen upper, 2: vertical,
+		// 3: horizontal.
+		switch (m_reg.control & 0x03) {
+		case 0:
+			setMirroring(Cartridge::ONE_SCREEN_LO);
+			break;
+		case 1:
+			setMirroring(Cartridge::ONE_SCREEN_HI);
+			break;
+		case 2:
+			setMirroring(Cartridge::VERTICAL);
+			break;
+		case 3:
+			setMirroring(Cartridge::HORIZONTAL);
+			break;
+		}
+
+		// 512 KB boards (SUROM) use CHR bit 4 to select the 256 KB PRG half.
+		const u32 outer { prgBanks() > 16 ? (m_reg.chr0 & 0x10) : 0u };
+		const u32 last { outer | ((prgBanks() - 1) & 0x0f) };
+		const u32 bank { outer | (m_reg.prg & 0x0f) };
+
+		switch ((m_reg.control >> 2) & 0x03) {
+		case 0: // FALLTHROUGH
+		case 1: // Switch 32 KB at $8000, ignoring the low bit.
+			mapPrg32k(bank >> 1);
+			break;
+		case 2: // Fix first bank at $8000, switch 16 KB at $c000.
+			mapPrg16k(0, outer);
+			mapPrg16k(1, bank);
+			break;
+		case 3: // Switch 16 KB at $8000, fix last bank at $c000.
+			mapPrg16k(0, bank);
+			mapPrg16k(1, last);
+			break;
+		}
+
+		if (m_reg.control & 0x10) {
+			// Two separate 4 KB banks.
+			mapChr4k(0, m_reg.chr0);
+			mapChr4k(1, m_reg.chr1);
+		} else {
+			// One 8 KB bank, ignoring the low bit.
+			mapChr8k(m_reg.chr0 >> 1);
+		}
+	}
+} // namespace nes::mapper
@@ -0,0 +1,99 @@
+#include "nes/mapper/MMC3.hpp"
+
+#include "common/Hash.hpp"
+
+namespace nes::mapper {
+	MMC3::MMC3(CartridgeImage cartridge, State& state)
+		: Mapper(std::move(cartridge), state)
+		, m_reg(emplaceRegisters<Registers>()) {
+		updateBanks();
+	}
+
+	void MMC3::cpuWrite(u16 addr, u8 data) {
+		if (addr < 0x8000) {
+			return;
+		}
+
+		// Registers are selected by the address range and whether it is even or odd.
+		const bool odd { (addr & 0x01) != 0 };
+		switch (addr & 0xe000) {
+		case 0x8000:
+			if (odd) {
+				m_reg.bank.at(m_reg.select & 0x07) = data;
+			} else {
+				m_reg.select = data;
+			}
+			updateBanks();
+			break;
+		case 0xa000:
+			// Odd: PRG RAM protect, PRG RAM is always enabled here.
+			if (!odd) {
+				m_reg.mirroring = data & 0x01;
+				updateBanks();
+			}
+			break;
+		case 0xc000:
+			if (odd) {
+				m_reg.irq_counter = 0;
+				m_reg.irq_reload = 1;
+			} else {
+				m_reg.irq_latch = data;
+			}
+			break;
+		case 0xe000:
+			m_reg.irq_enabled = odd;
+			if (!odd) {
+				m_reg.irq_pending = 0;
+			}
+			break;
+		}
+	}
+
+	void MMC3::scanline() {
+		if (m_reg.irq_counter == 0 || m_reg.irq_reload) {
+			m_reg.irq_counter = m_reg.irq_latch;
+			m_reg.irq_reload = 0;
+		} else {
+			m_reg.irq_counter -= 1;
+		}
+
+		if (m_reg.irq_counter == 0 && m_reg.irq_enabled) {
+			m_reg.irq_pending = 1;
+		}
+	}
+
+	bool MMC3::irqPending() const {
+		return m_reg.irq_pending;
+	}
+
+	u64 MMC3::hashState(u64 seed) const {
+		return hash::xxh64(&m_reg, sizeof(m_reg), Mapper::hashState(seed));
+	}
+
+	void MMC3::updateBanks() {
+		setMirroring(m_reg.mirroring ? Cartridge::HORIZONTAL : Cartridge::VERTICAL);
+
+		// PRG mode (bit 6): R6 at $8000 and the second to last bank at $c000, or
+		// swapped. R7 is always at $a000 and the last bank at $e000.
+		const u32 second_last { prgBanks() * 2u - 2 };
+		if (m_reg.select & 0x40) {
+			mapPrg8k(0, second_last);
+			mapPrg8k(2, m_reg.bank.at(6));
+		} else {
+			mapPrg8k(0, m_reg.bank.at(6));
+			mapPrg8k(2, second_last);
+		}
+		mapPrg8k(1, m_reg.bank.at(7));
+		mapPrg8k(3, second_last + 1);
+
+		// CHR inversion (bit 7): the two 2 KB banks (R0, R1) go to $1000 instead of
+		// $0000, and the four 1 KB banks (R2-R5) the other way around.
+		const u8 big { static_cast<u8>((m_reg.select & 0x80) ? 2 : 0) };
+		const u8 small { static_cast<u8>((m_reg.select & 0x80) ? 0 : 4) };
+		mapChr2k(big, m_reg.bank.at(0) >> 1);
+		mapChr2k(big + 1, m_reg.bank.at(1) >> 1);
+		for (u8 i { 0 }; i < 4; ++i) {
+			mapChr1k(small + i, m_reg.bank.at(2 + i));
+		}
+	}
+} // namespace nes::mapper
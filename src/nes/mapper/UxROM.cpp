@@ -0,0 +1,28 @@
+#include "nes/mapper/UxROM.hpp"
+
+#include "common/Hash.hpp"
+
+namespace nes::mapper {
+	UxROM::UxROM(CartridgeImage cartridge, State& state)
+		: Mapper(std::move(cartridge), state)
+		, m_bank(emplaceRegisters<u8>()) {
+		updateBanks();
+	}
+
+	void UxROM::cpuWrite(u16 addr, u8 data) {
+		// Any write to ROM selects the switchable bank.
+		if (addr >= 0x8000) {
+			m_bank = data;
+			updateBanks();
+		}
+	}
+
+	u64 UxROM::hashState(u64 seed) const {
+		return hash::xxh64(&m_bank, sizeof(m_bank), Mapper::hashState(seed));
+	}
+
+	void UxROM::updateBanks() {
+		mapPrg16k(0, m_bank);
+		mapPrg16k(1, prgBanks() - 1);
+	}
+} // namespace nes::mapper
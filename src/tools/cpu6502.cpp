@@ -0,0 +1,134 @@
+// cpu6502: run a 6502 test binary on the bare CPU core over a flat 64 KB RAM
+// (`nes::FlatBus`), and report the speed of the core itself, free of the PPU,
+// the mapper and the console's address decoding. CTest runs it on the image
+// written by `nes-6502-suite` (cpu_6502_functional), and on an external image
+// when NES_6502_TEST_IMAGE is set (cpu_6502_image), see cmake/cpu6502.cmake.
+//
+// The defaults fit Klaus Dormann's 6502_functional_test.bin: loaded at $0000,
+// started at $0400. Such tests report by trapping, a jump or branch to itself;
+// the test passed if the trap is at the `--success` address.
+
+#include "nes/CPU.hpp"
+#include "nes/FlatBus.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+namespace {
+	struct Options {
+		std::string_view image {};
+		u16 load { 0x0000 };
+		u16 start { 0x0400 };
+		u16 success { 0x3469 };
+		u64 max_instructions { 200'000'000 };
+	};
+
+	[[nodiscard]] u16 parseAddress(std::string_view value) {
+		return static_cast<u16>(std::strtoul(value.data(), nullptr, 16));
+	}
+
+	bool parseArguments(int argc, char *argv[], Options& options) {
+		if (argc < 2) {
+			return false;
+		}
+		options.image = argv[1];
+
+		for (int i { 2 }; i + 1 < argc; i += 2) {
+			const std::string_view arg { argv[i] };
+			const std::string_view value { argv[i + 1] };
+
+			if (arg == "--load") {
+				options.load = parseAddress(value);
+			} else if (arg == "--start") {
+				options.start = parseAddress(value);
+			} else if (arg == "--success") {
+				options.success = parseAddress(value);
+			} else if (arg == "--max-instructions") {
+				options.max_instructions = std::strtoull(value.data(), nullptr, 10);
+			} else {
+				return false;
+			}
+		}
+
+		return options.max_instructions > 0 && argc % 2 == 0;
+	}
+} // namespace
+
+int main(int argc, char *argv[]) {
+	Options options {};
+	if (!parseArguments(argc, argv, options)) {
+		std::fprintf(
+			stderr,
+			"Usage: %s <image> [--load <hex>] [--start <hex>] [--success <hex>] "
+			"[--max-instructions <n>]\n",
+			argv[0]
+		);
+		return 2;
+	}
+
+	std::ifstream file { options.image.data(), std::ios::binary };
+	if (!file) {
+		std::fprintf(stderr, "Cannot open %s\n", options.image.data());
+		return 2;
+	}
+	const std::vector<u8> image {
+		std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()
+	};
+
+	nes::FlatBus bus {};
+	bus.load(options.load, image.data(), image.size());
+
+	// The test sets up its own stack and flags, only the entry point matters.
+	nes::BasicCPU<nes::FlatBus>::State state {};
+	state.cycles = 0;
+	nes::BasicCPU<nes::FlatBus> cpu { state, nes::Accuracy::FAST };
+	cpu.connectBus(&bus);
+	cpu.setPC(options.start);
+
+	u64 instructions { 0 };
+	u64 cycles { 0 };
+	bool trapped { false };
+
+	const auto start { std::chrono::steady_clock::now() };
+	while (instructions < options.max_instructions) {
+		const u16 pc { cpu.getPC() };
+		cycles += cpu.run(1);
+		instructions += 1;
+
+		if (cpu.getPC() == pc) {
+			trapped = true;
+			break;
+		}
+	}
+	const std::chrono::duration<double> elapsed {
+		std::chrono::steady_clock::now() - start
+	};
+
+	const u16 pc { cpu.getPC() };
+	const bool passed { trapped && pc == options.success };
+	if (!trapped) {
+		std::printf(
+			"No trap after %llu instructions, PC $%04x\n",
+			static_cast<unsigned long long>(instructions), pc
+		);
+	} else if (!passed) {
+		std::printf("Trapped at $%04x, expected $%04x\n", pc, options.success);
+		std::printf("%s\n", cpu.getDebugString().c_str());
+	}
+
+	const double seconds { elapsed.count() };
+	std::printf(
+		"%s: %llu instructions, %llu cycles in %.3fs, %.1f MIPS, %.1f MHz\n",
+		passed ? "pass" : "FAIL", static_cast<unsigned long long>(instructions),
+		static_cast<unsigned long long>(cycles), seconds,
+		static_cast<double>(instructions) / seconds / 1e6,
+		static_cast<double>(cycles) / seconds / 1e6
+	);
+
+	return passed ? 0 : 1;
+}
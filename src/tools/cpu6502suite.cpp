@@ -0,0 +1,757 @@
+// cpu6502suite: write a self-checking 6502 functional test image for `nes-6502`,
+// the test run by CTest in every build (cpu_6502_functional).
+//
+// The image is 64 KB, loaded at $0000 and started at $0400. Every check runs one
+// instruction on chosen registers and flags, then compares the registers, the
+// memory and P with the results of the reference model below, which knows
+// nothing of `nes::BasicCPU`. A failed check traps (jumps to itself) where it
+// stands, the whole suite passing traps at `success`:
+//
+// 	- ADC and SBC, binary over a grid of operands and carries, and decimal
+// 	  (result and C, as on the NMOS 6502) over valid BCD operands;
+// 	- AND, ORA, EOR, CMP, CPX, CPY, BIT, and the shifts and rotates;
+// 	- loads, stores, INC and DEC in every addressing mode, with the zero page and
+// 	  page crossing wrap-arounds, and JMP's indirect page bug;
+// 	- transfers, increments, flag instructions, branches both ways;
+// 	- the stack: PHA, PLA, PHP, PLP, JSR, RTS, BRK and RTI.
+//
+// Usage: nes-6502-suite <out.bin>
+
+#include "common/types.hpp"
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+namespace {
+	// Where the suite lives.
+	constexpr u16 entry { 0x0400 };
+	constexpr u16 data { 0xe000 }; // two pages of operands
+	constexpr u16 jump_pointer { 0xe2ff };
+	constexpr u16 success { 0xf000 };
+	constexpr u16 decoy_page { 0xf100 };
+	constexpr u16 brk_handler { 0xf200 };
+
+	// Zero page: operands, a pointer for (zp,X) wrapping at $ff, and the flag the
+	// BRK handler checks, so a stray BRK fails.
+	constexpr u8 zp_operand { 0x10 };
+	constexpr u8 zp_pointer { 0x20 };
+	constexpr u8 zp_brk_expected { 0x30 };
+
+	// Status flags.
+	constexpr u8 C { 0x01 };
+	constexpr u8 Z { 0x02 };
+	constexpr u8 I { 0x04 };
+	constexpr u8 D { 0x08 };
+	constexpr u8 B { 0x10 };
+	constexpr u8 V { 0x40 };
+	constexpr u8 N { 0x80 };
+
+	// Flags a check compares: B and the unused bit only exist on the stack.
+	constexpr u8 checked { N | V | D | I | Z | C };
+
+	// clang-format off
+	enum Opcode : u8 {
+		ADC_IMM = 0x69, ADC_ZP = 0x65, ADC_ABS = 0x6d, ADC_ABX = 0x7d, ADC_IZY = 0x71,
+		SBC_IMM = 0xe9, SBC_ZP = 0xe5, SBC_ABY = 0xf9,
+		AND_IMM = 0x29, ORA_IMM = 0x09, EOR_IMM = 0x49,
+		CMP_IMM = 0xc9, CPX_IMM = 0xe0, CPY_IMM = 0xc0,
+		BIT_ZP = 0x24, BIT_ABS = 0x2c,
+		ASL_A = 0x0a, LSR_A = 0x4a, ROL_A = 0x2a, ROR_A = 0x6a,
+		ASL_ZP = 0x06, LSR_ABS = 0x4e, ROL_ZPX = 0x36, ROR_ABX = 0x7e,
+		INC_ZP = 0xe6, INC_ZPX = 0xf6, INC_ABS = 0xee, INC_ABX = 0xfe,
+		DEC_ZP = 0xc6, DEC_ABS = 0xce,
+		LDA_IMM = 0xa9, LDA_ZP = 0xa5, LDA_ZPX = 0xb5, LDA_ABS = 0xad, LDA_ABX = 0xbd,
+		LDA_ABY = 0xb9, LDA_IZX = 0xa1, LDA_IZY = 0xb1,
+		LDX_IMM = 0xa2, LDX_ZPY = 0xb6, LDX_ABY = 0xbe,
+		LDY_IMM = 0xa0, LDY_ZPX = 0xb4, LDY_ABX = 0xbc,
+		STA_ZP = 0x85, STA_ZPX = 0x95, STA_ABS = 0x8d, STA_ABX = 0x9d, STA_ABY = 0x99,
+		STA_IZX = 0x81, STA_IZY = 0x91,
+		STX_ZPY = 0x96, STX_ABS = 0x8e, STY_ZPX = 0x94, STY_ABS = 0x8c,
+		TAX = 0xaa, TAY = 0xa8, TXA = 0x8a, TYA = 0x98, TSX = 0xba, TXS = 0x9a,
+		INX = 0xe8, INY = 0xc8, DEX = 0xca, DEY = 0x88,
+		CLC = 0x18, SEC = 0x38, CLI = 0x58, SEI = 0x78, CLV = 0xb8, CLD = 0xd8,
+		SED = 0xf8,
+		PHA = 0x48, PLA = 0x68, PHP = 0x08, PLP = 0x28,
+		BPL = 0x10, BMI = 0x30, BVC = 0x50, BVS = 0x70, BCC = 0x90, BCS = 0xb0,
+		BNE = 0xd0, BEQ = 0xf0,
+		JMP_ABS = 0x4c, JMP_IND = 0x6c, JSR = 0x20, RTS = 0x60, RTI = 0x40, BRK = 0x00,
+		NOP = 0xea,
+	};
+	// clang-format on
+
+	// Operands covering the carries, the sign changes and the zero results.
+	constexpr std::array<u8, 10> operands {
+		0x00, 0x01, 0x0f, 0x40, 0x7f, 0x80, 0x81, 0xc0, 0xfe, 0xff,
+	};
+	constexpr std::array<u8, 8> bcd_operands { 0x00, 0x01, 0x09, 0x10, 0x50, 0x79, 0x98, 0x99 };
+
+	// Reference model: what an instruction leaves in a register or memory, and P.
+	struct Result {
+		u8 value;
+		u8 p;
+	};
+
+	[[nodiscard]] u8 setNZ(u8 p, u8 value) {
+		return (p & ~(N | Z)) | (value & N) | (value == 0 ? Z : 0);
+	}
+
+	[[nodiscard]] int fromBcd(u8 value) {
+		return (value >> 4) * 10 + (value & 0x0f);
+	}
+
+	[[nodiscard]] u8 toBcd(int value) {
+		return static_cast<u8>((value / 10) << 4 | value % 10);
+	}
+
+	// Decimal results only define the value and C, see `checkDecimal`.
+	[[nodiscard]] Result adc(u8 a, u8 m, u8 p) {
+		const int carry { p & C };
+		if (p & D) {
+			const int sum { fromBcd(a) + fromBcd(m) + carry };
+			return { toBcd(sum % 100), static_cast<u8>((p & ~C) | (sum > 99 ? C : 0)) };
+		}
+
+		const int sum { a + m + carry };
+		const u8 value = sum & 0xff;
+		const bool overflow { (~(a ^ m) & (a ^ value) & 0x80) != 0 };
+		p = setNZ(p & ~(C | V), value);
+		return { value, static_cast<u8>(p | (sum > 0xff ? C : 0) | (overflow ? V : 0)) };
+	}
+
+	[[nodiscard]] Result sbc(u8 a, u8 m, u8 p) {
+		if (p & D) {
+			int difference { fromBcd(a) - fromBcd(m) - (1 - (p & C)) };
+			const bool no_borrow { difference >= 0 };
+			if (difference < 0) {
+				difference += 100;
+			}
+			return { toBcd(difference), static_cast<u8>((p & ~C) | (no_borrow ? C : 0)) };
+		}
+
+		return adc(a, static_cast<u8>(~m), p);
+	}
+
+	[[nodiscard]] Result compare(u8 reg, u8 m, u8 p) {
+		const u8 difference = reg - m;
+		return { reg, static_cast<u8>(setNZ(p & ~C, difference) | (reg >= m ? C : 0)) };
+	}
+
+	[[nodiscard]] Result shift(u8 opcode, u8 value, u8 p) {
+		const u8 carry_in = p & C;
+		u8 carry_out {};
+		switch (opcode) {
+		case ASL_A:
+			carry_out = value >> 7;
+			value = value << 1;
+			break;
+		case LSR_A:
+			carry_out = value & 0x01;
+			value = value >> 1;
+			break;
+		case ROL_A:
+			carry_out = value >> 7;
+			value = (value << 1) | carry_in;
+			break;
+		default: // ROR
+			carry_out = value & 0x01;
+			value = (value >> 1) | (carry_in << 7);
+			break;
+		}
+		return { value, static_cast<u8>(setNZ(p & ~C, value) | carry_out) };
+	}
+
+	// Emits code into the image, one check after the other.
+	class Assembler {
+	public:
+		explicit Assembler(std::vector<u8>& image, u16 origin)
+			: m_image(image)
+			, m_pc(origin) {}
+
+		[[nodiscard]] inline u16 here() const { return m_pc; }
+		inline void org(u16 addr) { m_pc = addr; }
+
+		void byte(u8 value) {
+			if (m_pc >= data && m_pc < success) {
+				// Ran into the data pages: the suite outgrew its space.
+				std::fprintf(stderr, "Code overflows at $%04x\n", m_pc);
+				std::exit(EXIT_FAILURE);
+			}
+			m_image.at(m_pc++) = value;
+		}
+
+		void op(u8 opcode) { byte(opcode); }
+
+		void op(u8 opcode, u8 operand) {
+			byte(opcode);
+			byte(operand);
+		}
+
+		void op16(u8 opcode, u16 operand) {
+			byte(opcode);
+			byte(operand & 0xff);
+			byte(operand >> 8);
+		}
+
+		// Trap here unless Z is set, i.e. the last comparison was equal.
+		void trapUnlessEqual() {
+			op(BEQ, 3);
+			op16(JMP_ABS, here());
+		}
+
+		// Load the registers, then P last: loading them changes N and Z.
+		void prepare(u8 a, u8 p) {
+			op(LDA_IMM, p);
+			op(PHA);
+			op(LDA_IMM, a);
+			op(PLP);
+		}
+
+		void prepareXY(u8 a, u8 x, u8 y, u8 p) {
+			op(LDA_IMM, p);
+			op(PHA);
+			op(LDX_IMM, x);
+			op(LDY_IMM, y);
+			op(LDA_IMM, a);
+			op(PLP);
+		}
+
+		// Compare P, with `mask` selecting the flags that matter. A is lost.
+		void checkP(u8 p, u8 mask = checked) {
+			op(PHP);
+			op(PLA);
+			op(AND_IMM, mask);
+			op(CMP_IMM, p & mask);
+			trapUnlessEqual();
+		}
+
+		// Compare A (or X, Y with `compare` CPX_IMM, CPY_IMM), then P.
+		void check(u8 value, u8 p, u8 mask = checked, u8 compare = CMP_IMM) {
+			op(PHP);
+			op(compare, value);
+			trapUnlessEqual();
+			op(PLA);
+			op(AND_IMM, mask);
+			op(CMP_IMM, p & mask);
+			trapUnlessEqual();
+		}
+
+		// Compare a byte of memory. A and P are lost.
+		void checkMemory(u16 addr, u8 value) {
+			op16(LDA_ABS, addr);
+			op(CMP_IMM, value);
+			trapUnlessEqual();
+		}
+
+		// Poke `value` at `addr`. A and P are lost.
+		void poke(u16 addr, u8 value) {
+			op(LDA_IMM, value);
+			op16(STA_ABS, addr);
+		}
+
+	private:
+		std::vector<u8>& m_image;
+		u16 m_pc;
+	};
+
+	// P before an instruction: I always set, the other flags varied with `i`.
+	[[nodiscard]] u8 startP(std::size_t i, u8 carry) {
+		return I | carry | ((i & 1) ? (N | V | Z) : 0);
+	}
+
+	void emitArithmetic(Assembler& as) {
+		for (const u8 opcode : { ADC_IMM, SBC_IMM }) {
+			std::size_t i { 0 };
+			for (const u8 a : operands) {
+				for (const u8 m : operands) {
+					for (const u8 carry : { u8 { 0 }, C }) {
+						const u8 p { startP(i++, carry) };
+						const Result r { opcode == ADC_IMM ? adc(a, m, p) : sbc(a, m, p) };
+						as.prepare(a, p);
+						as.op(opcode, m);
+						as.check(r.value, r.p);
+					}
+				}
+			}
+		}
+
+		// NMOS decimal mode only defines the result and C.
+		for (const u8 opcode : { ADC_IMM, SBC_IMM }) {
+			for (const u8 a : bcd_operands) {
+				for (const u8 m : bcd_operands) {
+					for (const u8 carry : { u8 { 0 }, C }) {
+						const u8 p = I | D | carry;
+						const Result r { opcode == ADC_IMM ? adc(a, m, p) : sbc(a, m, p) };
+						as.prepare(a, p);
+						as.op(opcode, m);
+						as.check(r.value, r.p, D | I | C);
+					}
+				}
+			}
+		}
+		as.op(CLD);
+	}
+
+	void emitLogic(Assembler& as) {
+		std::size_t i { 0 };
+		for (const u8 a : operands) {
+			for (const u8 m : operands) {
+				const u8 p { startP(i, (i & 2) ? C : 0) };
+				++i;
+				as.prepare(a, p);
+				as.op(AND_IMM, m);
+				as.check(a & m, setNZ(p, a & m));
+
+				as.prepare(a, p);
+				as.op(ORA_IMM, m);
+				as.check(a | m, setNZ(p, a | m));
+
+				as.prepare(a, p);
+				as.op(EOR_IMM, m);
+				as.check(a ^ m, setNZ(p, a ^ m));
+
+				const Result cmp { compare(a, m, p) };
+				as.prepare(a, p);
+				as.op(CMP_IMM, m);
+				as.check(cmp.value, cmp.p);
+
+				// The register under test is loaded into A for the comparison.
+				as.prepareXY(0x00, a, a, p);
+				as.op(CPX_IMM, m);
+				as.check(a, cmp.p, checked, CPX_IMM);
+
+				as.prepareXY(0x00, a, a, p);
+				as.op(CPY_IMM, m);
+				as.check(a, cmp.p, checked, CPY_IMM);
+			}
+		}
+
+		// BIT: N and V from memory, Z from A AND memory, A untouched.
+		i = 0;
+		for (const u8 a : operands) {
+			for (const u8 m : { u8 { 0x00 }, u8 { 0x40 }, u8 { 0x80 }, u8 { 0xc1 } }) {
+				const u8 p { startP(i++, C) };
+				const u8 expected = (p & ~(N | V | Z)) | (m & (N | V)) | ((a & m) ? 0 : Z);
+				as.poke(zp_operand, m);
+				as.poke(data + 0x1ff, m);
+				as.prepare(a, p);
+				as.op(BIT_ZP, zp_operand);
+				as.check(a, expected);
+				as.prepare(a, p);
+				as.op16(BIT_ABS, data + 0x1ff);
+				as.check(a, expected);
+			}
+		}
+
+		i = 0;
+		for (const u8 opcode : { ASL_A, LSR_A, ROL_A, ROR_A }) {
+			for (const u8 a : operands) {
+				for (const u8 carry : { u8 { 0 }, C }) {
+					const u8 p { startP(i++, carry) };
+					const Result r { shift(opcode, a, p) };
+					as.prepare(a, p);
+					as.op(opcode);
+					as.check(r.value, r.p);
+				}
+			}
+		}
+	}
+
+	void emitAddressing(Assembler& as) {
+		const u16 cross { data + 0xf8 }; // + $10 crosses into the second page
+
+		// Loads: every mode reads the operand placed for it.
+		as.poke(zp_operand, 0x5a);
+		as.poke(data + 0x108, 0x3c);
+		as.poke(data + 0x080, 0xa5);
+		as.poke(zp_pointer, cross & 0xff);
+		as.poke(zp_pointer + 1, cross >> 8);
+		as.poke(0x00ff, 0x80); // (zp,X) pointer wrapping from $ff to $00
+		as.poke(0x0000, data >> 8);
+
+		const auto load = [&as](u8 x, u8 y, u8 opcode, u16 operand, bool zp, u8 value) {
+			as.prepareXY(0x00, x, y, I);
+			if (zp) {
+				as.op(opcode, static_cast<u8>(operand));
+			} else {
+				as.op16(opcode, operand);
+			}
+			as.check(value, setNZ(I, value));
+		};
+		load(0x00, 0x00, LDA_ZP, zp_operand, true, 0x5a);
+		load(0xf0, 0x00, LDA_ZPX, zp_operand + 0x10, true, 0x5a); // wraps in page 0
+		load(0x00, 0x00, LDA_ABS, data + 0x108, false, 0x3c);
+		load(0x10, 0x00, LDA_ABX, cross, false, 0x3c);
+		load(0x00, 0x10, LDA_ABY, cross, false, 0x3c);
+		load(0x01, 0x00, LDA_IZX, 0xfe, true, 0xa5);
+		load(0x00, 0x10, LDA_IZY, zp_pointer, true, 0x3c);
+		load(0x00, 0x00, LDA_IZY, 0xff, true, 0xa5); // pointer wrapping too
+
+		as.prepareXY(0x00, 0x00, 0xf0, I);
+		as.op(LDX_ZPY, zp_operand + 0x10);
+		as.check(0x5a, setNZ(I, 0x5a), checked, CPX_IMM);
+		as.prepareXY(0x00, 0x00, 0x10, I);
+		as.op16(LDX_ABY, cross);
+		as.check(0x3c, setNZ(I, 0x3c), checked, CPX_IMM);
+		as.prepareXY(0x00, 0xf0, 0x00, I);
+		as.op(LDY_ZPX, zp_operand + 0x10);
+		as.check(0x5a, setNZ(I, 0x5a), checked, CPY_IMM);
+		as.prepareXY(0x00, 0x10, 0x00, I);
+		as.op16(LDY_ABX, cross);
+		as.check(0x3c, setNZ(I, 0x3c), checked, CPY_IMM);
+
+		// ADC and SBC read through the other modes too.
+		as.poke(data + 0x000, 0x11);
+		as.prepareXY(0x22, 0x00, 0x00, I);
+		as.op(ADC_ZP, zp_operand);
+		as.check(0x7c, I);
+		as.prepareXY(0x22, 0x00, 0x00, I);
+		as.op16(ADC_ABS, data);
+		as.check(0x33, I);
+		as.prepareXY(0x22, 0x10, 0x00, I);
+		as.op16(ADC_ABX, cross);
+		as.check(0x5e, I);
+		as.prepareXY(0x22, 0x00, 0x10, I);
+		as.op(ADC_IZY, zp_pointer);
+		as.check(0x5e, I);
+		as.prepareXY(0x60, 0x00, 0x00, I | C);
+		as.op(SBC_ZP, zp_operand);
+		as.check(0x06, I | C);
+		as.prepareXY(0x60, 0x00, 0x10, I | C);
+		as.op16(SBC_ABY, cross);
+		as.check(0x24, I | C);
+
+		// Stores: each mode writes its own byte, then it is read back.
+		const auto store = [&as](u8 x, u8 y, u8 opcode, u16 operand, bool zp) {
+			as.prepareXY(0xc3, x, y, I);
+			if (zp) {
+				as.op(opcode, static_cast<u8>(operand));
+			} else {
+				as.op16(opcode, operand);
+			}
+			as.checkP(I);
+		};
+		store(0x00, 0x00, STA_ZP, 0x40, true);
+		store(0xf1, 0x00, STA_ZPX, 0x50, true); // $41
+		store(0x00, 0x00, STA_ABS, data + 0x100, false);
+		store(0x11, 0x00, STA_ABX, cross, false); // + $109
+		store(0x00, 0x12, STA_ABY, cross, false); // + $10a
+		store(0x01, 0x00, STA_IZX, 0xfe, true);   // + $080
+		store(0x00, 0x13, STA_IZY, zp_pointer, true); // + $10b
+		as.checkMemory(0x0040, 0xc3);
+		as.checkMemory(0x0041, 0xc3);
+		as.checkMemory(data + 0x100, 0xc3);
+		as.checkMemory(data + 0x109, 0xc3);
+		as.checkMemory(data + 0x10a, 0xc3);
+		as.checkMemory(data + 0x080, 0xc3);
+		as.checkMemory(data + 0x10b, 0xc3);
+
+		as.prepareXY(0x00, 0x96, 0xf2, I);
+		as.op(STX_ZPY, 0x50); // $42
+		as.op16(STX_ABS, data + 0x10c);
+		as.prepareXY(0x00, 0xf3, 0x69, I);
+		as.op(STY_ZPX, 0x50); // $43
+		as.op16(STY_ABS, data + 0x10d);
+		as.checkMemory(0x0042, 0x96);
+		as.checkMemory(data + 0x10c, 0x96);
+		as.checkMemory(0x0043, 0x69);
+		as.checkMemory(data + 0x10d, 0x69);
+
+		// Read-modify-write in memory.
+		struct Rmw {
+			u8 opcode;
+			u16 addr;
+			bool zp;
+			u8 x;
+			u8 before;
+			Result after;
+		};
+		const std::array<Rmw, 10> rmw { {
+			{ INC_ZP, 0x60, true, 0x00, 0xff, { 0x00, I | Z } },
+			{ INC_ZPX, 0x70, true, 0xf1, 0x7f, { 0x80, I | N } }, // $61
+			{ INC_ABS, data + 0x110, false, 0x00, 0x00, { 0x01, I } },
+			{ INC_ABX, cross, false, 0x19, 0x41, { 0x42, I } }, // + $111
+			{ DEC_ZP, 0x62, true, 0x00, 0x00, { 0xff, I | N } },
+			{ DEC_ABS, data + 0x112, false, 0x00, 0x01, { 0x00, I | Z } },
+			{ ASL_ZP, 0x63, true, 0x00, 0x81, { 0x02, I | C } },
+			{ LSR_ABS, data + 0x113, false, 0x00, 0x01, { 0x00, I | Z | C } },
+			{ ROL_ZPX, 0x74, true, 0xf0, 0x80, { 0x00, I | Z | C } }, // $64
+			{ ROR_ABX, cross, false, 0x1c, 0x01, { 0x00, I | Z | C } }, // + $114
+		} };
+		for (const Rmw& test : rmw) {
+			const u16 target = test.zp ? static_cast<u8>(test.addr + test.x)
+			                           : static_cast<u16>(test.addr + test.x);
+			as.poke(target, test.before);
+			as.prepareXY(0x00, test.x, 0x00, I);
+			if (test.zp) {
+				as.op(test.opcode, static_cast<u8>(test.addr));
+			} else {
+				as.op16(test.opcode, test.addr);
+			}
+			as.checkP(test.after.p);
+			as.checkMemory(target, test.after.value);
+		}
+	}
+
+	void emitRegisters(Assembler& as, std::vector<u8>& image) {
+		std::size_t i { 0 };
+		for (const u8 value : operands) {
+			const u8 p { startP(i++, C) };
+			const u8 loaded { setNZ(p, value) };
+
+			as.prepareXY(value, 0x00, 0x00, p);
+			as.op(TAX);
+			as.check(value, loaded, checked, CPX_IMM);
+			as.prepareXY(value, 0x00, 0x00, p);
+			as.op(TAY);
+			as.check(value, loaded, checked, CPY_IMM);
+			as.prepareXY(0x00, value, 0x00, p);
+			as.op(TXA);
+			as.check(value, loaded);
+			as.prepareXY(0x00, 0x00, value, p);
+			as.op(TYA);
+			as.check(value, loaded);
+
+			const u8 inc = value + 1;
+			const u8 dec = value - 1;
+			as.prepareXY(0x00, value, value, p);
+			as.op(INX);
+			as.check(inc, setNZ(p, inc), checked, CPX_IMM);
+			as.prepareXY(0x00, value, value, p);
+			as.op(DEX);
+			as.check(dec, setNZ(p, dec), checked, CPX_IMM);
+			as.prepareXY(0x00, value, value, p);
+			as.op(INY);
+			as.check(inc, setNZ(p, inc), checked, CPY_IMM);
+			as.prepareXY(0x00, value, value, p);
+			as.op(DEY);
+			as.check(dec, setNZ(p, dec), checked, CPY_IMM);
+		}
+
+		// TXS changes no flag, TSX does. The stack is moved and put back.
+		as.prepareXY(0x00, 0x80, 0x00, I | Z);
+		as.op(TXS);
+		as.checkP(I | Z);
+		as.prepareXY(0x00, 0x00, 0x00, I);
+		as.op(TSX);
+		as.check(0x80, I | N, checked, CPX_IMM);
+		as.op(LDX_IMM, 0xff);
+		as.op(TXS);
+
+		// Flag instructions, each from both states of its flag.
+		struct FlagOp {
+			u8 opcode;
+			u8 flag;
+			bool set;
+		};
+		const std::array<FlagOp, 7> flag_ops { {
+			{ CLC, C, false },
+			{ SEC, C, true },
+			{ CLI, I, false },
+			{ SEI, I, true },
+			{ CLV, V, false },
+			{ CLD, D, false },
+			{ SED, D, true },
+		} };
+		for (const FlagOp& flag_op : flag_ops) {
+			for (const u8 before : { u8 { I }, u8 { N | V | D | I | Z | C } }) {
+				const u8 start = (before & ~flag_op.flag) | (flag_op.set ? 0 : flag_op.flag);
+				const u8 after = (start & ~flag_op.flag) | (flag_op.set ? flag_op.flag : 0);
+				as.prepare(0x00, start);
+				as.op(flag_op.opcode);
+				as.checkP(after);
+			}
+		}
+		as.op(CLD);
+		as.op(SEI);
+
+		// Branches: taken, not taken, and taken backwards.
+		struct Branch {
+			u8 opcode;
+			u8 flag;
+			bool on_set;
+		};
+		const std::array<Branch, 8> branches { {
+			{ BPL, N, false },
+			{ BMI, N, true },
+			{ BVC, V, false },
+			{ BVS, V, true },
+			{ BCC, C, false },
+			{ BCS, C, true },
+			{ BNE, Z, false },
+			{ BEQ, Z, true },
+		} };
+		for (const Branch& branch : branches) {
+			const u8 taken = I | (branch.on_set ? branch.flag : 0);
+			const u8 not_taken = I | (branch.on_set ? 0 : branch.flag);
+
+			// Taken: over the trap.
+			as.prepare(0x00, taken);
+			as.op(branch.opcode, 3);
+			as.op16(JMP_ABS, as.here());
+
+			// Not taken: into the jump over the trap.
+			as.prepare(0x00, not_taken);
+			as.op(branch.opcode, 3);
+			as.op16(JMP_ABS, as.here() + 6);
+			as.op16(JMP_ABS, as.here());
+
+			// Taken backwards, to a jump past the trap.
+			const u16 forward { as.here() };
+			as.op16(JMP_ABS, 0x0000);
+			const u16 back { as.here() };
+			as.op16(JMP_ABS, 0x0000);
+			const u16 target { as.here() };
+			as.prepare(0x00, taken);
+			as.op(branch.opcode, static_cast<u8>(back - (as.here() + 2)));
+			as.op16(JMP_ABS, as.here());
+			const u16 done { as.here() };
+			image.at(forward + 1) = target & 0xff;
+			image.at(forward + 2) = target >> 8;
+			image.at(back + 1) = done & 0xff;
+			image.at(back + 2) = done >> 8;
+		}
+	}
+
+	void emitStack(Assembler& as, std::vector<u8>& image) {
+		// PHA and PLA, PLA setting N and Z.
+		as.prepareXY(0x9c, 0x00, 0x00, I);
+		as.op(PHA);
+		as.op(LDA_IMM, 0x00);
+		as.op(PLA);
+		as.check(0x9c, I | N);
+		as.op(TSX);
+		as.op(CPX_IMM, 0xff);
+		as.trapUnlessEqual();
+
+		// PHP pushes B and the unused bit set, PLP ignores them.
+		as.prepare(0x00, I | C);
+		as.op(PHP);
+		as.op(PLA);
+		as.op(CMP_IMM, I | C | B | 0x20);
+		as.trapUnlessEqual();
+		as.op(LDA_IMM, 0xff);
+		as.op(PHA);
+		as.op(PLP);
+		as.checkP(N | V | D | I | Z | C);
+		as.op(CLD);
+
+		// JSR pushes the address of its last byte, RTS returns past it.
+		const u16 over { as.here() };
+		as.op16(JMP_ABS, 0x0000);
+		const u16 subroutine { as.here() };
+		as.op(TSX);
+		as.op(CPX_IMM, 0xfd);
+		as.trapUnlessEqual();
+		as.op16(LDA_ABS, 0x01fe);
+		const u16 pushed_low { as.here() };
+		as.op(CMP_IMM, 0x00);
+		as.trapUnlessEqual();
+		as.op16(LDA_ABS, 0x01ff);
+		const u16 pushed_high { as.here() };
+		as.op(CMP_IMM, 0x00);
+		as.trapUnlessEqual();
+		as.op(RTS);
+
+		const u16 call { as.here() };
+		as.op16(JSR, subroutine);
+		as.op(TSX);
+		as.op(CPX_IMM, 0xff);
+		as.trapUnlessEqual();
+
+		const u16 pushed = call + 2;
+		image.at(over + 1) = call & 0xff;
+		image.at(over + 2) = call >> 8;
+		image.at(pushed_low + 1) = pushed & 0xff;
+		image.at(pushed_high + 1) = pushed >> 8;
+
+		// BRK pushes past its padding byte with B set, RTI restores P. A stray
+		// BRK, e.g. the padding run again, fails in the handler.
+		as.poke(zp_brk_expected, 0x01);
+		as.op(LDA_IMM, 0x00);
+		as.op(CLI);
+		as.op(CLV);
+		as.op(SEC);
+		as.op(BRK);
+		as.op(BRK); // padding, skipped
+		as.op(PHP);
+		as.op(PLA);
+		as.op(AND_IMM, checked);
+		as.op(CMP_IMM, C | Z);
+		as.trapUnlessEqual();
+		as.op(SEI);
+		as.checkMemory(zp_brk_expected, 0x00);
+	}
+
+	void emitBrkHandler(Assembler& as) {
+		as.op(LDA_ZP, zp_brk_expected);
+		as.op(BNE, 3);
+		as.op16(JMP_ABS, as.here());
+		as.op(LDA_IMM, 0x00);
+		as.op(STA_ZP, zp_brk_expected);
+		// The handler runs with I set, the pushed P has B set.
+		as.checkP(I, I);
+		as.op(TSX);
+		as.op16(LDA_ABX, 0x0101);
+		as.op(AND_IMM, B | I | C);
+		as.op(CMP_IMM, B | C);
+		as.trapUnlessEqual();
+		as.op(RTI);
+	}
+
+	void emitJumps(Assembler& as, std::vector<u8>& image) {
+		// JMP ($xxff) reads the high byte from $xx00, not from the next page:
+		// without the bug it lands in the decoy page, on a trap.
+		as.op16(JMP_IND, jump_pointer);
+		const u16 target { as.here() };
+		const u16 decoy = decoy_page | (target & 0xff);
+		image.at(jump_pointer) = target & 0xff;
+		image.at(jump_pointer & 0xff00) = target >> 8;
+		image.at(jump_pointer + 1) = decoy >> 8;
+		image.at(decoy) = JMP_ABS;
+		image.at(decoy + 1) = decoy & 0xff;
+		image.at(decoy + 2) = decoy >> 8;
+	}
+} // namespace
+
+int main(int argc, char *argv[]) {
+	if (argc != 2) {
+		std::fprintf(stderr, "Usage: %s <out.bin>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::vector<u8> image(0x10000, BRK);
+	image.at(0xfffe) = brk_handler & 0xff;
+	image.at(0xffff) = brk_handler >> 8;
+
+	Assembler as { image, entry };
+	as.op(LDX_IMM, 0xff);
+	as.op(TXS);
+	as.op(SEI);
+	as.op(CLD);
+
+	emitArithmetic(as);
+	emitLogic(as);
+	emitAddressing(as);
+	emitRegisters(as, image);
+	emitJumps(as, image);
+	emitStack(as, image);
+	as.op16(JMP_ABS, success);
+	std::printf("Checks at $%04x-$%04x\n", entry, as.here() - 1);
+
+	as.org(brk_handler);
+	emitBrkHandler(as);
+	as.org(success);
+	as.op16(JMP_ABS, success);
+
+	std::ofstream file { argv[1], std::ios::binary };
+	file.write(reinterpret_cast<const char *>(image.data()), image.size());
+	if (!file) {
+		std::fprintf(stderr, "Cannot write %s\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
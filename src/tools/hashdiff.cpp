@@ -0,0 +1,46 @@
+// hashdiff: compare two per-frame state hash logs written by `nes --hash-log` and
+// report the first frame where the emulation diverged.
+
+#include "nes/HashLog.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char *argv[]) {
+	if (argc != 3) {
+		std::fprintf(stderr, "Usage: %s <a.hashlog> <b.hashlog>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	auto a { nes::HashLog::readFile(argv[1]) };
+	auto b { nes::HashLog::readFile(argv[2]) };
+	if (!a || !b) {
+		std::fprintf(stderr, "Cannot read hash log %s\n", !a ? argv[1] : argv[2]);
+		return EXIT_FAILURE;
+	}
+
+	const auto frames { std::min(a->size(), b->size()) };
+	const auto mismatch { std::mismatch(a->begin(), a->begin() + frames, b->begin()) };
+
+	if (mismatch.first != a->begin() + frames) {
+		const auto frame { mismatch.first - a->begin() };
+		std::printf(
+			"Diverged at frame %td: %016llx != %016llx\n", frame,
+			static_cast<unsigned long long>(*mismatch.first),
+			static_cast<unsigned long long>(*mismatch.second)
+		);
+		return 2;
+	}
+
+	if (a->size() != b->size()) {
+		std::printf(
+			"Identical for %zu frames, but lengths differ (%zu vs %zu)\n", frames,
+			a->size(), b->size()
+		);
+		return 2;
+	}
+
+	std::printf("Identical for %zu frames\n", frames);
+	return EXIT_SUCCESS;
+}
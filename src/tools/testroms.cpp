@@ -0,0 +1,317 @@
+// testroms: run every test ROM of a directory on all cores and print a pass/fail
+// matrix. Registered with CTest when NES_TEST_ROM_DIR is set, see
+// cmake/testroms.cmake.
+//
+// ROMs report through PRG RAM, the protocol of blargg's test suites:
+//   $6001-$6003 - $de $b0 $61 once the status is valid
+//   $6000 - $80 running, $81 reset wanted (after 100 ms), below $80 the result
+//           code: 0 passed, anything else failed
+//   $6004 - zero-terminated text, the failure message
+//
+// A ROM stops as soon as it reports, and is called hung when neither CPU RAM
+// nor PRG RAM changed for a while, so that no ROM waits out the frame limit.
+
+#include "common/Hash.hpp"
+#include "nes/Bus.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+	// Frames between the $81 status and the reset, at least 100 ms.
+	constexpr u64 reset_delay { 6 };
+
+	constexpr std::array<u8, 3> signature { 0xde, 0xb0, 0x61 };
+
+	struct Options {
+		std::string_view directory {};
+		nes::Accuracy accuracy { nes::Accuracy::CYCLE };
+		u64 max_frames { 60 * 60 };
+		u64 hang_frames { 60 * 5 };
+		u32 threads { 0 };
+	};
+
+	enum Outcome {
+		PASSED,
+		FAILED,
+		HUNG,
+		TIMED_OUT,
+		ERROR,
+	};
+
+	struct Result {
+		std::filesystem::path path {};
+		Outcome outcome { ERROR };
+		u8 code { 0 };
+		u64 frames { 0 };
+		double seconds { 0.0 };
+		std::string message {};
+	};
+
+	[[nodiscard]] const char *outcomeName(Outcome outcome) {
+		switch (outcome) {
+		case PASSED:
+			return "pass";
+		case FAILED:
+			return "FAIL";
+		case HUNG:
+			return "HANG";
+		case TIMED_OUT:
+			return "TIMEOUT";
+		case ERROR:
+			return "ERROR";
+		}
+		return "";
+	}
+
+	[[nodiscard]] bool hasSignature(nes::Bus& bus) {
+		for (u16 i { 0 }; i < signature.size(); ++i) {
+			if (bus.cpuRead(0x6001 + i, true) != signature.at(i)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	[[nodiscard]] std::string readText(nes::Bus& bus) {
+		std::string text {};
+		for (u16 addr { 0x6004 }; addr < 0x8000; ++addr) {
+			const u8 c { bus.cpuRead(addr, true) };
+			if (c == 0x00) {
+				break;
+			}
+			text += static_cast<char>(c);
+		}
+
+		// Trim the trailing newlines the ROMs print.
+		while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) {
+			text.pop_back();
+		}
+		return text;
+	}
+
+	// Everything a ROM still making progress changes: CPU RAM and PRG RAM.
+	[[nodiscard]] u64 fingerprint(nes::Bus& bus) {
+		const auto& ram { bus.getRam() };
+		u64 seed { hash::xxh64(ram.data(), ram.size()) };
+
+		std::array<u8, MAPPER_PRG_RAM_SIZE> prg_ram {};
+		for (u16 i { 0 }; i < prg_ram.size(); ++i) {
+			prg_ram.at(i) = bus.cpuRead(0x6000 + i, true);
+		}
+		return hash::xxh64(prg_ram.data(), prg_ram.size(), seed);
+	}
+
+	void run(Result& result, const Options& options) {
+		nes::Bus bus { options.accuracy };
+		const auto cartridge { nes::Cartridge::loadFile(result.path.string()) };
+		if (!cartridge) {
+			result.message = "cannot load the ROM";
+			return;
+		}
+		bus.insert(*cartridge);
+		bus.power();
+
+		u64 reset_at { 0 };
+		bool reset_done { false };
+		u64 last_fingerprint { 0 };
+		u64 unchanged { 0 };
+
+		// Hashing the RAM every frame would cost more than the emulation.
+		constexpr u64 check_interval { 30 };
+
+		for (u64 frame { 1 }; frame <= options.max_frames; ++frame) {
+			bus.runFrame(false);
+			result.frames = frame;
+
+			if (hasSignature(bus)) {
+				const u8 status { bus.cpuRead(0x6000, true) };
+				if (status < 0x80) {
+					result.outcome = status == 0 ? PASSED : FAILED;
+					result.code = status;
+					result.message = readText(bus);
+					return;
+				}
+
+				if (status == 0x81 && !reset_done) {
+					if (reset_at == 0) {
+						reset_at = frame + reset_delay;
+					} else if (frame >= reset_at) {
+						bus.reset();
+						reset_done = true;
+						reset_at = 0;
+					}
+				} else if (status != 0x81) {
+					// Running again after the reset, a later $81 asks for another.
+					reset_done = false;
+				}
+			}
+
+			if (frame % check_interval == 0) {
+				const u64 current { fingerprint(bus) };
+				unchanged = current == last_fingerprint ? unchanged + check_interval : 0;
+				last_fingerprint = current;
+
+				if (unchanged >= options.hang_frames && reset_at == 0) {
+					result.outcome = HUNG;
+					result.message = readText(bus);
+					return;
+				}
+			}
+		}
+
+		result.outcome = TIMED_OUT;
+	}
+
+	bool parseArguments(int argc, char *argv[], Options& options) {
+		if (argc < 2) {
+			return false;
+		}
+		options.directory = argv[1];
+
+		for (int i { 2 }; i + 1 < argc; i += 2) {
+			const std::string_view arg { argv[i] };
+			const std::string_view value { argv[i + 1] };
+
+			if (arg == "--accuracy" && (value == "fast" || value == "cycle")) {
+				options.accuracy =
+					value == "fast" ? nes::Accuracy::FAST : nes::Accuracy::CYCLE;
+			} else if (arg == "--max-seconds") {
+				options.max_frames = 60 * std::strtoull(value.data(), nullptr, 10);
+			} else if (arg == "--hang-seconds") {
+				options.hang_frames = 60 * std::strtoull(value.data(), nullptr, 10);
+			} else if (arg == "--threads") {
+				const unsigned long threads { std::strtoul(value.data(), nullptr, 10) };
+				options.threads = static_cast<u32>(threads);
+			} else {
+				return false;
+			}
+		}
+
+		return options.max_frames > 0 && options.hang_frames > 0 && argc % 2 == 0;
+	}
+} // namespace
+
+int main(int argc, char *argv[]) {
+	spdlog::set_level(spdlog::level::err);
+
+	Options options {};
+	if (!parseArguments(argc, argv, options)) {
+		std::fprintf(
+			stderr,
+			"Usage: %s <directory> [--accuracy fast|cycle] [--max-seconds <n>] "
+			"[--hang-seconds <n>] [--threads <n>]\n",
+			argv[0]
+		);
+		return 2;
+	}
+
+	std::vector<Result> results {};
+	std::error_code error {};
+	using Iterator = std::filesystem::recursive_directory_iterator;
+	for (Iterator it { options.directory, error }, end; !error && it != end;
+	     it.increment(error)) {
+		if (it->is_regular_file() && it->path().extension() == ".nes") {
+			results.push_back({ it->path() });
+		}
+	}
+	if (error || results.empty()) {
+		std::fprintf(stderr, "No .nes files in %s\n", options.directory.data());
+		return 2;
+	}
+	std::sort(results.begin(), results.end(), [](const Result& a, const Result& b) {
+		return a.path < b.path;
+	});
+
+	// ROMs are independent: each worker takes the next one until none are left.
+	const u32 threads { std::min<u32>(
+		options.threads > 0 ? options.threads
+		                    : std::max(std::thread::hardware_concurrency(), 1U),
+		static_cast<u32>(results.size())
+	) };
+	std::atomic<std::size_t> next { 0 };
+
+	const auto start { std::chrono::steady_clock::now() };
+	std::vector<std::thread> workers {};
+	for (u32 i { 0 }; i < threads; ++i) {
+		workers.emplace_back([&] {
+			for (std::size_t index { next++ }; index < results.size(); index = next++) {
+				Result& result { results.at(index) };
+				const auto rom_start { std::chrono::steady_clock::now() };
+				try {
+					run(result, options);
+				} catch (const std::exception& e) {
+					result.outcome = ERROR;
+					result.message = e.what();
+				}
+				const std::chrono::duration<double> elapsed {
+					std::chrono::steady_clock::now() - rom_start
+				};
+				result.seconds = elapsed.count();
+			}
+		});
+	}
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	const std::chrono::duration<double> elapsed {
+		std::chrono::steady_clock::now() - start
+	};
+
+	std::size_t width { 3 };
+	for (const auto& result : results) {
+		const auto name { result.path.lexically_relative(options.directory).string() };
+		width = std::max(width, name.size());
+	}
+
+	std::array<std::size_t, ERROR + 1> counts {};
+	std::printf(
+		"%-*s  %-7s  %8s  %8s\n", static_cast<int>(width), "ROM", "RESULT", "FRAMES",
+		"TIME"
+	);
+	for (const auto& result : results) {
+		const auto name { result.path.lexically_relative(options.directory).string() };
+		counts.at(result.outcome) += 1;
+
+		std::printf(
+			"%-*s  %-7s  %8llu  %7.2fs\n", static_cast<int>(width), name.c_str(),
+			outcomeName(result.outcome), static_cast<unsigned long long>(result.frames),
+			result.seconds
+		);
+		if (result.outcome != PASSED && !result.message.empty()) {
+			if (result.outcome == FAILED) {
+				std::printf("    code %u: ", result.code);
+			} else {
+				std::printf("    ");
+			}
+			for (const char c : result.message) {
+				std::putchar(c);
+				if (c == '\n') {
+					std::fputs("    ", stdout);
+				}
+			}
+			std::putchar('\n');
+		}
+	}
+
+	std::printf(
+		"\n%zu passed, %zu failed, %zu hung, %zu timed out, %zu errors in %.2fs "
+		"(%u threads, %s accuracy)\n",
+		counts.at(PASSED), counts.at(FAILED), counts.at(HUNG), counts.at(TIMED_OUT),
+		counts.at(ERROR), elapsed.count(), threads, nes::accuracyName(options.accuracy)
+	);
+
+	return counts.at(PASSED) == results.size() ? 0 : 1;
+}
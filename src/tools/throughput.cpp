@@ -0,0 +1,196 @@
+// throughput: run one fixed workload (a ROM, optionally replaying a movie) for a
+// number of frames, report the emulated frames per second as JSON, and fail when
+// it dropped too far below a stored baseline. Registered with CTest, see
+// cmake/perf.cmake.
+//
+// The best of several runs is kept, and every run must end in the same state:
+// the workload is deterministic, so a different hash is a bug, not noise.
+
+#include "nes/Bus.hpp"
+#include "nes/Movie.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace {
+	struct Options {
+		std::string_view workload {};
+		std::string_view rom_path {};
+		u64 frames { 0 };
+		std::string_view movie_path {};
+		nes::Accuracy accuracy { nes::Accuracy::CYCLE };
+		u32 runs { 3 };
+		std::string_view json_path {};
+		std::string_view baseline_path {};
+		double max_drop { 10.0 };
+	};
+
+	struct Result {
+		double seconds;
+		u64 hash;
+	};
+
+	Result
+	run(const nes::Cartridge& cartridge, const nes::Movie *movie, const Options& opts) {
+		nes::Bus bus { opts.accuracy };
+		bus.insert(cartridge);
+		bus.power();
+
+		const auto start { std::chrono::steady_clock::now() };
+		for (u64 frame { 0 }; frame < opts.frames; ++frame) {
+			if (movie) {
+				movie->apply(bus, frame);
+			}
+			bus.runFrame();
+		}
+		const std::chrono::duration<double> elapsed {
+			std::chrono::steady_clock::now() - start
+		};
+
+		return { elapsed.count(), bus.hashState() };
+	}
+
+	// The "fps" member of a result file written by this tool, 0 without one.
+	double readBaseline(std::string_view path) {
+		std::ifstream file(path.data());
+		const std::string json { std::istreambuf_iterator<char>(file), {} };
+
+		const std::size_t key { json.find("\"fps\"") };
+		const std::size_t colon { json.find(':', key) };
+		if (key == std::string::npos || colon == std::string::npos) {
+			return 0.0;
+		}
+		return std::strtod(json.c_str() + colon + 1, nullptr);
+	}
+
+	bool parseArguments(int argc, char *argv[], Options& options) {
+		if (argc < 4) {
+			return false;
+		}
+		options.workload = argv[1];
+		options.rom_path = argv[2];
+		options.frames = std::strtoull(argv[3], nullptr, 10);
+
+		for (int i { 4 }; i + 1 < argc; i += 2) {
+			const std::string_view arg { argv[i] };
+			const std::string_view value { argv[i + 1] };
+
+			if (arg == "--movie") {
+				options.movie_path = value;
+			} else if (arg == "--accuracy" && (value == "fast" || value == "cycle")) {
+				options.accuracy =
+					value == "fast" ? nes::Accuracy::FAST : nes::Accuracy::CYCLE;
+			} else if (arg == "--runs") {
+				const unsigned long runs { std::strtoul(value.data(), nullptr, 10) };
+				options.runs = static_cast<u32>(std::max(runs, 1UL));
+			} else if (arg == "--json") {
+				options.json_path = value;
+			} else if (arg == "--baseline") {
+				options.baseline_path = value;
+			} else if (arg == "--max-drop") {
+				options.max_drop = std::strtod(value.data(), nullptr);
+			} else {
+				return false;
+			}
+		}
+
+		return options.frames > 0 && (argc - 4) % 2 == 0;
+	}
+} // namespace
+
+int main(int argc, char *argv[]) {
+	spdlog::set_level(spdlog::level::warn);
+
+	Options options {};
+	if (!parseArguments(argc, argv, options)) {
+		std::fprintf(
+			stderr,
+			"Usage: %s <workload> <rom.nes> <frames> [--movie <file.fm2>] "
+			"[--accuracy fast|cycle] [--runs <n>] [--json <out.json>] "
+			"[--baseline <in.json>] [--max-drop <percent>]\n",
+			argv[0]
+		);
+		return 2;
+	}
+
+	const auto cartridge { nes::Cartridge::loadFile(options.rom_path) };
+	std::optional<nes::Movie> movie {};
+	if (!options.movie_path.empty()) {
+		movie = nes::Movie::loadFile(options.movie_path);
+	}
+	if (!cartridge || (!options.movie_path.empty() && !movie)) {
+		return 2;
+	}
+
+	std::optional<Result> best {};
+	for (u32 i { 0 }; i < options.runs; ++i) {
+		const Result result { run(*cartridge, movie ? &*movie : nullptr, options) };
+		if (best && result.hash != best->hash) {
+			std::fprintf(
+				stderr, "%s: runs ended in different states\n", options.workload.data()
+			);
+			return 1;
+		}
+		if (!best || result.seconds < best->seconds) {
+			best = result;
+		}
+	}
+
+	const double fps { static_cast<double>(options.frames) / best->seconds };
+	const double baseline {
+		options.baseline_path.empty() ? 0.0 : readBaseline(options.baseline_path)
+	};
+	const double drop { baseline > 0.0 ? 100.0 * (baseline - fps) / baseline : 0.0 };
+	const bool passed { drop <= options.max_drop };
+
+	std::string json {};
+	json += "{\n";
+	json += "\t\"workload\": \"" + std::string { options.workload } + "\",\n";
+	json += "\t\"frames\": " + std::to_string(options.frames) + ",\n";
+	json += "\t\"accuracy\": \"";
+	json += nes::accuracyName(options.accuracy);
+	json += "\",\n";
+	json += "\t\"runs\": " + std::to_string(options.runs) + ",\n";
+	json += "\t\"seconds\": " + std::to_string(best->seconds) + ",\n";
+	json += "\t\"fps\": " + std::to_string(fps) + ",\n";
+	json += "\t\"baseline_fps\": ";
+	json += baseline > 0.0 ? std::to_string(baseline) : "null";
+	json += ",\n";
+	json += "\t\"drop_percent\": " + std::to_string(drop) + ",\n";
+	json += "\t\"max_drop_percent\": " + std::to_string(options.max_drop) + ",\n";
+	std::array<char, 17> hash {};
+	std::snprintf(
+		hash.data(), hash.size(), "%016llx", static_cast<unsigned long long>(best->hash)
+	);
+	json += "\t\"state_hash\": \"" + std::string { hash.data() } + "\",\n";
+	json += std::string { "\t\"passed\": " } + (passed ? "true" : "false") + "\n";
+	json += "}\n";
+
+	std::fputs(json.c_str(), stdout);
+	if (!options.json_path.empty()) {
+		std::ofstream file(options.json_path.data());
+		file << json;
+		if (!file) {
+			std::fprintf(stderr, "Cannot write %s\n", options.json_path.data());
+			return 2;
+		}
+	}
+
+	if (baseline <= 0.0 && !options.baseline_path.empty()) {
+		std::fprintf(
+			stderr, "No baseline at %s yet, not checked\n", options.baseline_path.data()
+		);
+	}
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,398 @@
+#include "video/Ntsc.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#ifdef SIMD_X86
+	#include <immintrin.h>
+#endif
+
+namespace {
+	using video::Rgba;
+
+	// Timing in master clock samples: a pixel lasts 8, a subcarrier cycle 12, and
+	// each line starts 4 (a third of a cycle) later in the cycle than the last.
+	constexpr u32 pixel_samples { 8 };
+	constexpr u32 cycle_samples { 12 };
+	constexpr u32 phases { 3 };
+
+	// 3 pixels (2 subcarrier cycles) make a group of 7 output pixels.
+	constexpr u32 group_pixels { 3 };
+	constexpr u32 group_outputs { 7 };
+
+	// A pixel adds to the outputs of its group and of the groups on either side,
+	// a slice each: 8 outputs (the 8th always 0, it pads SIMD stores) of R, G, B
+	// and A in 16-bit fixed point.
+	enum Slice : u32 {
+		SLICE_PREVIOUS,
+		SLICE_OWN,
+		SLICE_NEXT,
+		SLICES,
+	};
+
+	constexpr u32 slice_outputs { 8 };
+	constexpr u32 slice_size { slice_outputs * 4 };
+	constexpr u32 fraction_bits { 5 };
+
+	// Colors with emphasis (9 bits), plus one without any signal for the pixels
+	// around the picture.
+	constexpr u32 colors { 512 };
+	constexpr u16 blank { colors };
+
+	// Square wave levels relative to sync for each luma level, emphasis attenuates
+	// the third of the cycle it covers.
+	constexpr std::array<float, 4> level_low { 0.350f, 0.518f, 0.962f, 1.550f };
+	constexpr std::array<float, 4> level_high { 1.094f, 1.506f, 1.962f, 1.962f };
+	constexpr float level_black { 0.518f };
+	constexpr float level_white { 1.962f };
+	constexpr float attenuation { 0.746f };
+
+	// The decoder averages Y, I and Q over one cycle around each output pixel.
+	// Hue and saturation line it up with `Palette::standard`.
+	constexpr double hue_shift { 4.0 };
+	constexpr double saturation { 1.55 };
+
+	using Kernel = std::vector<s16>;
+
+	[[nodiscard]] constexpr std::size_t
+	kernelIndex(u32 phase, u32 position, u32 color, u32 slice) {
+		const std::size_t entry {
+			(phase * group_pixels + position) * (colors + 1) + color
+		};
+		return (entry * SLICES + slice) * slice_size;
+	}
+
+	// Signal of `color` at subcarrier phase `phase` (0-11), black 0 and white 1.
+	[[nodiscard]] float signal(u16 color, u32 phase) {
+		const u32 hue = color & 0x0f;
+		const u32 luma = hue > 13 ? 1 : (color >> 4) & 0x03;
+		const u32 emphasis = color >> 6;
+
+		float low { level_low.at(luma) };
+		float high { level_high.at(luma) };
+		if (hue == 0) {
+			low = high;
+		} else if (hue > 12) {
+			high = low;
+		}
+
+		const auto in_phase { [phase](u32 of) {
+			return (of + phase) % cycle_samples < cycle_samples / 2;
+		} };
+		float level { in_phase(hue) ? high : low };
+		if (((emphasis & 0x01) && in_phase(0)) || ((emphasis & 0x02) && in_phase(4))
+		    || ((emphasis & 0x04) && in_phase(8))) {
+			level *= attenuation;
+		}
+
+		return (level - level_black) / (level_white - level_black);
+	}
+
+	// Every pixel on its own through the decoder, for each line phase and position
+	// in its group.
+	[[nodiscard]] Kernel buildKernel() {
+		Kernel kernel(kernelIndex(phases, 0, 0, 0), 0);
+
+		const double output_samples {
+			static_cast<double>(group_pixels * pixel_samples) / group_outputs
+		};
+		const double pi { std::acos(-1.0) };
+		const double scale { 255 << fraction_bits };
+
+		for (u32 phase { 0 }; phase < phases; ++phase) {
+			for (u32 position { 0 }; position < group_pixels; ++position) {
+				for (u16 color { 0 }; color < colors; ++color) {
+					for (u32 slice { 0 }; slice < SLICES; ++slice) {
+						s16 *entry {
+							kernel.data() + kernelIndex(phase, position, color, slice)
+						};
+
+						for (u32 output { 0 }; output < group_outputs; ++output) {
+							// In samples from the start of the pixel's group.
+							const double center {
+								(output + 0.5 + (static_cast<double>(slice) - SLICE_OWN)
+								                    * group_outputs)
+								* output_samples
+							};
+
+							double y { 0.0 };
+							double i { 0.0 };
+							double q { 0.0 };
+							for (u32 n { 0 }; n < pixel_samples; ++n) {
+								const u32 sample { position * pixel_samples + n };
+								const double distance { std::abs(sample + 0.5 - center) };
+								if (distance >= cycle_samples / 2.0) {
+									continue;
+								}
+
+								const u32 at { (phase * 4 + sample) % cycle_samples };
+								const double level { signal(color, at) / cycle_samples };
+								const double angle { pi * (at + hue_shift) / 6.0 };
+								y += level;
+								i += level * std::cos(angle) * saturation;
+								q += level * std::sin(angle) * saturation;
+							}
+
+							const std::array<double, 3> rgb {
+								y + 0.946882 * i + 0.623557 * q,
+								y - 0.274788 * i - 0.635691 * q,
+								y - 1.108545 * i + 1.709007 * q,
+							};
+							for (u32 channel { 0 }; channel < 3; ++channel) {
+								entry[output * 4 + channel] =
+									static_cast<s16>(std::lround(rgb[channel] * scale));
+							}
+						}
+					}
+				}
+			}
+		}
+
+		return kernel;
+	}
+
+	// Built once, shared by every filter.
+	[[nodiscard]] const Kernel& kernel() {
+		static const Kernel kernel { buildKernel() };
+		return kernel;
+	}
+
+	// The kernels of one line: its phase and the colors of its pixels, padded
+	// with a blank group on the left and as many as needed on the right.
+	struct Line {
+		const s16 *kernel;
+		const u16 *colors;
+
+		// Slice of the pixel at `position` in group `group` of the padded line.
+		[[nodiscard]] inline const s16 *slice(u32 group, u32 position, u32 which) const {
+			const u16 color { colors[group * group_pixels + position] };
+			return kernel + kernelIndex(0, position, color, which);
+		}
+	};
+
+	[[nodiscard]] inline u8 channelValue(s16 sum) {
+		const auto rounded { static_cast<s16>(sum + (1 << (fraction_bits - 1))) };
+		return static_cast<u8>(std::clamp(rounded >> fraction_bits, 0, 255));
+	}
+
+	// Output group g sums the own slices of group g + 1 of the padded line, and
+	// the slices groups g and g + 2 spill into it. Sums wrap as in SIMD.
+	void filterScalar(const Line& line, u32 groups, u32 first, Rgba *out) {
+		for (u32 group { first }; group < groups; ++group) {
+			std::array<s16, slice_size> sums {};
+			for (u32 position { 0 }; position < group_pixels; ++position) {
+				const s16 *own { line.slice(group + 1, position, SLICE_OWN) };
+				const s16 *left { line.slice(group, position, SLICE_NEXT) };
+				const s16 *right { line.slice(group + 2, position, SLICE_PREVIOUS) };
+				for (u32 n { 0 }; n < slice_size; ++n) {
+					sums[n] = static_cast<s16>(sums[n] + own[n] + left[n] + right[n]);
+				}
+			}
+
+			for (u32 output { 0 }; output < group_outputs; ++output) {
+				const std::array<u8, 4> bytes {
+					channelValue(sums[output * 4]),
+					channelValue(sums[output * 4 + 1]),
+					channelValue(sums[output * 4 + 2]),
+					0xff,
+				};
+				Rgba *pixel { out + group * group_outputs + output };
+				std::memcpy(pixel, bytes.data(), sizeof(Rgba));
+			}
+		}
+	}
+
+#ifdef SIMD_X86
+	// One group per step, 2 outputs per register. Stores are 8 outputs wide, the
+	// 8th being overwritten by the next group, so the last group is left over.
+	__attribute__((target("ssse3"))) u32
+	filterSsse3(const Line& line, u32 groups, Rgba *out) {
+		const __m128i rounding { _mm_set1_epi16(1 << (fraction_bits - 1)) };
+		const __m128i alpha { _mm_set1_epi32(static_cast<int>(0xff000000)) };
+
+		u32 group { 0 };
+		for (; group + 1 < groups; ++group) {
+			__m128i sums[4] { rounding, rounding, rounding, rounding };
+			for (u32 position { 0 }; position < group_pixels; ++position) {
+				const std::array<const s16 *, 3> slices {
+					line.slice(group + 1, position, SLICE_OWN),
+					line.slice(group, position, SLICE_NEXT),
+					line.slice(group + 2, position, SLICE_PREVIOUS),
+				};
+				for (const s16 *slice : slices) {
+					const auto *entry { reinterpret_cast<const __m128i *>(slice) };
+					for (u32 n { 0 }; n < 4; ++n) {
+						sums[n] = _mm_add_epi16(sums[n], _mm_loadu_si128(entry + n));
+					}
+				}
+			}
+
+			auto *dst { reinterpret_cast<__m128i *>(out + group * group_outputs) };
+			for (u32 half { 0 }; half < 2; ++half) {
+				const __m128i pixels { _mm_packus_epi16(
+					_mm_srai_epi16(sums[half * 2], fraction_bits),
+					_mm_srai_epi16(sums[half * 2 + 1], fraction_bits)
+				) };
+				_mm_storeu_si128(dst + half, _mm_or_si128(pixels, alpha));
+			}
+		}
+
+		return group;
+	}
+
+	// 4 outputs per register, as above.
+	__attribute__((target("avx2"))) u32
+	filterAvx2(const Line& line, u32 groups, Rgba *out) {
+		const __m256i rounding { _mm256_set1_epi16(1 << (fraction_bits - 1)) };
+		const __m256i alpha { _mm256_set1_epi32(static_cast<int>(0xff000000)) };
+
+		u32 group { 0 };
+		for (; group + 1 < groups; ++group) {
+			__m256i low { rounding };
+			__m256i high { rounding };
+			for (u32 position { 0 }; position < group_pixels; ++position) {
+				const std::array<const s16 *, 3> slices {
+					line.slice(group + 1, position, SLICE_OWN),
+					line.slice(group, position, SLICE_NEXT),
+					line.slice(group + 2, position, SLICE_PREVIOUS),
+				};
+				for (const s16 *slice : slices) {
+					const auto *entry { reinterpret_cast<const __m256i *>(slice) };
+					low = _mm256_add_epi16(low, _mm256_loadu_si256(entry));
+					high = _mm256_add_epi16(high, _mm256_loadu_si256(entry + 1));
+				}
+			}
+
+			// packus works within 128-bit lanes, the permute puts the outputs back in
+			// order.
+			const __m256i pixels { _mm256_permute4x64_epi64(
+				_mm256_packus_epi16(
+					_mm256_srai_epi16(low, fraction_bits),
+					_mm256_srai_epi16(high, fraction_bits)
+				),
+				0xd8
+			) };
+			_mm256_storeu_si256(
+				reinterpret_cast<__m256i *>(out + group * group_outputs),
+				_mm256_or_si256(pixels, alpha)
+			);
+		}
+
+		return group;
+	}
+#endif
+} // namespace
+
+namespace video {
+	NtscFilter::NtscFilter(u32 width, u32 threads)
+		: m_width(width)
+		, m_thread_count(std::clamp<u32>(threads, 1, 16)) {
+		// Rather than on the first frame.
+		static_cast<void>(kernel());
+
+		const u32 groups { (width + group_pixels - 1) / group_pixels };
+		m_lines.assign(
+			m_thread_count, std::vector<u16>((groups + 2) * group_pixels, blank)
+		);
+
+		// The calling thread filters the first band.
+		for (u32 worker { 1 }; worker < m_thread_count; ++worker) {
+			m_threads.emplace_back(&NtscFilter::run, this, worker);
+		}
+	}
+
+	NtscFilter::~NtscFilter() {
+		{
+			const std::lock_guard lock { m_mutex };
+			m_stop = true;
+		}
+		m_wake.notify_all();
+
+		for (auto& thread : m_threads) {
+			thread.join();
+		}
+	}
+
+	void NtscFilter::apply(
+		const u8 *indices, const u8 *emphasis, u32 height, u8 phase, Rgba *out,
+		simd::Isa isa
+	) {
+		const Job job { indices, emphasis, height, phase, out, isa };
+		if (!m_threads.empty()) {
+			{
+				const std::lock_guard lock { m_mutex };
+				m_job = job;
+				m_busy = static_cast<u32>(m_threads.size());
+				m_generation += 1;
+			}
+			m_wake.notify_all();
+		}
+
+		filterBand(job, 0, height / getThreads(), 0);
+
+		std::unique_lock lock { m_mutex };
+		m_done.wait(lock, [this] { return m_busy == 0; });
+	}
+
+	void NtscFilter::run(u32 worker) {
+		const u32 threads { getThreads() };
+
+		u64 generation { 0 };
+		std::unique_lock lock { m_mutex };
+		while (true) {
+			m_wake.wait(lock, [&] { return m_stop || m_generation != generation; });
+			if (m_stop) {
+				return;
+			}
+			generation = m_generation;
+
+			const Job job { m_job };
+			lock.unlock();
+			filterBand(
+				job, worker * job.height / threads, (worker + 1) * job.height / threads,
+				worker
+			);
+			lock.lock();
+
+			m_busy -= 1;
+			if (m_busy == 0) {
+				m_done.notify_one();
+			}
+		}
+	}
+
+	void NtscFilter::filterBand(const Job& job, u32 first, u32 last, u32 worker) {
+		const u32 groups { (m_width + group_pixels - 1) / group_pixels };
+		const u32 out_width { ntscWidth(m_width) };
+
+		// Only the pixels are written, the blank groups around them stay.
+		std::vector<u16>& colors { m_lines[worker] };
+
+		for (u32 y { first }; y < last; ++y) {
+			const u8 *src { job.indices + y * m_width };
+			const u16 emphasis = (job.emphasis[y] & 0x07) << 6;
+			for (u32 x { 0 }; x < m_width; ++x) {
+				colors[group_pixels + x] = (src[x] & 0x3f) | emphasis;
+			}
+
+			const Line line {
+				kernel().data() + kernelIndex((job.phase + y) % phases, 0, 0, 0),
+				colors.data(),
+			};
+			Rgba *dst { job.out + y * out_width };
+
+			// The SIMD paths return how many groups they did, the scalar loop finishes.
+			u32 done { 0 };
+#ifdef SIMD_X86
+			if (job.isa == simd::Isa::AVX2) {
+				done = filterAvx2(line, groups, dst);
+			} else if (job.isa == simd::Isa::SSSE3) {
+				done = filterSsse3(line, groups, dst);
+			}
+#endif
+			filterScalar(line, groups, done, dst);
+		}
+	}
+} // namespace video
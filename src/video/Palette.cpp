@@ -0,0 +1,195 @@
+#include "video/Palette.hpp"
+
+#include <cstring>
+
+#ifdef SIMD_X86
+	#include <immintrin.h>
+#endif
+
+namespace {
+	// 2C02 colors, as 0xRRGGBB.
+	// clang-format off
+	constexpr std::array<u32, video::Palette::COLORS> ntsc_colors {
+		0x666666, 0x002a88, 0x1412a7, 0x3b00a4, 0x5c007e, 0x6e0040, 0x6c0600, 0x561d00,
+		0x333500, 0x0b4800, 0x005200, 0x004f08, 0x00404d, 0x000000, 0x000000, 0x000000,
+		0xadadad, 0x155fd9, 0x4240ff, 0x7527fe, 0xa01acc, 0xb71e7b, 0xb53120, 0x994e00,
+		0x6b6d00, 0x388700, 0x0c9300, 0x008f32, 0x007c8d, 0x000000, 0x000000, 0x000000,
+		0xfffeff, 0x64b0ff, 0x9290ff, 0xc676ff, 0xf36aff, 0xfe6ecc, 0xfe8170, 0xea9e22,
+		0xbcbe00, 0x88d800, 0x5ce430, 0x45e082, 0x48cdde, 0x4f4f4f, 0x000000, 0x000000,
+		0xfffeff, 0xc0dfff, 0xd3d2ff, 0xe8c8ff, 0xfbc2ff, 0xfec4ea, 0xfeccc5, 0xf7d8a5,
+		0xe4e594, 0xcfef96, 0xbdf4ab, 0xb3f3cc, 0xb5ebf2, 0xb8b8b8, 0x000000, 0x000000,
+	};
+	// clang-format on
+
+	// Emphasizing a channel dims the two others by about this much.
+	constexpr double emphasis_dim { 0.816 };
+
+	void
+	convertScalar(const u8 *src, u32 count, const video::Rgba *colors, video::Rgba *dst) {
+		for (u32 x { 0 }; x < count; ++x) {
+			dst[x] = colors[src[x] & 0x3f];
+		}
+	}
+
+#ifdef SIMD_X86
+	// One channel of 16 pixels from its plane (see `Palette::plane`), `index`
+	// holding the pixels' indices lowered by 0, 16, 32 and 48.
+	__attribute__((target("ssse3"), always_inline)) inline __m128i
+	lookupPlane(const u8 *plane, const __m128i (&index)[4]) {
+		const auto *tables { reinterpret_cast<const __m128i *>(plane) };
+		const __m128i low { _mm_xor_si128(
+			_mm_shuffle_epi8(_mm_load_si128(tables + 0), index[0]),
+			_mm_shuffle_epi8(_mm_load_si128(tables + 1), index[1])
+		) };
+		const __m128i high { _mm_xor_si128(
+			_mm_shuffle_epi8(_mm_load_si128(tables + 2), index[2]),
+			_mm_shuffle_epi8(_mm_load_si128(tables + 3), index[3])
+		) };
+		return _mm_xor_si128(low, high);
+	}
+
+	// 16 pixels per step. pshufb only looks at the low nibble and gives zero when
+	// bit 7 is set, so with the index lowered by 16 for each quarter of the palette,
+	// every quarter up to the pixel's own contributes and the later ones vanish.
+	// The planes store each quarter XORed with the previous one, which makes the
+	// XOR of all the lookups the wanted color. The three channels are then
+	// interleaved into RGBA.
+	//
+	// Written out rather than looped over quarters and channels: below -O3 the
+	// loops are kept, and the path ends up slower than the scalar one.
+	__attribute__((target("ssse3"))) u32
+	convertSsse3(const u8 *src, u32 count, const video::Palette& palette, u8 emphasis,
+	             video::Rgba *dst) {
+		const u8 *red { palette.plane(emphasis, 0) };
+		const u8 *green { palette.plane(emphasis, 1) };
+		const u8 *blue { palette.plane(emphasis, 2) };
+
+		const __m128i index_mask { _mm_set1_epi8(0x3f) };
+		const __m128i quarter_size { _mm_set1_epi8(16) };
+		const __m128i alpha { _mm_set1_epi8(static_cast<char>(0xff)) };
+
+		u32 x { 0 };
+		for (; x + 16 <= count; x += 16) {
+			__m128i index[4];
+			index[0] = _mm_and_si128(
+				_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x)), index_mask
+			);
+			index[1] = _mm_sub_epi8(index[0], quarter_size);
+			index[2] = _mm_sub_epi8(index[1], quarter_size);
+			index[3] = _mm_sub_epi8(index[2], quarter_size);
+
+			const __m128i r { lookupPlane(red, index) };
+			const __m128i g { lookupPlane(green, index) };
+			const __m128i b { lookupPlane(blue, index) };
+
+			const __m128i rg_lo { _mm_unpacklo_epi8(r, g) };
+			const __m128i rg_hi { _mm_unpackhi_epi8(r, g) };
+			const __m128i ba_lo { _mm_unpacklo_epi8(b, alpha) };
+			const __m128i ba_hi { _mm_unpackhi_epi8(b, alpha) };
+
+			auto *out { reinterpret_cast<__m128i *>(dst + x) };
+			_mm_storeu_si128(out + 0, _mm_unpacklo_epi16(rg_lo, ba_lo));
+			_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(rg_lo, ba_lo));
+			_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(rg_hi, ba_hi));
+			_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(rg_hi, ba_hi));
+		}
+
+		return x;
+	}
+
+	// 8 pixels per step, straight gathers from the RGBA table.
+	__attribute__((target("avx2"))) u32
+	convertAvx2(const u8 *src, u32 count, const video::Rgba *colors, video::Rgba *dst) {
+		const __m256i index_mask { _mm256_set1_epi32(0x3f) };
+
+		u32 x { 0 };
+		for (; x + 8 <= count; x += 8) {
+			const __m128i bytes {
+				_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + x))
+			};
+			const __m256i index {
+				_mm256_and_si256(_mm256_cvtepu8_epi32(bytes), index_mask)
+			};
+			const __m256i pixels {
+				_mm256_i32gather_epi32(reinterpret_cast<const int *>(colors), index, 4)
+			};
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), pixels);
+		}
+
+		return x;
+	}
+#endif
+} // namespace
+
+namespace video {
+	Palette Palette::standard() {
+		Palette palette {};
+
+		for (std::size_t emphasis { 0 }; emphasis < EMPHASIS; ++emphasis) {
+			for (std::size_t color { 0 }; color < COLORS; ++color) {
+				std::array<double, 3> rgb {
+					static_cast<double>((ntsc_colors.at(color) >> 16) & 0xff),
+					static_cast<double>((ntsc_colors.at(color) >> 8) & 0xff),
+					static_cast<double>(ntsc_colors.at(color) & 0xff),
+				};
+
+				// Bit 0 emphasizes red, bit 1 green, bit 2 blue.
+				for (std::size_t bit { 0 }; bit < 3; ++bit) {
+					if (emphasis & (1 << bit)) {
+						for (std::size_t channel { 0 }; channel < 3; ++channel) {
+							if (channel != bit) {
+								rgb.at(channel) *= emphasis_dim;
+							}
+						}
+					}
+				}
+
+				const std::array<u8, 4> bytes {
+					static_cast<u8>(rgb[0]),
+					static_cast<u8>(rgb[1]),
+					static_cast<u8>(rgb[2]),
+					0xff,
+				};
+				Rgba& rgba { palette.m_colors.at(emphasis * COLORS + color) };
+				std::memcpy(&rgba, bytes.data(), bytes.size());
+				for (std::size_t channel { 0 }; channel < 3; ++channel) {
+					const std::size_t plane { emphasis * 3 + channel };
+					palette.m_planes.at(plane * COLORS + color) = bytes.at(channel);
+				}
+			}
+
+			// Each quarter of a plane XORed with the previous one, from the last, so
+			// every line's conversion does not redo it.
+			for (std::size_t channel { 0 }; channel < 3; ++channel) {
+				u8 *plane { palette.m_planes.data() + (emphasis * 3 + channel) * COLORS };
+				for (std::size_t color { COLORS - 1 }; color >= 16; --color) {
+					plane[color] ^= plane[color - 16];
+				}
+			}
+		}
+
+		return palette;
+	}
+
+	void convert(
+		const u8 *indices, const u8 *emphasis, u32 width, u32 height,
+		const Palette& palette, Rgba *out, simd::Isa isa
+	) {
+		for (u32 y { 0 }; y < height; ++y) {
+			const u8 *src { indices + y * width };
+			Rgba *dst { out + y * width };
+			const Rgba *colors { palette.colors(emphasis[y]) };
+
+			// The SIMD paths return how many pixels they did, the scalar loop finishes.
+			u32 done { 0 };
+#ifdef SIMD_X86
+			if (isa == simd::Isa::AVX2) {
+				done = convertAvx2(src, width, colors, dst);
+			} else if (isa == simd::Isa::SSSE3) {
+				done = convertSsse3(src, width, palette, emphasis[y], dst);
+			}
+#endif
+			convertScalar(src + done, width - done, colors, dst + done);
+		}
+	}
+} // namespace video
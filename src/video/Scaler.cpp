@@ -0,0 +1,168 @@
+#include "video/Scaler.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef SIMD_X86
+	#include <immintrin.h>
+#endif
+
+namespace {
+	using video::Rgba;
+
+	void integerScalar(const Rgba *src, u32 width, u32 height, u32 factor, Rgba *dst) {
+		const u32 pitch { width * factor };
+
+		for (u32 y { 0 }; y < height; ++y) {
+			Rgba *row { dst + y * factor * pitch };
+			for (u32 x { 0 }; x < width; ++x) {
+				std::fill_n(row + x * factor, factor, src[y * width + x]);
+			}
+			for (u32 copy { 1 }; copy < factor; ++copy) {
+				std::memcpy(row + copy * pitch, row, pitch * sizeof(Rgba));
+			}
+		}
+	}
+
+	// The 2x rule for one pixel E with neighbours B (up), D (left), F (right) and
+	// H (down), writing the 2x2 block E0 E1 / E2 E3.
+	inline void
+	scale2xPixel(Rgba b, Rgba d, Rgba e, Rgba f, Rgba h, Rgba *top, Rgba *bottom) {
+		top[0] = d == b && b != f && d != h ? d : e;
+		top[1] = b == f && b != d && f != h ? f : e;
+		bottom[0] = d == h && d != b && h != f ? d : e;
+		bottom[1] = h == f && d != h && b != f ? f : e;
+	}
+
+	// Columns [begin, end) of one line, edges are clamped.
+	void scale2xSpan(
+		const Rgba *up, const Rgba *row, const Rgba *down, u32 width, u32 begin, u32 end,
+		Rgba *top, Rgba *bottom
+	) {
+		for (u32 x { begin }; x < end; ++x) {
+			const Rgba d { row[x > 0 ? x - 1 : x] };
+			const Rgba f { row[x + 1 < width ? x + 1 : x] };
+			scale2xPixel(up[x], d, row[x], f, down[x], top + x * 2, bottom + x * 2);
+		}
+	}
+
+	void scale2xScalar(const Rgba *src, u32 width, u32 height, Rgba *dst) {
+		for (u32 y { 0 }; y < height; ++y) {
+			const Rgba *row { src + y * width };
+			const Rgba *up { y > 0 ? row - width : row };
+			const Rgba *down { y + 1 < height ? row + width : row };
+			Rgba *top { dst + y * 2 * width * 2 };
+			scale2xSpan(up, row, down, width, 0, width, top, top + width * 2);
+		}
+	}
+
+#ifdef SIMD_X86
+	__attribute__((target("sse2"))) inline __m128i
+	select(__m128i mask, __m128i a, __m128i b) {
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	// 4 pixels per step, each pixel written twice on two copies of the line.
+	__attribute__((target("sse2"))) void
+	integer2xSse2(const Rgba *src, u32 width, u32 height, Rgba *dst) {
+		const u32 pitch { width * 2 };
+
+		for (u32 y { 0 }; y < height; ++y) {
+			const Rgba *line { src + y * width };
+			Rgba *row { dst + y * 2 * pitch };
+
+			u32 x { 0 };
+			for (; x + 4 <= width; x += 4) {
+				const __m128i v {
+					_mm_loadu_si128(reinterpret_cast<const __m128i *>(line + x))
+				};
+				auto *out { reinterpret_cast<__m128i *>(row + x * 2) };
+				_mm_storeu_si128(out, _mm_unpacklo_epi32(v, v));
+				_mm_storeu_si128(out + 1, _mm_unpackhi_epi32(v, v));
+			}
+			for (; x < width; ++x) {
+				row[x * 2] = row[x * 2 + 1] = line[x];
+			}
+			std::memcpy(row + pitch, row, pitch * sizeof(Rgba));
+		}
+	}
+
+	// Same rule as scale2xPixel on 4 pixels at once, the first and last columns go
+	// through the scalar path for the clamping.
+	__attribute__((target("sse2"))) void
+	scale2xSse2(const Rgba *src, u32 width, u32 height, Rgba *dst) {
+		for (u32 y { 0 }; y < height; ++y) {
+			const Rgba *row { src + y * width };
+			const Rgba *up { y > 0 ? row - width : row };
+			const Rgba *down { y + 1 < height ? row + width : row };
+			Rgba *top { dst + y * 2 * width * 2 };
+			Rgba *bottom { top + width * 2 };
+
+			const auto load { [](const Rgba *p) {
+				return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+			} };
+
+			u32 x { std::min<u32>(1, width) };
+			scale2xSpan(up, row, down, width, 0, x, top, bottom);
+			for (; x + 5 <= width; x += 4) {
+				const __m128i b { load(up + x) };
+				const __m128i d { load(row + x - 1) };
+				const __m128i e { load(row + x) };
+				const __m128i f { load(row + x + 1) };
+				const __m128i h { load(down + x) };
+
+				const __m128i db { _mm_cmpeq_epi32(d, b) };
+				const __m128i bf { _mm_cmpeq_epi32(b, f) };
+				const __m128i dh { _mm_cmpeq_epi32(d, h) };
+				const __m128i hf { _mm_cmpeq_epi32(h, f) };
+
+				const __m128i bf_dh { _mm_or_si128(bf, dh) };
+				const __m128i db_hf { _mm_or_si128(db, hf) };
+				const __m128i e0 { select(_mm_andnot_si128(bf_dh, db), d, e) };
+				const __m128i e1 { select(_mm_andnot_si128(db_hf, bf), f, e) };
+				const __m128i e2 { select(_mm_andnot_si128(db_hf, dh), d, e) };
+				const __m128i e3 { select(_mm_andnot_si128(bf_dh, hf), f, e) };
+
+				auto *out_top { reinterpret_cast<__m128i *>(top + x * 2) };
+				auto *out_bottom { reinterpret_cast<__m128i *>(bottom + x * 2) };
+				_mm_storeu_si128(out_top, _mm_unpacklo_epi32(e0, e1));
+				_mm_storeu_si128(out_top + 1, _mm_unpackhi_epi32(e0, e1));
+				_mm_storeu_si128(out_bottom, _mm_unpacklo_epi32(e2, e3));
+				_mm_storeu_si128(out_bottom + 1, _mm_unpackhi_epi32(e2, e3));
+			}
+			scale2xSpan(up, row, down, width, x, width, top, bottom);
+		}
+	}
+#endif
+} // namespace
+
+namespace video {
+	void scale(
+		Scaler scaler, const Rgba *src, u32 width, u32 height, u32 factor, Rgba *dst,
+		simd::Isa isa
+	) {
+		// Every SIMD level we dispatch to implies SSE2.
+		[[maybe_unused]] const bool vector { isa != simd::Isa::SCALAR };
+
+		switch (scaler) {
+		case Scaler::INTEGER:
+#ifdef SIMD_X86
+			if (vector && factor == 2) {
+				integer2xSse2(src, width, height, dst);
+				return;
+			}
+#endif
+			integerScalar(src, width, height, factor, dst);
+			break;
+		case Scaler::SCALE2X:
+#ifdef SIMD_X86
+			if (vector) {
+				scale2xSse2(src, width, height, dst);
+				return;
+			}
+#endif
+			scale2xScalar(src, width, height, dst);
+			break;
+		}
+	}
+} // namespace video